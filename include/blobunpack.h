@@ -0,0 +1,93 @@
+/*++
+
+Copyright (c) 2021-2024 DuoWoA authors. All Rights Reserved.
+
+Module Name:
+
+	blobunpack.h
+
+Abstract:
+
+	This file contains the decoder of the blobs in packedblobs.h, see
+	tools\blobpack.py for the format.
+
+	Only uses the NT base types, RtlCopyMemory and RtlZeroMemory, so the
+	driver and tools\blobcheck.c run the same code. Includers declare those
+	first, vfile.c through ntddk.h.
+
+Environment:
+
+	Kernel-mode Driver Framework
+
+--*/
+
+#pragma once
+
+// The unpacked size leads the stream
+FORCEINLINE DWORD GetPackedBlobSize(const BYTE* Packed)
+{
+	return *(const DWORD UNALIGNED*)Packed;
+}
+
+//
+// Expands the PackedSize bytes at Packed into Data, checking every run
+// against both the stream and the unpacked size. FileSize receives the
+// unpacked size, STATUS_BUFFER_TOO_SMALL means DataSize is short of it.
+// Nothing past the unpacked size is written.
+//
+FORCEINLINE NTSTATUS UnpackBlob(const BYTE* Packed, DWORD PackedSize, PVOID Data, DWORD DataSize, DWORD* FileSize)
+{
+	const BYTE* PackedEnd = Packed + PackedSize;
+	PUCHAR Output = (PUCHAR)Data;
+	DWORD Written = 0;
+
+	*FileSize = GetPackedBlobSize(Packed);
+
+	if (DataSize < *FileSize)
+	{
+		return STATUS_BUFFER_TOO_SMALL;
+	}
+
+	Packed += sizeof(DWORD);
+
+	while (Packed < PackedEnd)
+	{
+		BYTE Control = *Packed++;
+		DWORD RunLength;
+
+		if (Control < 0x80)
+		{
+			// Literal run
+			RunLength = (DWORD)Control + 1;
+
+			if (RunLength > (DWORD)(PackedEnd - Packed) || RunLength > *FileSize - Written)
+			{
+				return STATUS_DATA_ERROR;
+			}
+
+			RtlCopyMemory(Output + Written, Packed, RunLength);
+			Packed += RunLength;
+		}
+		else
+		{
+			// Zero run
+			if (Packed == PackedEnd)
+			{
+				return STATUS_DATA_ERROR;
+			}
+
+			RunLength = ((((DWORD)Control & 0x7F) << 8) | *Packed++) + 1;
+
+			if (RunLength > *FileSize - Written)
+			{
+				return STATUS_DATA_ERROR;
+			}
+
+			RtlZeroMemory(Output + Written, RunLength);
+		}
+
+		Written += RunLength;
+	}
+
+	return Written == *FileSize ? STATUS_SUCCESS : STATUS_DATA_ERROR;
+}
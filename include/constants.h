@@ -6,9 +6,8 @@
 #include <wdf.h>
 #include <windef.h>
 
-extern BYTE WLAN_SAR2CFG_PROVISION[42];
-extern BYTE WLAN_CLPC_PROVISION[26328];
-extern BYTE WLAN_PROVISION[9];
-extern BYTE BT_PROVISION[8];
-extern BYTE BT_NVMTAG83_PROVISION[10];
-extern BYTE BT_NVMTAG36_PROVISION[18];
\ No newline at end of file
+extern const BYTE WLAN_SAR2CFG_PROVISION[42];
+extern const BYTE WLAN_PROVISION[9];
+extern const BYTE BT_PROVISION[8];
+extern const BYTE BT_NVMTAG83_PROVISION[10];
+extern const BYTE BT_NVMTAG36_PROVISION[18];
\ No newline at end of file
@@ -10,17 +10,151 @@
 #include <ntstrsafe.h>
 #include <hidport.h>
 #include <trace.h>
+#include <vfile.h>
+#include <socpartition.h>
 
 #define HID_DESCRIPTOR_POOL_TAG 'DdiH'
 
+// SOCPartition IOCTLs post-processed by the filter, everything else is passed through untouched
+#define IOCTL_SOCPARTITION_READ_FILE            0xECAF32C2
+#define IOCTL_SOCPARTITION_GET_FILE_PROPERTY    0xECAF32C6
+#define IOCTL_SOCPARTITION_LIST_DIRECTORY_FILES 0xECAF32CE
+
+C_ASSERT(RTL_FIELD_SIZE(SOCPARTITION_REQUEST, Path) == VIRTUAL_FILE_MAX_PATH * sizeof(WCHAR));
+
+//
+// Attached to every request, filled in by OnIoDeviceControl for the IOCTLs
+// above and handed to OnRequestCompletionRoutine as its context. The request
+// header is parsed once at dispatch, nothing after that reads the input
+// buffer again.
+//
+typedef struct _FILTER_REQUEST_CONTEXT
+{
+	ULONG IoControlCode;
+	size_t InputBufferLength;
+	size_t OutputBufferLength;
+
+	// Only set when the input held a whole header, the rest is valid only then
+	BOOLEAN Parsed;
+	WCHAR Path[VIRTUAL_FILE_MAX_PATH]; // Zero filled past the terminator
+	ULONG PathHash;
+	DWORD FileProperty;
+	DWORD FileSystemProperty;
+	PVIRTUAL_FILE File;                // ReadFile and GetFileProperty, NULL when the filter does not own Path
+
+	ULONGLONG RoutedAt;                // Interrupt time it was moved to its cost class queue
+
+	// Filled in by the completion routine when the answer needs sfpd, for the pipeline workers
+	LIST_ENTRY PipelineLink;
+	PUCHAR OutputBuffer;
+	ULONG OutputLength;
+	NTSTATUS Status;
+} FILTER_REQUEST_CONTEXT, * PFILTER_REQUEST_CONTEXT;
+
+WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(FILTER_REQUEST_CONTEXT, GetFilterRequestContext)
+
+// Registry value (device hardware key), when non zero paths the filter owns are answered without asking SOCPartition
+#define FILTER_LOCAL_SERVING_VALUE_NAME L"LocalServing"
+
+// Number of requests remembered as failed by SOCPartition
+#define FILTER_NEGATIVE_CACHE_SIZE 16
+
+// FNV-1a over the request path, only to tell negative cache entries apart quickly
+#define FILTER_PATH_HASH_SEED 2166136261
+#define FILTER_PATH_HASH_PRIME 16777619
+
+// Most sfpd backed answers worked on at once, each on its own passive level work item
+#define FILTER_PIPELINE_WORKER_COUNT 4
+
+// Most requests of each cost class presented at once. A presented request
+// counts until it completes, sfpd backed ones through SOCPartition and the
+// pipeline, so that class is kept to what the pipeline can work on.
+#define FILTER_STATIC_QUEUE_CONCURRENCY ((ULONG)-1)
+#define FILTER_DERIVED_QUEUE_CONCURRENCY 8
+#define FILTER_FILE_BACKED_QUEUE_CONCURRENCY FILTER_PIPELINE_WORKER_COUNT
+
+// What answering a request may cost the filter, each has a queue of its own
+typedef enum _FILTER_COST_CLASS
+{
+	FilterCostStatic,     // Built in blobs, status only files and paths the filter does not own
+	FilterCostDerived,    // Patched blobs, a copy unless sfpd changed
+	FilterCostFileBacked, // sfpd files and directory listings
+	FilterCostClassCount
+} FILTER_COST_CLASS;
+
+typedef struct _FILTER_QUEUE_CONTEXT
+{
+	FILTER_COST_CLASS CostClass;
+
+	LONG volatile Depth;          // Routed here and not presented yet
+	LONG volatile PeakDepth;
+	LONG Presented;
+	LONG64 TotalWait;             // 100ns units, routed to presented
+	LONG64 volatile LongestWait;
+} FILTER_QUEUE_CONTEXT, * PFILTER_QUEUE_CONTEXT;
+
+WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(FILTER_QUEUE_CONTEXT, GetFilterQueueContext)
+
+typedef struct _FILTER_PIPELINE_WORKER_CONTEXT
+{
+	LONG volatile Busy; // Enqueued or draining PipelineRequests
+} FILTER_PIPELINE_WORKER_CONTEXT, * PFILTER_PIPELINE_WORKER_CONTEXT;
+
+WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(FILTER_PIPELINE_WORKER_CONTEXT, GetFilterPipelineWorkerContext)
+
+typedef struct _FILTER_NEGATIVE_CACHE_ENTRY
+{
+	ULONG IoControlCode;
+	ULONG PathHash;
+	WCHAR Path[VIRTUAL_FILE_MAX_PATH];
+} FILTER_NEGATIVE_CACHE_ENTRY, * PFILTER_NEGATIVE_CACHE_ENTRY;
+
+typedef struct _FILTER_DEVICE_CONTEXT
+{
+	BOOLEAN LocalServing;
+
+	// Requests SOCPartition failed and the filter then answered, these go
+	// straight to the filter from then on. Replaced round robin, protected
+	// by NegativeCacheLock.
+	WDFSPINLOCK NegativeCacheLock;
+	FILTER_NEGATIVE_CACHE_ENTRY NegativeCache[FILTER_NEGATIVE_CACHE_SIZE];
+	ULONG NegativeCacheCount;
+	ULONG NegativeCacheNext;
+
+	LONG LocallyServed;
+
+	// Completions that have to read sfpd, waiting for a worker. Completion
+	// routines can run at DISPATCH_LEVEL, the workers run at PASSIVE_LEVEL
+	// and complete the requests themselves. Protected by PipelineLock.
+	WDFSPINLOCK PipelineLock;
+	LIST_ENTRY PipelineRequests;
+	WDFWORKITEM PipelineWorkers[FILTER_PIPELINE_WORKER_COUNT];
+	LONG DeferredCompletions;
+
+	// Handled IOCTLs are routed from the default queue to one of these
+	WDFQUEUE CostQueues[FilterCostClassCount];
+} FILTER_DEVICE_CONTEXT, * PFILTER_DEVICE_CONTEXT;
+
+WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(FILTER_DEVICE_CONTEXT, GetFilterDeviceContext)
+
 DRIVER_INITIALIZE DriverEntry;
 
 EVT_WDF_DEVICE_CONTEXT_CLEANUP OnContextCleanup;
 
 EVT_WDF_DRIVER_DEVICE_ADD OnDeviceAdd;
 
+EVT_WDF_DEVICE_SURPRISE_REMOVAL OnDeviceSurpriseRemoval;
+
+EVT_WDF_DEVICE_SELF_MANAGED_IO_INIT OnDeviceSelfManagedIoInit;
+
+EVT_WDF_DEVICE_SELF_MANAGED_IO_CLEANUP OnDeviceSelfManagedIoCleanup;
+
 EVT_WDF_IO_QUEUE_IO_INTERNAL_DEVICE_CONTROL OnInternalDeviceControl;
 
 EVT_WDF_IO_QUEUE_IO_DEVICE_CONTROL OnIoDeviceControl;
 
-EVT_WDF_REQUEST_COMPLETION_ROUTINE OnRequestCompletionRoutine;
\ No newline at end of file
+EVT_WDF_REQUEST_COMPLETION_ROUTINE OnRequestCompletionRoutine;
+
+EVT_WDF_WORKITEM OnPipelineWorkItem;
+
+EVT_WDF_REQUEST_CANCEL OnPipelineRequestCancel;
\ No newline at end of file
@@ -0,0 +1,912 @@
+/*++
+
+Copyright (c) 2021-2024 DuoWoA authors. All Rights Reserved.
+
+Module Name:
+
+	packedblobs.h
+
+Abstract:
+
+	This file contains the provisioning blobs kept packed in the driver image.
+
+	Generated by tools\blobpack.py from src\packedblobs.in, edit that file
+	instead. vfile.c includes it ahead of the virtual file table, and
+	tools\blobcheck.c to check it against the source arrays.
+
+Environment:
+
+	Kernel-mode Driver Framework
+
+--*/
+
+#pragma once
+
+// WLAN_CLPC_PROVISION, 26328 bytes unpacked
+static const BYTE WLAN_CLPC_PROVISION_PACKED[7069] =
+{
+    0xD8, 0x66, 0x00, 0x00, 0x03, 0x01, 0x00, 0x04,
+    0x04, 0x80, 0x03, 0x05, 0xD0, 0x4A, 0x5F, 0xC0,
+    0x0A, 0x01, 0x80, 0x09, 0x08, 0x15, 0x4D, 0x01,
+    0x04, 0x00, 0x00, 0x01, 0x00, 0x0E, 0x80, 0x02,
+    0x02, 0x80, 0x40, 0x01, 0x80, 0x0A, 0x06, 0x90,
+    0x01, 0x00, 0x00, 0x02, 0x01, 0x01, 0x80, 0x05,
+    0x00, 0x89, 0x80, 0x18, 0x04, 0x80, 0x02, 0x04,
+    0x00, 0x60, 0x81, 0x01, 0x2F, 0x12, 0x01, 0x14,
+    0x01, 0x2E, 0x01, 0x2E, 0x01, 0x2E, 0x01, 0x2E,
+    0x01, 0x30, 0x01, 0x30, 0x01, 0x30, 0x01, 0x30,
+    0x01, 0x2E, 0x01, 0x32, 0x01, 0x30, 0x01, 0x30,
+    0x01, 0x2C, 0x01, 0x2C, 0x01, 0x10, 0x01, 0x1C,
+    0x01, 0x1C, 0x01, 0x1C, 0x01, 0x1C, 0x01, 0x1C,
+    0x01, 0x1C, 0x01, 0x1A, 0x01, 0x80, 0x07, 0x2B,
+    0x41, 0x02, 0x16, 0x01, 0x14, 0x01, 0x35, 0x01,
+    0x32, 0x01, 0x32, 0x01, 0x31, 0x01, 0x32, 0x01,
+    0x31, 0x01, 0x33, 0x01, 0x34, 0x01, 0x36, 0x01,
+    0x35, 0x01, 0x36, 0x01, 0x32, 0x01, 0x32, 0x01,
+    0x2C, 0x01, 0x07, 0x00, 0x38, 0x0F, 0x00, 0x0A,
+    0x01, 0x10, 0x80, 0x80, 0x80, 0x02, 0x01, 0x02,
+    0x08, 0x80, 0x1E, 0x04, 0x02, 0x03, 0x00, 0x00,
+    0x1E, 0x82, 0x1A, 0x03, 0x02, 0x00, 0x24, 0x01,
+    0x80, 0x03, 0x01, 0x3F, 0x20, 0x80, 0x05, 0x02,
+    0x3F, 0x43, 0x07, 0x80, 0x04, 0x06, 0x03, 0x00,
+    0x03, 0x00, 0x03, 0x00, 0x03, 0x80, 0x28, 0x00,
+    0x04, 0x80, 0x4E, 0x01, 0x2A, 0x20, 0x80, 0x05,
+    0x02, 0x0A, 0x43, 0x07, 0x80, 0x04, 0x06, 0x01,
+    0x00, 0x01, 0x00, 0x01, 0x00, 0x01, 0x80, 0x28,
+    0x00, 0x04, 0x80, 0x4E, 0x03, 0x03, 0x00, 0xE4,
+    0x01, 0x80, 0x6F, 0x07, 0x46, 0x46, 0x46, 0x06,
+    0x40, 0xCE, 0xA0, 0xD7, 0x80, 0x3B, 0x01, 0xB0,
+    0xB0, 0x80, 0x41, 0x08, 0x50, 0x0C, 0x0C, 0x00,
+    0x9E, 0x9E, 0xBA, 0x9C, 0x97, 0x80, 0xE2, 0x03,
+    0x04, 0x00, 0x04, 0x04, 0x80, 0x34, 0x00, 0x0A,
+    0x80, 0x02, 0x02, 0x80, 0x00, 0x80, 0x80, 0xD8,
+    0x02, 0x01, 0x01, 0x01, 0x80, 0x0F, 0x00, 0x01,
+    0x80, 0x0B, 0x00, 0x0A, 0x80, 0x02, 0x08, 0x80,
+    0x00, 0x80, 0x00, 0x01, 0x14, 0x14, 0x14, 0x14,
+    0x82, 0xC1, 0x03, 0x05, 0x00, 0x90, 0x02, 0x80,
+    0x03, 0x04, 0x0F, 0x00, 0x02, 0x03, 0x01, 0x80,
+    0x86, 0x00, 0x01, 0x80, 0x02, 0x09, 0xD0, 0x07,
+    0x00, 0x00, 0xA0, 0x0F, 0x00, 0x00, 0x70, 0x17,
+    0x81, 0xF1, 0x03, 0x06, 0x00, 0x7C, 0x02, 0x82,
+    0x7B, 0x03, 0x07, 0x00, 0x18, 0x01, 0x80, 0x05,
+    0x03, 0x78, 0x14, 0x00, 0x28, 0x80, 0x05, 0x0F,
+    0xFF, 0xFF, 0xFF, 0x3F, 0xFF, 0xFF, 0xFF, 0x3F,
+    0xFF, 0xFF, 0xFF, 0x3F, 0xFF, 0xFF, 0xFF, 0x3F,
+    0x80, 0x03, 0x09, 0x01, 0x14, 0x0F, 0x3F, 0x00,
+    0xF8, 0xF8, 0xF8, 0xF8, 0xF1, 0x80, 0x12, 0x08,
+    0x0A, 0x0A, 0x3F, 0x00, 0xF0, 0xF8, 0xF8, 0xF8,
+    0xF2, 0x80, 0x6D, 0x1F, 0xF0, 0xF0, 0xF0, 0xF0,
+    0xE8, 0xE8, 0xE8, 0xE8, 0x00, 0x01, 0x01, 0x01,
+    0x5F, 0x8A, 0x29, 0x05, 0x5F, 0x8A, 0x29, 0x05,
+    0x1F, 0x1F, 0xA0, 0xEC, 0x01, 0x01, 0x00, 0x00,
+    0xF0, 0xF0, 0xF0, 0xF0, 0x80, 0x03, 0x11, 0x0F,
+    0x1E, 0x00, 0x01, 0x01, 0x01, 0xFF, 0xFF, 0xFF,
+    0x05, 0xFF, 0xFF, 0xFF, 0x05, 0x03, 0x03, 0xA0,
+    0xEC, 0x80, 0x03, 0x03, 0xE8, 0xE8, 0xE8, 0xE8,
+    0x80, 0x03, 0x01, 0x2E, 0x2E, 0x80, 0x1B, 0x03,
+    0x08, 0x00, 0x44, 0x13, 0x80, 0x03, 0x33, 0x70,
+    0x75, 0x7A, 0x7F, 0x84, 0x89, 0x8E, 0x93, 0x98,
+    0x9D, 0xA2, 0xA7, 0xAC, 0xB8, 0x00, 0x00, 0x50,
+    0x94, 0x48, 0x87, 0x40, 0x78, 0x30, 0x5F, 0x18,
+    0x2E, 0x10, 0x1C, 0x08, 0x0B, 0x00, 0x00, 0x58,
+    0x95, 0x50, 0x89, 0x48, 0x7B, 0x38, 0x60, 0x20,
+    0x31, 0x18, 0x1A, 0x10, 0x0B, 0x00, 0x00, 0xE8,
+    0xE8, 0xB0, 0xAC, 0x80, 0x03, 0x0B, 0x50, 0x96,
+    0x48, 0x88, 0x40, 0x79, 0x30, 0x5F, 0x18, 0x2F,
+    0x08, 0x12, 0x80, 0x03, 0x13, 0x58, 0x96, 0x50,
+    0x8A, 0x48, 0x7C, 0x38, 0x61, 0x20, 0x33, 0x18,
+    0x1B, 0x10, 0x0C, 0x00, 0x00, 0xE8, 0xE8, 0xB0,
+    0xAC, 0x80, 0x03, 0x23, 0x50, 0x95, 0x48, 0x88,
+    0x40, 0x79, 0x30, 0x5F, 0x18, 0x2E, 0x10, 0x1D,
+    0x08, 0x0C, 0x00, 0x00, 0x58, 0x97, 0x50, 0x8B,
+    0x48, 0x7C, 0x38, 0x61, 0x20, 0x33, 0x18, 0x1C,
+    0x10, 0x0D, 0x00, 0x00, 0xE8, 0xE8, 0xB0, 0xAC,
+    0x80, 0x03, 0x23, 0x50, 0x96, 0x48, 0x89, 0x40,
+    0x78, 0x30, 0x60, 0x18, 0x2F, 0x10, 0x1C, 0x08,
+    0x0B, 0x00, 0x00, 0x58, 0x98, 0x48, 0x82, 0x40,
+    0x72, 0x38, 0x62, 0x20, 0x34, 0x10, 0x12, 0x08,
+    0x02, 0x00, 0x00, 0xE8, 0xE8, 0xB0, 0xAC, 0x80,
+    0x03, 0x0B, 0x50, 0x96, 0x48, 0x89, 0x38, 0x73,
+    0x30, 0x61, 0x18, 0x2F, 0x08, 0x14, 0x80, 0x03,
+    0x13, 0x58, 0x97, 0x50, 0x8B, 0x48, 0x7C, 0x38,
+    0x61, 0x20, 0x32, 0x18, 0x1B, 0x10, 0x0C, 0x00,
+    0x00, 0xE8, 0xE8, 0xB0, 0xAC, 0x80, 0x03, 0x0B,
+    0x50, 0x97, 0x48, 0x89, 0x38, 0x74, 0x30, 0x61,
+    0x18, 0x2F, 0x08, 0x15, 0x80, 0x03, 0x13, 0x58,
+    0x97, 0x50, 0x8B, 0x48, 0x7C, 0x38, 0x61, 0x20,
+    0x32, 0x18, 0x1B, 0x10, 0x0C, 0x00, 0x00, 0xE8,
+    0xE8, 0xB0, 0xAC, 0x80, 0x03, 0x0B, 0x50, 0x97,
+    0x48, 0x89, 0x38, 0x75, 0x30, 0x61, 0x18, 0x31,
+    0x08, 0x15, 0x80, 0x03, 0x13, 0x58, 0x96, 0x50,
+    0x8A, 0x48, 0x7C, 0x38, 0x60, 0x20, 0x31, 0x18,
+    0x1B, 0x10, 0x0C, 0x00, 0x00, 0xE8, 0xE8, 0xB0,
+    0xAC, 0x80, 0x03, 0x0B, 0x50, 0x98, 0x40, 0x83,
+    0x38, 0x75, 0x30, 0x62, 0x18, 0x32, 0x08, 0x17,
+    0x80, 0x03, 0x13, 0x58, 0x96, 0x50, 0x8A, 0x48,
+    0x7C, 0x38, 0x61, 0x20, 0x33, 0x18, 0x1C, 0x10,
+    0x0D, 0x00, 0x00, 0xE8, 0xE8, 0xB0, 0xAC, 0x80,
+    0x03, 0x23, 0x48, 0x93, 0x40, 0x84, 0x38, 0x77,
+    0x30, 0x64, 0x10, 0x2C, 0x08, 0x1A, 0x00, 0x02,
+    0x00, 0x00, 0x58, 0x94, 0x50, 0x89, 0x48, 0x7B,
+    0x38, 0x60, 0x20, 0x33, 0x18, 0x1C, 0x10, 0x0D,
+    0x00, 0x00, 0xE8, 0xE8, 0xB0, 0xAC, 0x80, 0x03,
+    0x0B, 0x48, 0x93, 0x40, 0x84, 0x38, 0x78, 0x28,
+    0x5F, 0x10, 0x2D, 0x08, 0x1B, 0x80, 0x03, 0x13,
+    0x58, 0x94, 0x50, 0x8A, 0x48, 0x7B, 0x38, 0x61,
+    0x20, 0x34, 0x10, 0x12, 0x08, 0x01, 0x00, 0x00,
+    0xE8, 0xE8, 0xB0, 0xAC, 0x80, 0x03, 0x23, 0x50,
+    0x97, 0x40, 0x83, 0x38, 0x76, 0x30, 0x63, 0x10,
+    0x2C, 0x08, 0x19, 0x00, 0x01, 0x00, 0x00, 0x58,
+    0x93, 0x50, 0x88, 0x48, 0x7A, 0x38, 0x60, 0x20,
+    0x33, 0x18, 0x1C, 0x10, 0x0D, 0x00, 0x00, 0xE8,
+    0xE8, 0xB0, 0xAC, 0x80, 0x03, 0x23, 0x50, 0x97,
+    0x48, 0x8A, 0x38, 0x74, 0x30, 0x62, 0x18, 0x32,
+    0x08, 0x17, 0x00, 0x01, 0x00, 0x00, 0x58, 0x93,
+    0x50, 0x87, 0x48, 0x79, 0x38, 0x5F, 0x20, 0x31,
+    0x18, 0x1B, 0x10, 0x0C, 0x00, 0x00, 0xE8, 0xE8,
+    0xB0, 0xAC, 0x80, 0x03, 0x0B, 0x50, 0x95, 0x48,
+    0x88, 0x40, 0x79, 0x30, 0x60, 0x18, 0x30, 0x08,
+    0x14, 0x80, 0x03, 0x13, 0x60, 0x95, 0x50, 0x84,
+    0x48, 0x76, 0x40, 0x66, 0x20, 0x2D, 0x18, 0x18,
+    0x10, 0x0A, 0x00, 0x00, 0xE8, 0xE8, 0xB0, 0xAC,
+    0x80, 0x03, 0x23, 0x68, 0x92, 0x58, 0x85, 0x48,
+    0x73, 0x38, 0x5F, 0x20, 0x33, 0x10, 0x15, 0x08,
+    0x04, 0x00, 0x00, 0x78, 0x8B, 0x68, 0x83, 0x58,
+    0x75, 0x48, 0x61, 0x28, 0x2B, 0x20, 0x19, 0x18,
+    0x05, 0x00, 0x00, 0xE8, 0xE8, 0xB0, 0xAC, 0x80,
+    0x03, 0x09, 0x8C, 0x41, 0x5A, 0x31, 0x3C, 0x23,
+    0x28, 0x15, 0x19, 0x04, 0x80, 0x09, 0x09, 0x8C,
+    0x4B, 0x5A, 0x3C, 0x3C, 0x2D, 0x28, 0x1F, 0x19,
+    0x0E, 0x80, 0x09, 0x09, 0x8C, 0x42, 0x5A, 0x33,
+    0x3C, 0x25, 0x28, 0x17, 0x19, 0x07, 0x80, 0x09,
+    0x09, 0x8C, 0x4E, 0x5A, 0x3E, 0x3C, 0x30, 0x28,
+    0x22, 0x19, 0x11, 0x80, 0x09, 0x09, 0x8C, 0x42,
+    0x5A, 0x33, 0x3C, 0x25, 0x28, 0x16, 0x19, 0x06,
+    0x80, 0x09, 0x09, 0x8C, 0x50, 0x5A, 0x40, 0x3C,
+    0x32, 0x28, 0x23, 0x19, 0x12, 0x80, 0x09, 0x09,
+    0x8C, 0x44, 0x5A, 0x34, 0x3C, 0x26, 0x28, 0x18,
+    0x19, 0x08, 0x80, 0x09, 0x09, 0x8C, 0x51, 0x5A,
+    0x41, 0x3C, 0x33, 0x28, 0x25, 0x19, 0x14, 0x80,
+    0x09, 0x09, 0x8C, 0x46, 0x5A, 0x36, 0x3C, 0x28,
+    0x28, 0x1A, 0x19, 0x09, 0x80, 0x09, 0x09, 0x8C,
+    0x4F, 0x5A, 0x40, 0x3C, 0x31, 0x28, 0x23, 0x19,
+    0x12, 0x80, 0x09, 0x09, 0x8C, 0x47, 0x5A, 0x37,
+    0x3C, 0x29, 0x28, 0x1B, 0x19, 0x0B, 0x80, 0x09,
+    0x09, 0x8C, 0x50, 0x5A, 0x40, 0x3C, 0x32, 0x28,
+    0x23, 0x19, 0x12, 0x80, 0x09, 0x09, 0x8C, 0x48,
+    0x5A, 0x39, 0x3C, 0x2B, 0x28, 0x1D, 0x19, 0x0C,
+    0x80, 0x09, 0x09, 0x8C, 0x51, 0x5A, 0x41, 0x3C,
+    0x32, 0x28, 0x24, 0x19, 0x13, 0x80, 0x09, 0x09,
+    0x8C, 0x4A, 0x5A, 0x3B, 0x3C, 0x2D, 0x28, 0x1F,
+    0x19, 0x0F, 0x80, 0x09, 0x09, 0x8C, 0x54, 0x5A,
+    0x44, 0x3C, 0x36, 0x28, 0x28, 0x19, 0x17, 0x80,
+    0x09, 0x09, 0x8C, 0x4E, 0x5A, 0x3F, 0x3C, 0x31,
+    0x28, 0x23, 0x19, 0x12, 0x80, 0x09, 0x09, 0x8C,
+    0x56, 0x5A, 0x46, 0x3C, 0x38, 0x28, 0x2A, 0x19,
+    0x19, 0x80, 0x09, 0x09, 0x8C, 0x50, 0x5A, 0x40,
+    0x3C, 0x32, 0x28, 0x24, 0x19, 0x14, 0x80, 0x09,
+    0x09, 0x8C, 0x59, 0x5A, 0x49, 0x3C, 0x3B, 0x28,
+    0x2D, 0x19, 0x1C, 0x80, 0x09, 0x09, 0x8C, 0x4E,
+    0x5A, 0x3F, 0x3C, 0x31, 0x28, 0x23, 0x19, 0x13,
+    0x80, 0x09, 0x09, 0x8C, 0x58, 0x5A, 0x49, 0x3C,
+    0x3A, 0x28, 0x2C, 0x19, 0x1B, 0x80, 0x09, 0x09,
+    0x8C, 0x4E, 0x5A, 0x3E, 0x3C, 0x31, 0x28, 0x23,
+    0x19, 0x12, 0x80, 0x09, 0x09, 0x8C, 0x57, 0x5A,
+    0x47, 0x3C, 0x39, 0x28, 0x2B, 0x19, 0x1A, 0x80,
+    0x09, 0x09, 0x8C, 0x4B, 0x5A, 0x3C, 0x3C, 0x2E,
+    0x28, 0x20, 0x19, 0x0F, 0x80, 0x09, 0x09, 0x8C,
+    0x54, 0x5A, 0x45, 0x3C, 0x36, 0x28, 0x28, 0x19,
+    0x18, 0x80, 0x09, 0x09, 0x8C, 0x37, 0x5A, 0x28,
+    0x3C, 0x1B, 0x28, 0x0D, 0x19, 0xFD, 0x80, 0x09,
+    0x09, 0x8C, 0x45, 0x5A, 0x35, 0x3C, 0x27, 0x28,
+    0x19, 0x19, 0x09, 0x82, 0x39, 0x43, 0x4C, 0x50,
+    0x54, 0x58, 0x5C, 0x60, 0x64, 0x68, 0x8C, 0x90,
+    0x94, 0x98, 0x9C, 0xA0, 0xA4, 0xA8, 0xAC, 0xB0,
+    0xB4, 0xBD, 0xC1, 0xC5, 0xC9, 0xCD, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x60, 0x95,
+    0x50, 0x85, 0x40, 0x73, 0x38, 0x67, 0x28, 0x53,
+    0x18, 0x3A, 0x08, 0x1C, 0x00, 0x00, 0x58, 0x93,
+    0x50, 0x85, 0x40, 0x75, 0x38, 0x68, 0x28, 0x55,
+    0x10, 0x34, 0x08, 0x1E, 0x00, 0x00, 0xE8, 0xE8,
+    0xAD, 0xA9, 0x80, 0x03, 0x23, 0x58, 0x92, 0x50,
+    0x87, 0x40, 0x76, 0x38, 0x69, 0x28, 0x55, 0x10,
+    0x33, 0x08, 0x1F, 0x00, 0x00, 0x58, 0x93, 0x48,
+    0x83, 0x40, 0x75, 0x38, 0x68, 0x28, 0x56, 0x10,
+    0x35, 0x08, 0x1F, 0x00, 0x00, 0xE8, 0xE8, 0xAD,
+    0xA9, 0x80, 0x03, 0x23, 0x60, 0x96, 0x50, 0x85,
+    0x40, 0x73, 0x38, 0x67, 0x28, 0x53, 0x18, 0x39,
+    0x08, 0x1B, 0x00, 0x00, 0x60, 0x94, 0x50, 0x85,
+    0x40, 0x74, 0x38, 0x66, 0x28, 0x53, 0x18, 0x38,
+    0x08, 0x1A, 0x00, 0x00, 0xE8, 0xE8, 0xAD, 0xA9,
+    0x80, 0x03, 0x23, 0x58, 0x93, 0x50, 0x87, 0x40,
+    0x75, 0x38, 0x69, 0x28, 0x55, 0x10, 0x33, 0x08,
+    0x1E, 0x00, 0x00, 0x58, 0x94, 0x48, 0x83, 0x40,
+    0x76, 0x38, 0x67, 0x28, 0x55, 0x10, 0x35, 0x08,
+    0x1E, 0x00, 0x00, 0xE8, 0xE8, 0xAD, 0xA9, 0x80,
+    0x03, 0x23, 0x58, 0x94, 0x48, 0x83, 0x40, 0x76,
+    0x30, 0x62, 0x28, 0x56, 0x10, 0x35, 0x08, 0x21,
+    0x00, 0x00, 0x58, 0x94, 0x48, 0x84, 0x40, 0x76,
+    0x38, 0x69, 0x28, 0x55, 0x10, 0x36, 0x08, 0x20,
+    0x00, 0x00, 0xE8, 0xE8, 0xAD, 0xA9, 0x80, 0x03,
+    0x23, 0x58, 0x94, 0x48, 0x84, 0x38, 0x73, 0x30,
+    0x64, 0x20, 0x53, 0x10, 0x38, 0x08, 0x24, 0x00,
+    0x00, 0x50, 0x93, 0x48, 0x84, 0x38, 0x75, 0x30,
+    0x64, 0x20, 0x55, 0x10, 0x37, 0x08, 0x23, 0x00,
+    0x00, 0xE8, 0xE8, 0xAD, 0xA9, 0x80, 0x03, 0x23,
+    0x50, 0x92, 0x48, 0x85, 0x38, 0x74, 0x30, 0x64,
+    0x20, 0x54, 0x10, 0x39, 0x08, 0x26, 0x00, 0x00,
+    0x50, 0x94, 0x40, 0x84, 0x38, 0x76, 0x28, 0x63,
+    0x20, 0x56, 0x10, 0x39, 0x08, 0x25, 0x00, 0x00,
+    0xE8, 0xE8, 0xAD, 0xA9, 0x80, 0x03, 0x23, 0x50,
+    0x94, 0x40, 0x83, 0x38, 0x76, 0x28, 0x63, 0x20,
+    0x56, 0x10, 0x3B, 0x08, 0x27, 0x00, 0x00, 0x50,
+    0x95, 0x40, 0x84, 0x38, 0x77, 0x28, 0x64, 0x20,
+    0x56, 0x10, 0x3B, 0x08, 0x27, 0x00, 0x00, 0xE8,
+    0xE8, 0xAD, 0xA9, 0x80, 0x03, 0x23, 0x50, 0x93,
+    0x48, 0x84, 0x38, 0x75, 0x30, 0x64, 0x20, 0x55,
+    0x10, 0x38, 0x08, 0x24, 0x00, 0x00, 0x50, 0x94,
+    0x40, 0x84, 0x38, 0x76, 0x28, 0x64, 0x20, 0x56,
+    0x10, 0x3A, 0x00, 0x16, 0x00, 0x00, 0xE8, 0xE8,
+    0xAD, 0xA9, 0x80, 0x03, 0x23, 0x50, 0x93, 0x48,
+    0x84, 0x38, 0x75, 0x30, 0x64, 0x20, 0x55, 0x10,
+    0x39, 0x08, 0x25, 0x00, 0x00, 0x50, 0x95, 0x40,
+    0x84, 0x38, 0x77, 0x28, 0x64, 0x20, 0x57, 0x10,
+    0x3C, 0x00, 0x17, 0x00, 0x00, 0xE8, 0xE8, 0xAD,
+    0xA9, 0x80, 0x03, 0x23, 0x50, 0x94, 0x40, 0x84,
+    0x38, 0x76, 0x28, 0x64, 0x20, 0x55, 0x10, 0x3A,
+    0x08, 0x26, 0x00, 0x00, 0x50, 0x94, 0x40, 0x84,
+    0x38, 0x77, 0x28, 0x64, 0x18, 0x55, 0x10, 0x3C,
+    0x00, 0x17, 0x00, 0x00, 0xE8, 0xE8, 0xAD, 0xA9,
+    0x80, 0x03, 0x23, 0x50, 0x95, 0x40, 0x84, 0x38,
+    0x77, 0x28, 0x64, 0x20, 0x56, 0x10, 0x3B, 0x08,
+    0x27, 0x00, 0x00, 0x50, 0x96, 0x40, 0x84, 0x38,
+    0x79, 0x28, 0x65, 0x18, 0x56, 0x08, 0x36, 0x00,
+    0x18, 0x00, 0x00, 0xE8, 0xE8, 0xAD, 0xA9, 0x80,
+    0x03, 0x23, 0x50, 0x94, 0x40, 0x84, 0x38, 0x77,
+    0x28, 0x65, 0x20, 0x56, 0x10, 0x3B, 0x00, 0x14,
+    0x00, 0x00, 0x50, 0x96, 0x40, 0x85, 0x30, 0x73,
+    0x28, 0x65, 0x18, 0x56, 0x08, 0x36, 0x00, 0x18,
+    0x00, 0x00, 0xE8, 0xE8, 0xAD, 0xA9, 0x80, 0x03,
+    0x23, 0x50, 0x95, 0x40, 0x85, 0x38, 0x78, 0x28,
+    0x64, 0x20, 0x57, 0x10, 0x3C, 0x00, 0x15, 0x00,
+    0x00, 0x48, 0x93, 0x40, 0x86, 0x30, 0x73, 0x20,
+    0x64, 0x18, 0x56, 0x08, 0x36, 0x00, 0x19, 0x00,
+    0x00, 0xE8, 0xE8, 0xAD, 0xA9, 0x80, 0x03, 0x23,
+    0x50, 0x96, 0x40, 0x85, 0x38, 0x79, 0x28, 0x64,
+    0x18, 0x55, 0x08, 0x34, 0x00, 0x17, 0x00, 0x00,
+    0x48, 0x93, 0x38, 0x84, 0x30, 0x74, 0x20, 0x64,
+    0x18, 0x56, 0x08, 0x36, 0x00, 0x1A, 0x00, 0x00,
+    0xE8, 0xE8, 0xAD, 0xA9, 0x80, 0x03, 0x23, 0x50,
+    0x93, 0x48, 0x84, 0x38, 0x75, 0x30, 0x63, 0x20,
+    0x55, 0x10, 0x37, 0x08, 0x23, 0x00, 0x00, 0x50,
+    0x93, 0x40, 0x84, 0x38, 0x75, 0x28, 0x64, 0x20,
+    0x55, 0x10, 0x39, 0x08, 0x25, 0x00, 0x00, 0xE8,
+    0xE8, 0xAD, 0xA9, 0x80, 0x03, 0x23, 0x50, 0x94,
+    0x48, 0x84, 0x38, 0x76, 0x30, 0x64, 0x20, 0x55,
+    0x10, 0x39, 0x08, 0x25, 0x00, 0x00, 0x50, 0x94,
+    0x40, 0x85, 0x38, 0x76, 0x30, 0x64, 0x20, 0x56,
+    0x10, 0x3A, 0x08, 0x26, 0x00, 0x00, 0xE8, 0xE8,
+    0xAD, 0xA9, 0x80, 0x03, 0x23, 0x50, 0x94, 0x40,
+    0x84, 0x38, 0x77, 0x28, 0x64, 0x20, 0x55, 0x10,
+    0x3A, 0x08, 0x27, 0x00, 0x00, 0x50, 0x94, 0x40,
+    0x83, 0x38, 0x77, 0x28, 0x64, 0x20, 0x55, 0x10,
+    0x3B, 0x00, 0x16, 0x00, 0x00, 0xE8, 0xE8, 0xAD,
+    0xA9, 0x80, 0x03, 0x23, 0x50, 0x95, 0x40, 0x85,
+    0x38, 0x77, 0x28, 0x64, 0x20, 0x56, 0x10, 0x3C,
+    0x00, 0x15, 0x00, 0x00, 0x50, 0x94, 0x40, 0x84,
+    0x38, 0x77, 0x28, 0x64, 0x20, 0x56, 0x10, 0x3B,
+    0x00, 0x15, 0x00, 0x00, 0xE8, 0xE8, 0xAD, 0xA9,
+    0x80, 0x03, 0x23, 0x48, 0x93, 0x40, 0x86, 0x30,
+    0x73, 0x20, 0x64, 0x18, 0x56, 0x08, 0x36, 0x00,
+    0x19, 0x00, 0x00, 0x50, 0x95, 0x40, 0x84, 0x38,
+    0x78, 0x28, 0x64, 0x20, 0x57, 0x10, 0x3D, 0x00,
+    0x15, 0x00, 0x00, 0xE8, 0xE8, 0xAD, 0xA9, 0x80,
+    0x03, 0x23, 0x48, 0x94, 0x38, 0x85, 0x30, 0x74,
+    0x20, 0x64, 0x18, 0x58, 0x08, 0x39, 0x00, 0x1D,
+    0x00, 0x00, 0x50, 0x95, 0x40, 0x84, 0x38, 0x78,
+    0x28, 0x64, 0x18, 0x54, 0x10, 0x3E, 0x00, 0x15,
+    0x00, 0x00, 0xE8, 0xE8, 0xAD, 0xA9, 0x80, 0x03,
+    0x23, 0x50, 0x96, 0x40, 0x85, 0x38, 0x78, 0x28,
+    0x65, 0x18, 0x54, 0x08, 0x34, 0x00, 0x17, 0x00,
+    0x00, 0x50, 0x94, 0x48, 0x84, 0x38, 0x75, 0x30,
+    0x64, 0x20, 0x54, 0x10, 0x38, 0x08, 0x26, 0x00,
+    0x00, 0xE8, 0xE8, 0xAD, 0xA9, 0x80, 0x03, 0x23,
+    0x48, 0x93, 0x38, 0x84, 0x30, 0x72, 0x20, 0x63,
+    0x18, 0x56, 0x08, 0x36, 0x00, 0x19, 0x00, 0x00,
+    0x50, 0x93, 0x48, 0x85, 0x38, 0x75, 0x30, 0x65,
+    0x20, 0x56, 0x10, 0x3B, 0x08, 0x27, 0x00, 0x00,
+    0xE8, 0xE8, 0xAD, 0xA9, 0x80, 0x03, 0x23, 0x48,
+    0x94, 0x38, 0x85, 0x30, 0x74, 0x20, 0x65, 0x18,
+    0x58, 0x08, 0x3A, 0x00, 0x1E, 0x00, 0x00, 0x50,
+    0x93, 0x40, 0x83, 0x38, 0x76, 0x28, 0x63, 0x20,
+    0x57, 0x10, 0x3C, 0x00, 0x15, 0x00, 0x00, 0xE8,
+    0xE8, 0xAD, 0xA9, 0x81, 0x43, 0x09, 0x8C, 0x96,
+    0x5A, 0x88, 0x3C, 0x7A, 0x28, 0x6C, 0x19, 0x5C,
+    0x80, 0x09, 0x09, 0x8C, 0xA7, 0x5A, 0x9A, 0x3C,
+    0x8D, 0x28, 0x80, 0x19, 0x6F, 0x80, 0x09, 0x09,
+    0x8C, 0x98, 0x5A, 0x89, 0x3C, 0x7C, 0x28, 0x6E,
+    0x19, 0x5D, 0x80, 0x09, 0x09, 0x8C, 0xA6, 0x5A,
+    0x98, 0x3C, 0x8C, 0x28, 0x7F, 0x19, 0x6F, 0x80,
+    0x09, 0x09, 0x8C, 0x98, 0x5A, 0x8A, 0x3C, 0x7C,
+    0x28, 0x6E, 0x19, 0x5E, 0x80, 0x09, 0x09, 0x8C,
+    0xA6, 0x5A, 0x98, 0x3C, 0x8C, 0x28, 0x7E, 0x19,
+    0x6E, 0x80, 0x09, 0x09, 0x8C, 0x98, 0x5A, 0x89,
+    0x3C, 0x7C, 0x28, 0x6E, 0x19, 0x5D, 0x80, 0x09,
+    0x09, 0x8C, 0xA7, 0x5A, 0x9A, 0x3C, 0x8D, 0x28,
+    0x80, 0x19, 0x6F, 0x80, 0x09, 0x09, 0x8C, 0x97,
+    0x5A, 0x89, 0x3C, 0x7B, 0x28, 0x6D, 0x19, 0x5C,
+    0x80, 0x09, 0x09, 0x8C, 0xA5, 0x5A, 0x98, 0x3C,
+    0x8B, 0x28, 0x7E, 0x19, 0x6D, 0x80, 0x09, 0x09,
+    0x8C, 0x97, 0x5A, 0x89, 0x3C, 0x7B, 0x28, 0x6D,
+    0x19, 0x5C, 0x80, 0x09, 0x09, 0x8C, 0xA7, 0x5A,
+    0x99, 0x3C, 0x8C, 0x28, 0x7E, 0x19, 0x6E, 0x80,
+    0x09, 0x09, 0x8C, 0x96, 0x5A, 0x88, 0x3C, 0x7A,
+    0x28, 0x6C, 0x19, 0x5C, 0x80, 0x09, 0x09, 0x8C,
+    0xA6, 0x5A, 0x98, 0x3C, 0x8B, 0x28, 0x7E, 0x19,
+    0x6D, 0x80, 0x09, 0x09, 0x8C, 0x98, 0x5A, 0x89,
+    0x3C, 0x7C, 0x28, 0x6E, 0x19, 0x5D, 0x80, 0x09,
+    0x09, 0x8C, 0xA5, 0x5A, 0x97, 0x3C, 0x8A, 0x28,
+    0x7D, 0x19, 0x6C, 0x80, 0x09, 0x09, 0x8C, 0x98,
+    0x5A, 0x8A, 0x3C, 0x7C, 0x28, 0x6E, 0x19, 0x5E,
+    0x80, 0x09, 0x09, 0x8C, 0xA5, 0x5A, 0x97, 0x3C,
+    0x8A, 0x28, 0x7C, 0x19, 0x6C, 0x80, 0x09, 0x09,
+    0x8C, 0x98, 0x5A, 0x8A, 0x3C, 0x7C, 0x28, 0x6F,
+    0x19, 0x5E, 0x80, 0x09, 0x09, 0x8C, 0xA5, 0x5A,
+    0x96, 0x3C, 0x89, 0x28, 0x7C, 0x19, 0x6C, 0x80,
+    0x09, 0x09, 0x8C, 0x99, 0x5A, 0x8B, 0x3C, 0x7D,
+    0x28, 0x6F, 0x19, 0x5F, 0x80, 0x09, 0x09, 0x8C,
+    0xA2, 0x5A, 0x95, 0x3C, 0x88, 0x28, 0x7A, 0x19,
+    0x6A, 0x80, 0x09, 0x09, 0x8C, 0x99, 0x5A, 0x8A,
+    0x3C, 0x7D, 0x28, 0x6F, 0x19, 0x5E, 0x80, 0x09,
+    0x09, 0x8C, 0xA4, 0x5A, 0x96, 0x3C, 0x89, 0x28,
+    0x7C, 0x19, 0x6B, 0x80, 0x09, 0x09, 0x8C, 0x99,
+    0x5A, 0x8B, 0x3C, 0x7D, 0x28, 0x6F, 0x19, 0x5F,
+    0x80, 0x09, 0x09, 0x8C, 0xA3, 0x5A, 0x95, 0x3C,
+    0x88, 0x28, 0x7B, 0x19, 0x6B, 0x80, 0x09, 0x09,
+    0x8C, 0x99, 0x5A, 0x8B, 0x3C, 0x7D, 0x28, 0x6F,
+    0x19, 0x5F, 0x80, 0x09, 0x09, 0x8C, 0xA3, 0x5A,
+    0x95, 0x3C, 0x88, 0x28, 0x7B, 0x19, 0x6B, 0x80,
+    0x09, 0x09, 0x8C, 0x9A, 0x5A, 0x8C, 0x3C, 0x7E,
+    0x28, 0x70, 0x19, 0x60, 0x80, 0x09, 0x09, 0x8C,
+    0xA4, 0x5A, 0x96, 0x3C, 0x89, 0x28, 0x7C, 0x19,
+    0x6B, 0x80, 0x09, 0x09, 0x8C, 0x99, 0x5A, 0x8B,
+    0x3C, 0x7D, 0x28, 0x6F, 0x19, 0x5F, 0x80, 0x09,
+    0x09, 0x8C, 0xA4, 0x5A, 0x96, 0x3C, 0x89, 0x28,
+    0x7B, 0x19, 0x6B, 0x80, 0x09, 0x09, 0x8C, 0x99,
+    0x5A, 0x8A, 0x3C, 0x7D, 0x28, 0x6F, 0x19, 0x5E,
+    0x80, 0x09, 0x09, 0x8C, 0xA3, 0x5A, 0x95, 0x3C,
+    0x88, 0x28, 0x7B, 0x19, 0x6A, 0x80, 0x09, 0x09,
+    0x8C, 0x9B, 0x5A, 0x8C, 0x3C, 0x7E, 0x28, 0x70,
+    0x19, 0x5F, 0x80, 0x09, 0x09, 0x8C, 0xA2, 0x5A,
+    0x94, 0x3C, 0x87, 0x28, 0x7A, 0x19, 0x69, 0x80,
+    0x09, 0x09, 0x8C, 0x9A, 0x5A, 0x8B, 0x3C, 0x7D,
+    0x28, 0x6F, 0x19, 0x5F, 0x80, 0x09, 0x09, 0x8C,
+    0xA2, 0x5A, 0x94, 0x3C, 0x87, 0x28, 0x79, 0x19,
+    0x69, 0x80, 0x09, 0x09, 0x8C, 0x99, 0x5A, 0x8B,
+    0x3C, 0x7D, 0x28, 0x6F, 0x19, 0x5F, 0x80, 0x09,
+    0x09, 0x8C, 0x9F, 0x5A, 0x91, 0x3C, 0x84, 0x28,
+    0x76, 0x19, 0x66, 0x80, 0x09, 0x09, 0x8C, 0x9A,
+    0x5A, 0x8B, 0x3C, 0x7D, 0x28, 0x6F, 0x19, 0x5F,
+    0x80, 0x09, 0x09, 0x8C, 0x9E, 0x5A, 0x90, 0x3C,
+    0x83, 0x28, 0x75, 0x19, 0x65, 0x80, 0x09, 0x09,
+    0x8C, 0x99, 0x5A, 0x8B, 0x3C, 0x7D, 0x28, 0x6F,
+    0x19, 0x5F, 0x80, 0x09, 0x09, 0x8C, 0x9D, 0x5A,
+    0x90, 0x3C, 0x83, 0x28, 0x75, 0x19, 0x64, 0x80,
+    0x09, 0x09, 0x8C, 0x98, 0x5A, 0x8A, 0x3C, 0x7C,
+    0x28, 0x6E, 0x19, 0x5E, 0x80, 0x09, 0x09, 0x8C,
+    0x9C, 0x5A, 0x8E, 0x3C, 0x81, 0x28, 0x73, 0x19,
+    0x63, 0x80, 0x09, 0x09, 0x8C, 0x98, 0x5A, 0x8A,
+    0x3C, 0x7C, 0x28, 0x6E, 0x19, 0x5E, 0x80, 0x09,
+    0x09, 0x8C, 0x9B, 0x5A, 0x8D, 0x3C, 0x80, 0x28,
+    0x72, 0x19, 0x61, 0x83, 0xC9, 0x03, 0x09, 0x00,
+    0x98, 0x03, 0x80, 0x04, 0x3E, 0x01, 0x02, 0x03,
+    0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B,
+    0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xE8, 0xE8, 0xE8, 0xE8,
+    0xE8, 0xE8, 0xE8, 0xE8, 0xE8, 0xE8, 0xE8, 0xE8,
+    0xE8, 0xE8, 0xE8, 0xE8, 0xE8, 0xE8, 0xE8, 0xE8,
+    0xE8, 0xE8, 0xE8, 0xE8, 0xE8, 0xE8, 0xE8, 0xE8,
+    0xE8, 0xE8, 0xE8, 0xE8, 0x80, 0x20, 0x2B, 0x24,
+    0x3C, 0x50, 0x68, 0x78, 0x88, 0x90, 0x98, 0xA0,
+    0xB0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x90, 0x80,
+    0x70, 0x5C, 0x28, 0x10, 0x00, 0x00, 0x8C, 0x5A,
+    0x3C, 0x28, 0x19, 0x80, 0x0D, 0x7F, 0x40, 0x40,
+    0x40, 0x40, 0x40, 0x40, 0x48, 0x05, 0x08, 0x00,
+    0x01, 0x08, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04,
+    0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C,
+    0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xE8, 0xE8, 0xE8, 0xE8, 0xE8,
+    0xE8, 0xE8, 0xE8, 0xE8, 0xE8, 0xE8, 0xE8, 0xE8,
+    0xE8, 0xE8, 0xE8, 0xE8, 0xE8, 0xE8, 0xE8, 0xE8,
+    0xE8, 0xE8, 0xE8, 0xE8, 0xE8, 0xE8, 0xE8, 0xE8,
+    0xE8, 0xE8, 0xE8, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x00, 0x10, 0x20, 0x30, 0x38,
+    0x40, 0x48, 0x50, 0x60, 0x70, 0x78, 0x80, 0x88,
+    0x8E, 0x96, 0xFF, 0xFF, 0xFF, 0xFF, 0x19, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0x90, 0x80, 0x70, 0x60,
+    0x50, 0x30, 0x10, 0x00, 0x8C, 0x5A, 0x3C, 0x28,
+    0x19, 0x80, 0x04, 0x14, 0x25, 0x25, 0x24, 0x25,
+    0x25, 0x24, 0x23, 0x22, 0x21, 0x20, 0x23, 0x21,
+    0x21, 0x22, 0x21, 0x58, 0x06, 0x08, 0x00, 0x01,
+    0x08, 0x80, 0x5E, 0x01, 0x06, 0x06, 0x80, 0x05,
+    0x01, 0x06, 0x06, 0x80, 0x03, 0x00, 0x31, 0x80,
+    0x1C, 0x01, 0x06, 0x06, 0x80, 0x05, 0x01, 0x06,
+    0x06, 0x80, 0x05, 0x01, 0x06, 0x06, 0x80, 0x03,
+    0x00, 0x31, 0x80, 0x26, 0x7D, 0x24, 0x24, 0x23,
+    0x24, 0x24, 0x23, 0x25, 0x22, 0x21, 0x21, 0x23,
+    0x22, 0x21, 0x22, 0x21, 0x24, 0x24, 0x23, 0x24,
+    0x24, 0x23, 0x25, 0x22, 0x21, 0x21, 0x23, 0x22,
+    0x21, 0x22, 0x21, 0x00, 0x00, 0x24, 0x24, 0x23,
+    0x24, 0x24, 0x23, 0x25, 0x22, 0x21, 0x21, 0x23,
+    0x22, 0x21, 0x22, 0x21, 0x24, 0x24, 0x23, 0x24,
+    0x24, 0x23, 0x25, 0x22, 0x21, 0x21, 0x23, 0x22,
+    0x21, 0x22, 0x21, 0x00, 0x00, 0x25, 0x25, 0x24,
+    0x25, 0x25, 0x24, 0x23, 0x22, 0x21, 0x20, 0x23,
+    0x21, 0x21, 0x22, 0x21, 0x25, 0x25, 0x24, 0x25,
+    0x25, 0x24, 0x23, 0x22, 0x21, 0x20, 0x23, 0x21,
+    0x21, 0x22, 0x21, 0x00, 0x00, 0x25, 0x25, 0x24,
+    0x25, 0x25, 0x24, 0x23, 0x22, 0x21, 0x20, 0x23,
+    0x21, 0x21, 0x22, 0x21, 0x25, 0x25, 0x24, 0x25,
+    0x25, 0x24, 0x23, 0x22, 0x21, 0x20, 0x23, 0x21,
+    0x21, 0x22, 0x21, 0x80, 0x03, 0x00, 0xFB, 0x80,
+    0x05, 0x05, 0x04, 0x00, 0x04, 0x03, 0x05, 0x03,
+    0x80, 0x0C, 0x01, 0xF4, 0x01, 0x80, 0x07, 0x0C,
+    0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+    0x01, 0x01, 0x01, 0x01, 0x01, 0x80, 0xC8, 0x03,
+    0x0A, 0x00, 0xA0, 0x03, 0x80, 0x03, 0x27, 0x70,
+    0x89, 0x9D, 0xAC, 0x70, 0x89, 0x9D, 0xAC, 0x25,
+    0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25,
+    0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25,
+    0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25,
+    0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x80,
+    0xFF, 0x4F, 0x4C, 0x58, 0x5C, 0x68, 0x8C, 0xA0,
+    0xB4, 0xC9, 0x4C, 0x58, 0x5C, 0x68, 0x8C, 0xA0,
+    0xB4, 0xC9, 0x27, 0x26, 0x25, 0x24, 0x27, 0x26,
+    0x25, 0x24, 0x27, 0x26, 0x25, 0x24, 0x27, 0x26,
+    0x25, 0x24, 0x27, 0x26, 0x25, 0x24, 0x27, 0x26,
+    0x25, 0x24, 0x27, 0x26, 0x25, 0x24, 0x27, 0x26,
+    0x25, 0x24, 0x27, 0x26, 0x25, 0x24, 0x27, 0x26,
+    0x25, 0x24, 0x27, 0x26, 0x25, 0x24, 0x27, 0x26,
+    0x25, 0x24, 0x27, 0x26, 0x25, 0x24, 0x27, 0x26,
+    0x25, 0x24, 0x27, 0x26, 0x25, 0x24, 0x27, 0x26,
+    0x25, 0x24, 0x82, 0x23, 0x03, 0x0B, 0x00, 0x04,
+    0x04, 0x80, 0x03, 0x53, 0x24, 0x24, 0x24, 0x24,
+    0x26, 0x26, 0x26, 0x24, 0x20, 0x20, 0x1E, 0x1D,
+    0x24, 0x24, 0x22, 0x1E, 0x1E, 0x1E, 0x1C, 0x1C,
+    0x24, 0x24, 0x22, 0x1E, 0x1E, 0x1E, 0x1C, 0x1C,
+    0x24, 0x24, 0x22, 0x1E, 0x1E, 0x1E, 0x1C, 0x1C,
+    0x24, 0x24, 0x22, 0x1E, 0x1E, 0x1E, 0x1C, 0x1C,
+    0x24, 0x24, 0x22, 0x1E, 0x1E, 0x1E, 0x1C, 0x1C,
+    0x1A, 0x1C, 0x24, 0x24, 0x22, 0x1E, 0x1E, 0x1E,
+    0x1C, 0x1C, 0x1A, 0x1C, 0x24, 0x24, 0x22, 0x1E,
+    0x1E, 0x1E, 0x1C, 0x1C, 0x1C, 0x1C, 0x24, 0x24,
+    0x22, 0x1E, 0x1E, 0x1E, 0x1C, 0x1C, 0x1C, 0x1C,
+    0x80, 0x22, 0x02, 0xFB, 0x64, 0xFB, 0x80, 0x89,
+    0x72, 0x26, 0x26, 0x26, 0x26, 0x26, 0x26, 0x24,
+    0x22, 0x24, 0x24, 0x24, 0x24, 0x20, 0x20, 0x20,
+    0x20, 0x24, 0x24, 0x24, 0x24, 0x20, 0x20, 0x20,
+    0x20, 0x24, 0x24, 0x24, 0x24, 0x20, 0x20, 0x20,
+    0x20, 0x24, 0x24, 0x24, 0x24, 0x20, 0x20, 0x20,
+    0x20, 0x24, 0x24, 0x24, 0x24, 0x22, 0x1E, 0x1E,
+    0x1E, 0x1E, 0x20, 0x24, 0x24, 0x24, 0x24, 0x22,
+    0x1E, 0x1E, 0x1E, 0x1E, 0x20, 0x24, 0x24, 0x24,
+    0x24, 0x22, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x24,
+    0x24, 0x24, 0x24, 0x22, 0x1E, 0x1E, 0x1E, 0x1E,
+    0x1E, 0x24, 0x24, 0x24, 0x24, 0x22, 0x1E, 0x1E,
+    0x1E, 0x1E, 0x1E, 0x24, 0x24, 0x24, 0x24, 0x22,
+    0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x24, 0x24, 0x24,
+    0x24, 0x22, 0x22, 0x22, 0x22, 0x20, 0x20, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x80, 0x03, 0x72, 0x26,
+    0x26, 0x26, 0x26, 0x26, 0x26, 0x24, 0x22, 0x24,
+    0x24, 0x24, 0x24, 0x20, 0x20, 0x20, 0x20, 0x24,
+    0x24, 0x24, 0x24, 0x20, 0x20, 0x20, 0x20, 0x24,
+    0x24, 0x24, 0x24, 0x20, 0x20, 0x20, 0x20, 0x24,
+    0x24, 0x24, 0x24, 0x20, 0x20, 0x20, 0x20, 0x24,
+    0x24, 0x24, 0x24, 0x22, 0x1E, 0x1E, 0x1E, 0x1E,
+    0x20, 0x24, 0x24, 0x24, 0x24, 0x22, 0x1E, 0x1E,
+    0x1E, 0x1E, 0x20, 0x24, 0x24, 0x24, 0x24, 0x22,
+    0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x24, 0x24, 0x24,
+    0x24, 0x22, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x24,
+    0x24, 0x24, 0x24, 0x22, 0x1E, 0x1E, 0x1E, 0x1E,
+    0x1E, 0x24, 0x24, 0x24, 0x24, 0x22, 0x1E, 0x1E,
+    0x1E, 0x1E, 0x1E, 0x24, 0x24, 0x24, 0x24, 0x22,
+    0x22, 0x22, 0x22, 0x20, 0x20, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x80, 0x03, 0x75, 0x26, 0x26, 0x26,
+    0x26, 0x26, 0x26, 0x24, 0x22, 0x24, 0x24, 0x24,
+    0x24, 0x20, 0x20, 0x20, 0x20, 0x24, 0x24, 0x24,
+    0x24, 0x20, 0x20, 0x20, 0x20, 0x24, 0x24, 0x24,
+    0x24, 0x20, 0x20, 0x20, 0x20, 0x24, 0x24, 0x24,
+    0x24, 0x20, 0x20, 0x20, 0x20, 0x24, 0x24, 0x24,
+    0x24, 0x22, 0x1E, 0x1E, 0x1E, 0x1E, 0x20, 0x24,
+    0x24, 0x24, 0x24, 0x22, 0x1E, 0x1E, 0x1E, 0x1E,
+    0x20, 0x24, 0x24, 0x24, 0x24, 0x22, 0x1E, 0x1E,
+    0x1E, 0x1E, 0x1E, 0x24, 0x24, 0x24, 0x24, 0x22,
+    0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x24, 0x24, 0x24,
+    0x24, 0x22, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x24,
+    0x24, 0x24, 0x24, 0x22, 0x1E, 0x1E, 0x1E, 0x1E,
+    0x1E, 0x24, 0x24, 0x24, 0x24, 0x22, 0x22, 0x22,
+    0x22, 0x20, 0x20, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0xFB, 0x64, 0xF4, 0x80, 0x03, 0x01, 0x02, 0x02,
+    0x81, 0x91, 0x03, 0x0C, 0x00, 0x68, 0x0D, 0x80,
+    0x03, 0x7F, 0x01, 0x02, 0x02, 0x00, 0x01, 0x00,
+    0x01, 0x02, 0x01, 0x00, 0x01, 0x00, 0x01, 0x08,
+    0x02, 0x00, 0x01, 0x00, 0x01, 0x08, 0x01, 0x00,
+    0x01, 0x00, 0x01, 0x06, 0x02, 0x00, 0x01, 0x00,
+    0x01, 0x06, 0x01, 0x00, 0x01, 0x00, 0x70, 0x75,
+    0x7A, 0x7F, 0x84, 0x89, 0x8E, 0x93, 0x98, 0x9D,
+    0xA2, 0xA7, 0xAC, 0xB8, 0x00, 0x00, 0x20, 0x24,
+    0x24, 0x24, 0x24, 0x24, 0x24, 0x24, 0x24, 0x24,
+    0x20, 0x18, 0x14, 0x80, 0x20, 0x24, 0x24, 0x24,
+    0x24, 0x24, 0x24, 0x24, 0x24, 0x24, 0x20, 0x18,
+    0x14, 0x80, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x80,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x80, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x80, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x7F, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x80, 0x02, 0x02, 0x02, 0x00, 0x01,
+    0x00, 0x02, 0x02, 0x02, 0x00, 0x02, 0x00, 0x02,
+    0x02, 0x01, 0x00, 0x01, 0x00, 0x02, 0x03, 0x02,
+    0x00, 0x01, 0x00, 0x00, 0x02, 0x02, 0x00, 0x01,
+    0x00, 0x00, 0x02, 0x01, 0x00, 0x01, 0x00, 0x00,
+    0x03, 0x02, 0x00, 0x01, 0x00, 0x02, 0x08, 0x02,
+    0x00, 0x01, 0x00, 0x02, 0x08, 0x02, 0x00, 0x02,
+    0x00, 0x02, 0x08, 0x01, 0x00, 0x01, 0x00, 0x02,
+    0x09, 0x02, 0x00, 0x01, 0x00, 0x00, 0x08, 0x02,
+    0x00, 0x01, 0x00, 0x00, 0x08, 0x01, 0x00, 0x01,
+    0x00, 0x00, 0x09, 0x02, 0x00, 0x01, 0x00, 0x02,
+    0x06, 0x02, 0x00, 0x01, 0x00, 0x02, 0x06, 0x02,
+    0x00, 0x02, 0x00, 0x02, 0x06, 0x01, 0x00, 0x01,
+    0x00, 0x02, 0x07, 0x02, 0x00, 0x01, 0x00, 0x00,
+    0x06, 0x02, 0x00, 0x01, 0x00, 0x00, 0x06, 0x01,
+    0x00, 0x01, 0x00, 0x7F, 0x00, 0x07, 0x02, 0x00,
+    0x01, 0x00, 0x70, 0x75, 0x7A, 0x7F, 0x84, 0x89,
+    0x8E, 0x93, 0x98, 0x9D, 0xA2, 0xA7, 0xAC, 0xB8,
+    0x20, 0x24, 0x24, 0x24, 0x24, 0x24, 0x24, 0x24,
+    0x24, 0x24, 0x20, 0x18, 0x0A, 0x80, 0x20, 0x24,
+    0x24, 0x24, 0x24, 0x24, 0x24, 0x24, 0x24, 0x24,
+    0x20, 0x18, 0x0A, 0x80, 0x20, 0x24, 0x24, 0x24,
+    0x24, 0x24, 0x24, 0x24, 0x24, 0x24, 0x20, 0x18,
+    0x0A, 0x80, 0x20, 0x24, 0x24, 0x24, 0x24, 0x24,
+    0x24, 0x24, 0x24, 0x24, 0x20, 0x18, 0x0A, 0x80,
+    0x20, 0x24, 0x24, 0x24, 0x24, 0x24, 0x24, 0x24,
+    0x24, 0x24, 0x20, 0x18, 0x0A, 0x80, 0x20, 0x24,
+    0x24, 0x24, 0x24, 0x24, 0x24, 0x24, 0x24, 0x24,
+    0x20, 0x18, 0x0A, 0x80, 0x20, 0x24, 0x24, 0x24,
+    0x24, 0x24, 0x24, 0x24, 0x24, 0x24, 0x20, 0x18,
+    0x0A, 0x80, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x7F, 0x16, 0x16, 0x16,
+    0x80, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x80, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x80, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x80, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x80, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x80, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x80, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x80, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x80, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x7F, 0x18, 0x80,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x80, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x80, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x80, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x80,
+    0x00, 0x00, 0x03, 0x02, 0x02, 0x00, 0x01, 0x00,
+    0x03, 0x02, 0x02, 0x00, 0x02, 0x00, 0x03, 0x02,
+    0x01, 0x00, 0x01, 0x00, 0x03, 0x03, 0x02, 0x00,
+    0x01, 0x00, 0x03, 0x08, 0x02, 0x00, 0x01, 0x00,
+    0x03, 0x08, 0x02, 0x00, 0x02, 0x00, 0x03, 0x08,
+    0x01, 0x00, 0x01, 0x00, 0x03, 0x09, 0x02, 0x00,
+    0x01, 0x00, 0x03, 0x06, 0x02, 0x00, 0x01, 0x00,
+    0x03, 0x06, 0x02, 0x00, 0x02, 0x00, 0x03, 0x06,
+    0x01, 0x00, 0x01, 0x00, 0x03, 0x07, 0x0C, 0x02,
+    0x00, 0x01, 0x00, 0x7A, 0x7F, 0x84, 0x89, 0x8E,
+    0x93, 0x98, 0x9D, 0xA2, 0x80, 0x02, 0x6B, 0x1A,
+    0x1E, 0x20, 0x21, 0x20, 0x1C, 0x1C, 0x1C, 0x8E,
+    0x1A, 0x1E, 0x20, 0x21, 0x20, 0x1C, 0x1C, 0x1C,
+    0x8E, 0x1A, 0x1E, 0x20, 0x21, 0x20, 0x1C, 0x1C,
+    0x1C, 0x8E, 0x1A, 0x1E, 0x20, 0x21, 0x20, 0x1C,
+    0x1C, 0x1C, 0x8E, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x96, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x96, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x96, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x96, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x98,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x98, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x98, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x98, 0x81, 0x00, 0x6B, 0x02, 0x02,
+    0x00, 0x01, 0x00, 0x00, 0x02, 0x01, 0x00, 0x01,
+    0x00, 0x00, 0x03, 0x02, 0x00, 0x01, 0x00, 0x00,
+    0x08, 0x02, 0x00, 0x01, 0x00, 0x00, 0x08, 0x01,
+    0x00, 0x01, 0x00, 0x00, 0x09, 0x02, 0x00, 0x01,
+    0x00, 0x00, 0x06, 0x02, 0x00, 0x01, 0x00, 0x00,
+    0x06, 0x01, 0x00, 0x01, 0x00, 0x00, 0x07, 0x02,
+    0x00, 0x01, 0x00, 0x4C, 0x50, 0x54, 0x58, 0x5C,
+    0x60, 0x64, 0x68, 0x8C, 0x90, 0x94, 0x98, 0x9C,
+    0xA0, 0xA4, 0xA8, 0xAC, 0xB0, 0xB4, 0xB8, 0xBD,
+    0xC1, 0xC5, 0xC9, 0xCD, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x00, 0x16, 0x16, 0x16, 0x16, 0x21, 0x21, 0x20,
+    0x20, 0x20, 0x21, 0x21, 0x21, 0x21, 0x21, 0x21,
+    0x21, 0x21, 0x21, 0x1D, 0x20, 0x24, 0x24, 0x24,
+    0x24, 0x24, 0x80, 0x03, 0x18, 0x16, 0x16, 0x16,
+    0x16, 0x21, 0x21, 0x20, 0x20, 0x20, 0x21, 0x21,
+    0x21, 0x21, 0x21, 0x21, 0x21, 0x21, 0x21, 0x1D,
+    0x20, 0x24, 0x24, 0x24, 0x24, 0x24, 0x80, 0x03,
+    0x18, 0x16, 0x16, 0x16, 0x16, 0x21, 0x21, 0x20,
+    0x20, 0x20, 0x21, 0x21, 0x21, 0x21, 0x21, 0x21,
+    0x21, 0x21, 0x21, 0x1D, 0x20, 0x24, 0x24, 0x24,
+    0x24, 0x24, 0x80, 0x03, 0x18, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x18, 0x18, 0x18, 0x18, 0x18, 0x80, 0x03,
+    0x18, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x80, 0x03, 0x18, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x18, 0x18, 0x18, 0x18, 0x18, 0x80, 0x03,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x0C, 0x0C, 0x0C,
+    0x0C, 0x0C, 0x80, 0x03, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x80, 0x03,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x0C, 0x0C, 0x0C,
+    0x0C, 0x0C, 0x80, 0x06, 0x64, 0x02, 0x02, 0x02,
+    0x00, 0x01, 0x00, 0x02, 0x02, 0x02, 0x00, 0x02,
+    0x00, 0x02, 0x02, 0x01, 0x00, 0x01, 0x00, 0x02,
+    0x03, 0x02, 0x00, 0x01, 0x00, 0x02, 0x08, 0x02,
+    0x00, 0x01, 0x00, 0x02, 0x08, 0x02, 0x00, 0x02,
+    0x00, 0x02, 0x08, 0x01, 0x00, 0x01, 0x00, 0x02,
+    0x09, 0x02, 0x00, 0x01, 0x00, 0x02, 0x06, 0x02,
+    0x00, 0x01, 0x00, 0x02, 0x06, 0x02, 0x00, 0x02,
+    0x00, 0x02, 0x06, 0x01, 0x00, 0x01, 0x00, 0x02,
+    0x07, 0x02, 0x00, 0x01, 0x00, 0x4C, 0x50, 0x54,
+    0x58, 0x5C, 0x60, 0x64, 0x68, 0x8C, 0x90, 0x94,
+    0x98, 0x9C, 0xA0, 0xA4, 0xA8, 0xAC, 0xB0, 0xB4,
+    0xB8, 0xBD, 0xC1, 0xC5, 0xC9, 0xCD, 0xFF, 0xFF,
+    0xFF, 0xFF, 0x80, 0x02, 0x18, 0x17, 0x18, 0x18,
+    0x18, 0x21, 0x21, 0x20, 0x20, 0x20, 0x21, 0x21,
+    0x21, 0x21, 0x21, 0x21, 0x21, 0x21, 0x21, 0x1D,
+    0x20, 0x24, 0x24, 0x24, 0x24, 0x24, 0x80, 0x03,
+    0x18, 0x17, 0x18, 0x18, 0x18, 0x21, 0x21, 0x20,
+    0x20, 0x20, 0x21, 0x21, 0x21, 0x21, 0x21, 0x21,
+    0x21, 0x21, 0x21, 0x1D, 0x20, 0x24, 0x24, 0x24,
+    0x24, 0x24, 0x80, 0x03, 0x18, 0x17, 0x18, 0x18,
+    0x18, 0x22, 0x22, 0x22, 0x20, 0x20, 0x21, 0x21,
+    0x21, 0x21, 0x21, 0x21, 0x21, 0x21, 0x21, 0x1D,
+    0x20, 0x24, 0x24, 0x24, 0x24, 0x24, 0x80, 0x03,
+    0x18, 0x17, 0x18, 0x18, 0x18, 0x22, 0x22, 0x22,
+    0x20, 0x20, 0x21, 0x21, 0x21, 0x21, 0x21, 0x21,
+    0x21, 0x21, 0x21, 0x1D, 0x20, 0x24, 0x24, 0x24,
+    0x24, 0x24, 0x80, 0x03, 0x18, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x18, 0x18, 0x18, 0x18, 0x18, 0x80, 0x03,
+    0x18, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x80, 0x03, 0x18, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x18, 0x18, 0x18, 0x18, 0x18, 0x80, 0x03,
+    0x18, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x80, 0x03, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x80, 0x03,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x0C, 0x0C, 0x0C,
+    0x0C, 0x0C, 0x80, 0x03, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x80, 0x03,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x0C, 0x0C, 0x0C,
+    0x0C, 0x0C, 0x80, 0x03, 0x7F, 0x03, 0x02, 0x02,
+    0x00, 0x01, 0x00, 0x03, 0x02, 0x02, 0x00, 0x02,
+    0x00, 0x03, 0x02, 0x01, 0x00, 0x01, 0x00, 0x03,
+    0x03, 0x02, 0x00, 0x01, 0x00, 0x03, 0x08, 0x02,
+    0x00, 0x01, 0x00, 0x03, 0x08, 0x02, 0x00, 0x02,
+    0x00, 0x03, 0x08, 0x01, 0x00, 0x01, 0x00, 0x03,
+    0x09, 0x02, 0x00, 0x01, 0x00, 0x03, 0x06, 0x02,
+    0x00, 0x01, 0x00, 0x03, 0x06, 0x02, 0x00, 0x02,
+    0x00, 0x03, 0x06, 0x01, 0x00, 0x01, 0x00, 0x03,
+    0x07, 0x02, 0x00, 0x01, 0x00, 0x4E, 0x52, 0x56,
+    0x5A, 0x5E, 0x62, 0x66, 0x8E, 0x92, 0x96, 0x9A,
+    0x9E, 0xA2, 0xA6, 0xAA, 0xAE, 0xB2, 0xB6, 0xBF,
+    0xC3, 0xC7, 0xCB, 0x00, 0x00, 0x1B, 0x1B, 0x1B,
+    0x1B, 0x21, 0x21, 0x21, 0x1E, 0x1E, 0x1E, 0x1E,
+    0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x22,
+    0x22, 0x22, 0x22, 0x1B, 0x1B, 0x1B, 0x1B, 0x21,
+    0x21, 0x21, 0x1E, 0x1E, 0x1E, 0x7F, 0x1E, 0x1E,
+    0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x22, 0x22,
+    0x22, 0x22, 0x1B, 0x1B, 0x1B, 0x1B, 0x21, 0x21,
+    0x21, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E,
+    0x1E, 0x1E, 0x1E, 0x1E, 0x22, 0x22, 0x22, 0x22,
+    0x1B, 0x1B, 0x1B, 0x1B, 0x21, 0x21, 0x21, 0x1E,
+    0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E,
+    0x1E, 0x1E, 0x22, 0x22, 0x22, 0x22, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x18, 0x18, 0x18, 0x18, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x18, 0x18,
+    0x18, 0x18, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x18, 0x18, 0x18, 0x18,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x7F, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x0C, 0x0C, 0x0C, 0x0C, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x0C,
+    0x0C, 0x0C, 0x0C, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x0C, 0x0C, 0x0C,
+    0x0C, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x0C, 0x0C, 0x0C, 0x0C, 0x04,
+    0x02, 0x02, 0x00, 0x01, 0x00, 0x04, 0x02, 0x02,
+    0x00, 0x02, 0x00, 0x04, 0x02, 0x01, 0x00, 0x01,
+    0x00, 0x04, 0x03, 0x02, 0x00, 0x01, 0x00, 0x7F,
+    0x04, 0x08, 0x02, 0x00, 0x01, 0x00, 0x04, 0x08,
+    0x02, 0x00, 0x02, 0x00, 0x04, 0x08, 0x01, 0x00,
+    0x01, 0x00, 0x04, 0x09, 0x02, 0x00, 0x01, 0x00,
+    0x04, 0x06, 0x02, 0x00, 0x01, 0x00, 0x04, 0x06,
+    0x02, 0x00, 0x02, 0x00, 0x04, 0x06, 0x01, 0x00,
+    0x01, 0x00, 0x04, 0x07, 0x02, 0x00, 0x01, 0x00,
+    0x52, 0x56, 0x5A, 0x5E, 0x62, 0x92, 0x96, 0x9A,
+    0x9E, 0xA2, 0xA6, 0xAA, 0xAE, 0xB2, 0xC3, 0xC7,
+    0x1C, 0x1C, 0x1C, 0x1F, 0x1F, 0x1E, 0x1E, 0x1E,
+    0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x20, 0x20,
+    0x1C, 0x1C, 0x1C, 0x1F, 0x1F, 0x1E, 0x1E, 0x1E,
+    0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x20, 0x20,
+    0x1C, 0x1C, 0x1C, 0x1F, 0x1F, 0x1E, 0x1E, 0x1E,
+    0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x20, 0x20,
+    0x1C, 0x1C, 0x1C, 0x1F, 0x1F, 0x1E, 0x1E, 0x1E,
+    0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x20, 0x20,
+    0x7F, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14,
+    0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x0C,
+    0x0C, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14,
+    0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x0C,
+    0x0C, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14,
+    0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x0C,
+    0x0C, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14,
+    0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x0C,
+    0x0C, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x0C,
+    0x0C, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x0C,
+    0x0C, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x0C,
+    0x0C, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x0C,
+    0x0C, 0x2F, 0x07, 0x02, 0x02, 0x00, 0x02, 0x00,
+    0x07, 0x03, 0x02, 0x00, 0x02, 0x00, 0x07, 0x08,
+    0x02, 0x00, 0x02, 0x00, 0x07, 0x09, 0x02, 0x00,
+    0x02, 0x00, 0x07, 0x06, 0x02, 0x00, 0x02, 0x00,
+    0x07, 0x07, 0x02, 0x00, 0x02, 0x00, 0x08, 0x08,
+    0x08, 0x08, 0x08, 0x08, 0x5A, 0x9A, 0x9E, 0xA2,
+    0xA6, 0xAA, 0x80, 0x23, 0x2F, 0x07, 0x02, 0x02,
+    0x00, 0x02, 0x00, 0x07, 0x03, 0x02, 0x00, 0x02,
+    0x00, 0x07, 0x08, 0x02, 0x00, 0x02, 0x00, 0x07,
+    0x09, 0x02, 0x00, 0x02, 0x00, 0x07, 0x06, 0x02,
+    0x00, 0x02, 0x00, 0x07, 0x07, 0x02, 0x00, 0x02,
+    0x00, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x5A,
+    0x9A, 0x9E, 0xA2, 0xA6, 0xAA, 0x80, 0x23, 0x29,
+    0x06, 0x02, 0x02, 0x00, 0x02, 0x00, 0x06, 0x03,
+    0x02, 0x00, 0x02, 0x00, 0x06, 0x08, 0x02, 0x00,
+    0x02, 0x00, 0x06, 0x09, 0x02, 0x00, 0x02, 0x00,
+    0x06, 0x06, 0x02, 0x00, 0x02, 0x00, 0x06, 0x07,
+    0x02, 0x00, 0x02, 0x00, 0x5A, 0x9A, 0x9E, 0xA2,
+    0xA6, 0xAA, 0x82, 0xF5, 0x02, 0x0D, 0x00, 0x2C,
+    0x80, 0x04, 0x2B, 0x3C, 0x3C, 0x3C, 0x00, 0x3C,
+    0x3C, 0x3C, 0x00, 0x16, 0x16, 0x16, 0x00, 0x16,
+    0x16, 0x16, 0x00, 0x3C, 0x3C, 0x3C, 0x00, 0x3C,
+    0x3C, 0x3C, 0x00, 0x3C, 0x3C, 0x3C, 0x00, 0x3C,
+    0x3C, 0x3C, 0x00, 0x3C, 0x3C, 0x3C, 0x00, 0x3C,
+    0x3C, 0x3C, 0x00, 0x0E, 0x00, 0x04, 0x01, 0x80,
+    0x03, 0x25, 0xFF, 0xB0, 0x0C, 0x14, 0x02, 0x02,
+    0x64, 0x00, 0x70, 0x89, 0x00, 0x00, 0x01, 0x00,
+    0x02, 0x00, 0x89, 0x89, 0xA1, 0xA1, 0x7B, 0x7B,
+    0x00, 0x00, 0xAA, 0xAA, 0x00, 0x00, 0x89, 0x89,
+    0xA0, 0xA0, 0x7B, 0x7B, 0x00, 0x00, 0xAB, 0xAB,
+    0x80, 0x19, 0x7F, 0xFF, 0xBA, 0x0C, 0x14, 0x04,
+    0x02, 0x64, 0x00, 0x4C, 0x58, 0x5C, 0x68, 0x01,
+    0x00, 0x02, 0x00, 0x99, 0x99, 0x9F, 0x9C, 0x7B,
+    0x7B, 0x00, 0x00, 0xBC, 0xBF, 0x00, 0x00, 0x98,
+    0x99, 0x9F, 0x9D, 0x7B, 0x7B, 0x00, 0x00, 0xBB,
+    0xBE, 0x00, 0x00, 0x98, 0x99, 0x9E, 0x9D, 0x7B,
+    0x7B, 0x00, 0x00, 0xBC, 0xBE, 0x00, 0x00, 0x98,
+    0x99, 0x9E, 0x9D, 0x7B, 0x7B, 0x00, 0x00, 0xBC,
+    0xBE, 0x00, 0x00, 0xFF, 0xBA, 0x0C, 0x14, 0x04,
+    0x02, 0x64, 0x00, 0x8C, 0x94, 0x9C, 0xA4, 0x01,
+    0x00, 0x02, 0x00, 0x99, 0x99, 0x9F, 0x9D, 0x7B,
+    0x7B, 0x00, 0x00, 0xBC, 0xBE, 0x00, 0x00, 0x99,
+    0x99, 0x9E, 0x9D, 0x7B, 0x7B, 0x00, 0x00, 0xBD,
+    0xBE, 0x00, 0x00, 0x99, 0x99, 0x9D, 0x9D, 0x7B,
+    0x7B, 0x00, 0x00, 0xBE, 0xBE, 0x00, 0x00, 0x99,
+    0x99, 0x9D, 0x9E, 0x7B, 0x7B, 0x00, 0x00, 0xBE,
+    0xBD, 0x00, 0x00, 0x43, 0xFF, 0xBA, 0x0C, 0x14,
+    0x04, 0x02, 0x64, 0x00, 0xAC, 0xB4, 0xC3, 0xCD,
+    0x01, 0x00, 0x02, 0x00, 0x9A, 0x98, 0x9E, 0x9C,
+    0x7B, 0x7B, 0x00, 0x00, 0xBE, 0xBE, 0x00, 0x00,
+    0x9A, 0x98, 0x9F, 0x9D, 0x7B, 0x7B, 0x00, 0x00,
+    0xBD, 0xBD, 0x00, 0x00, 0x9A, 0x98, 0x9F, 0x9F,
+    0x7B, 0x7B, 0x00, 0x00, 0xBD, 0xBB, 0x00, 0x00,
+    0x98, 0x96, 0x9E, 0x9D, 0x7B, 0x7B, 0x00, 0x00,
+    0xBC, 0xBB, 0x00, 0x00, 0x0F, 0x00, 0xF8, 0x03,
+    0x83, 0xF7, 0x03, 0x10, 0x00, 0x04, 0x08, 0x80,
+    0x03, 0x08, 0x98, 0x05, 0x34, 0x00, 0xFF, 0xFF,
+    0xFF, 0xFF, 0x04, 0x80, 0x02, 0x0C, 0x09, 0x84,
+    0x05, 0x20, 0x3C, 0x01, 0x30, 0x00, 0xFF, 0xFF,
+    0xFF, 0xFF, 0x01, 0x80, 0x05, 0x09, 0xD4, 0x40,
+    0x01, 0x30, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0x06,
+    0x80, 0x02, 0x10, 0x9E, 0xE7, 0x3D, 0x80, 0xDC,
+    0xF7, 0x3D, 0x80, 0x44, 0x01, 0x30, 0x00, 0xFF,
+    0xFF, 0xFF, 0xFF, 0x02, 0x80, 0x02, 0x06, 0x33,
+    0x1A, 0x27, 0x02, 0xA0, 0x26, 0x30, 0x80, 0x04,
+    0x00, 0x02, 0x80, 0x02, 0x00, 0xF2, 0x80, 0x02,
+    0x02, 0x40, 0x63, 0x34, 0x80, 0x04, 0x00, 0x01,
+    0x80, 0x02, 0x06, 0x04, 0x15, 0x02, 0x0A, 0x40,
+    0x63, 0x3C, 0x80, 0x04, 0x00, 0x01, 0x80, 0x02,
+    0x03, 0x04, 0x15, 0x02, 0x0A, 0x81, 0x93, 0x3E,
+    0x01, 0x03, 0x70, 0xA2, 0xA7, 0xAC, 0x4C, 0x5C,
+    0x8C, 0xBD, 0xD1, 0xFF, 0xFF, 0x01, 0x03, 0x04,
+    0x14, 0x14, 0x14, 0x00, 0x14, 0x14, 0x14, 0x00,
+    0x14, 0x14, 0x14, 0x00, 0x14, 0x14, 0x14, 0x00,
+    0x14, 0x14, 0x14, 0x00, 0x14, 0x14, 0x14, 0x00,
+    0x14, 0x14, 0x14, 0x00, 0x14, 0x14, 0x14, 0x00,
+    0x14, 0x14, 0x14, 0x00, 0x14, 0x14, 0x14, 0x00,
+    0x14, 0x14, 0x14, 0x00, 0x14, 0x14, 0x14, 0x80,
+    0x90, 0x2E, 0x18, 0x18, 0x18, 0x00, 0x18, 0x18,
+    0x18, 0x00, 0x18, 0x18, 0x18, 0x00, 0x18, 0x18,
+    0x18, 0x00, 0x18, 0x18, 0x18, 0x00, 0x18, 0x18,
+    0x18, 0x00, 0x18, 0x18, 0x18, 0x00, 0x18, 0x18,
+    0x18, 0x00, 0x18, 0x18, 0x18, 0x00, 0x18, 0x18,
+    0x18, 0x00, 0x18, 0x18, 0x18, 0x00, 0x18, 0x18,
+    0x18, 0x81, 0x50, 0x0E, 0x12, 0x12, 0x12, 0x00,
+    0x12, 0x12, 0x12, 0x00, 0x10, 0x10, 0x10, 0x00,
+    0x10, 0x10, 0x10, 0x80, 0x04, 0x0E, 0x12, 0x12,
+    0x12, 0x00, 0x12, 0x12, 0x12, 0x00, 0x10, 0x10,
+    0x10, 0x00, 0x10, 0x10, 0x10, 0x80, 0x04, 0x0E,
+    0x12, 0x12, 0x12, 0x00, 0x12, 0x12, 0x12, 0x00,
+    0x10, 0x10, 0x10, 0x00, 0x10, 0x10, 0x10, 0x80,
+    0xD8, 0x0E, 0x18, 0x18, 0x18, 0x00, 0x18, 0x18,
+    0x18, 0x00, 0x18, 0x18, 0x18, 0x00, 0x0C, 0x0C,
+    0x0C, 0x80, 0x04, 0x0E, 0x18, 0x18, 0x18, 0x00,
+    0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00,
+    0x0C, 0x0C, 0x0C, 0x80, 0x04, 0x0E, 0x16, 0x16,
+    0x16, 0x00, 0x16, 0x16, 0x16, 0x00, 0x16, 0x16,
+    0x16, 0x00, 0x0C, 0x0C, 0x0C, 0x82, 0x60, 0x02,
+    0x11, 0x00, 0x44, 0x9C, 0x4C
+};
@@ -0,0 +1,56 @@
+/*++
+
+Copyright (c) 2021-2024 DuoWoA authors. All Rights Reserved.
+
+Module Name:
+
+	probememo.h
+
+Abstract:
+
+	This file contains the size probe memo definitions.
+
+	SOCPartition clients usually ask with a small buffer first, get
+	STATUS_BUFFER_TOO_SMALL along with the size needed and ask again. The
+	memo keeps the size the first call worked out for a little while, so
+	asking again is answered without going to sfpd. The retry with a big
+	enough buffer reads through the sfpd content cache as usual.
+
+Environment:
+
+	Kernel-mode Driver Framework
+
+--*/
+
+#pragma once
+
+#include <ntddk.h>
+#include <wdf.h>
+#include <windef.h>
+#include <filter.h>
+
+EXTERN_C_START
+
+// Number of probes remembered per device, replaced round robin
+#define PROBE_MEMO_SIZE 8
+
+// How long a probe is remembered for
+#define PROBE_MEMO_LIFETIME_MS 2000
+
+typedef struct _PROBE_MEMO_ENTRY
+{
+	ULONG IoControlCode;        // 0 when the entry is free
+	WCHAR Path[VIRTUAL_FILE_MAX_PATH]; // Zero filled past the terminator
+	LONG Generation;            // sfpd cache generation the answer was worked out under
+	ULONGLONG Expires;          // Interrupt time
+
+	DWORD Size;                 // Data size of the full answer
+	ULONG Headroom;             // Output bytes the reply needs besides the data
+	NTSTATUS TooSmallStatus;    // Request status of the STATUS_BUFFER_TOO_SMALL reply
+} PROBE_MEMO_ENTRY, * PPROBE_MEMO_ENTRY;
+
+NTSTATUS InitializeProbeMemo(WDFDEVICE device);
+BOOLEAN ServeFromProbeMemo(WDFDEVICE device, PFILTER_REQUEST_CONTEXT requestContext, PUCHAR outputBuffer, ULONG outputBufferLength, NTSTATUS* RequestStatus);
+VOID RecordProbeMemo(WDFDEVICE device, DWORD IoControlCode, PWCHAR FilePath, LONG Generation, DWORD Size, ULONG Headroom, NTSTATUS TooSmallStatus);
+
+EXTERN_C_END
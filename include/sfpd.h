@@ -16,6 +16,8 @@ Environment:
 
 --*/
 
+#pragma once
+
 #include <ntddk.h>
 #include <wdf.h>
 #include <initguid.h>
@@ -23,15 +25,23 @@ Environment:
 #include <windef.h>
 #include <wdfdriver.h>
 #include <ntstrsafe.h>
+#include "sfpdcache.h"
 
 EXTERN_C_START
 
 #define POOL_TAG_FILEPATH  '0PFS'
 #define POOL_TAG_DRIVEINFO '1PFS'
+#define POOL_TAG_READFLIGHT '5PFS'
 
 #define MAXIMUM_NUMBERS_OF_LUNS 6
 
-#define MAX_FILE_OPEN_ATTEMPTS 10
+// Registry values (device hardware key) remembering where sfpd was found last time
+#define SFPD_LOCATION_DISK_VALUE_NAME         L"SfpdDiskNumber"
+#define SFPD_LOCATION_PARTITION_VALUE_NAME    L"SfpdPartitionNumber"
+#define SFPD_LOCATION_PARTITION_ID_VALUE_NAME L"SfpdPartitionId"
+
+// How long a request waits for an in-flight discovery pass before scanning on its own
+#define SFPD_DISCOVERY_TIMEOUT_MS 5000
 
 /*
 * Rob Green, a member of the NTDEV list, provides the
@@ -128,10 +138,133 @@ typedef struct _SFPD_DISPLAY_PIXEL_ALIGNMENT_DATA
 } SFPD_DISPLAY_PIXEL_ALIGNMENT_DATA, * PSFPD_DISPLAY_PIXEL_ALIGNMENT_DATA;
 #pragma pack(pop)
 
+// Directory listings are returned as fixed size records, one per file
+#define SFPD_DIRECTORY_RECORD_SIZE              244
+#define SFPD_DIRECTORY_RECORD_NAME_LENGTH       49 // WCHARs, not NUL terminated when full
+#define SFPD_DIRECTORY_RECORD_FILE_SIZE_OFFSET  200
+
+// One directory enumeration call fills this much with entries
+#define SFPD_ENUMERATION_BUFFER_SIZE PAGE_SIZE
+
+typedef enum _SFPD_SCRATCH_KIND
+{
+	SFPDScratchPath,        // MAX_PATH WCHARs, volume and device paths
+	SFPDScratchEnumeration  // SFPD_ENUMERATION_BUFFER_SIZE, one directory query
+} SFPD_SCRATCH_KIND;
+
+// Number of sfpd files and directories kept open per device
+#define SFPD_HANDLE_CACHE_SIZE 16
+
+// Cached handles nobody used for this long get closed
+#define SFPD_HANDLE_IDLE_TIMEOUT_MS 30000
+
+typedef struct _SFPD_HANDLE_CACHE_ENTRY
+{
+	WCHAR Path[MAX_PATH]; // sfpd relative, e.g. \sensors\foo.json
+	HANDLE Handle;
+	LONG RefCount;
+	BOOLEAN Directory;
+	ULONGLONG LastUsed;
+} SFPD_HANDLE_CACHE_ENTRY, * PSFPD_HANDLE_CACHE_ENTRY;
+
+//
+// One whole item read from disk, shared by every caller that asked for the same
+// path while it was going on. The first caller reads, the others wait on Done.
+// Freed by whoever drops the last reference.
+//
+typedef struct _SFPD_READ_FLIGHT
+{
+	LIST_ENTRY Link;
+	WCHAR Path[MAX_PATH];
+	KEVENT Done;
+	LONG RefCount;
+
+	NTSTATUS Status;
+	PUCHAR Data;
+	DWORD DataSize;
+} SFPD_READ_FLIGHT, * PSFPD_READ_FLIGHT;
+
+//
+// Per-device SFPD state. Allocated on the filter device object by
+// InitializeSFPDDeviceContext so that the location of the sfpd partition
+// is only resolved once instead of on every item access.
+//
+typedef struct _SFPD_DEVICE_CONTEXT
+{
+	WDFSPINLOCK VolumePathLock;
+	BOOLEAN VolumePathValid;
+	WCHAR VolumePath[MAX_PATH];
+
+	LONG VolumePathCacheHits;
+	LONG VolumePathCacheMisses;
+
+	// Partition and volume arrivals queue a discovery pass instead of
+	// callers polling the disks with sleep-and-retry.
+	PVOID PartitionNotificationEntry;
+	PVOID VolumeNotificationEntry;
+	WDFWORKITEM DiscoveryWorkItem;
+	KEVENT DiscoveryIdleEvent;
+	LONG DiscoveryRequests;
+	BOOLEAN DiscoveryStarted;
+
+	// Open handles to the sfpd root and recently used items, so reads skip
+	// ZwCreateFile and full path parsing. Protected by HandleCacheLock.
+	WDFWAITLOCK HandleCacheLock;
+	HANDLE RootHandle;
+	SFPD_HANDLE_CACHE_ENTRY HandleCache[SFPD_HANDLE_CACHE_SIZE];
+	WDFTIMER HandleCacheTimer;
+	BOOLEAN HandleCacheTimerArmed;
+	LONG HandleCacheStale;
+
+	LONG OpensAvoided;
+	LONG OpensPerformed;
+
+	// Read-only copy of the partition taken once discovery first succeeds,
+	// see sfpdcache.c. Published once, freed at self managed IO cleanup.
+	PSFPD_WARM_CACHE volatile WarmCache;
+	BOOLEAN WarmCacheAttempted;
+	LONG WarmCacheHits;
+
+	// Recently read items, see sfpdcache.c. Protected by ContentCacheLock.
+	WDFWAITLOCK ContentCacheLock;
+	SFPD_CONTENT_CACHE ContentCache;
+	LONG ContentCacheStale;
+
+	// Change notifications on the sfpd root keep both caches coherent, see sfpdcache.c
+	PKTHREAD WatcherThread;
+	KEVENT WatcherStopEvent;
+	KEVENT WatcherReadyEvent; // Set once watching, or once the watcher gave up
+	LONG volatile WatcherActive;
+	LONG volatile CacheGeneration;
+
+	// Fixed size scratch buffers for sfpd access, see AllocateSFPDScratch
+	WDFLOOKASIDE PathLookaside;
+	WDFLOOKASIDE EnumerationLookaside;
+	LONG volatile ScratchInUse;
+	LONG volatile ScratchHighWater;
+
+	// Item reads in progress, protected by ReadFlightLock
+	WDFWAITLOCK ReadFlightLock;
+	LIST_ENTRY ReadFlights;
+	LONG ReadFlightsStarted;
+	LONG ReadFlightsCoalesced;
+} SFPD_DEVICE_CONTEXT, * PSFPD_DEVICE_CONTEXT;
+
+WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(SFPD_DEVICE_CONTEXT, GetSFPDDeviceContext)
+
+NTSTATUS InitializeSFPDDeviceContext(WDFDEVICE device);
+VOID InvalidateSFPDVolumePath(WDFDEVICE device);
+NTSTATUS StartSFPDDiscovery(WDFDEVICE device);
+VOID StopSFPDDiscovery(WDFDEVICE device);
+VOID FlushSFPDHandleCache(WDFDEVICE device);
+PVOID AllocateSFPDScratch(WDFDEVICE device, SFPD_SCRATCH_KIND Kind, WDFMEMORY* Memory);
+VOID FreeSFPDScratch(WDFDEVICE device, WDFMEMORY Memory);
 NTSTATUS GetSFPDPixelAlignmentData(WDFDEVICE device, PSFPD_DISPLAY_PIXEL_ALIGNMENT_DATA PixelAlignmentData);
 NTSTATUS GetSFPDVolumePath(WDFDEVICE device, WCHAR* VolumePath, DWORD VolumePathLength);
 NTSTATUS GetSFPDItemSize(WDFDEVICE device, WCHAR* ItemPath, DWORD* ItemSize);
 NTSTATUS GetSFPDItem(WDFDEVICE device, WCHAR* ItemPath, PVOID Data, DWORD DataSize);
+NTSTATUS GetSFPDItemWithSize(WDFDEVICE device, WCHAR* ItemPath, PVOID Data, DWORD DataSize, DWORD* ItemSize);
+NTSTATUS GetSFPDDirectoryListing(WDFDEVICE device, WCHAR* DirectoryPath, PVOID Data, DWORD DataSize, DWORD* ListingSize);
 NTSTATUS GetSFPDNumberOfFilesInDirectory(WDFDEVICE device, WCHAR* DirectoryPath, DWORD* NumberOfFiles);
 NTSTATUS GetSFPDFilesInDirectory(WDFDEVICE device, WCHAR* DirectoryPath, DWORD NumberOfFiles, PUCHAR Buffer);
 
@@ -0,0 +1,95 @@
+/*++
+
+Copyright (c) 2021-2024 DuoWoA authors. All Rights Reserved.
+
+Module Name:
+
+	sfpdcache.h
+
+Abstract:
+
+	This file contains the SFPD content cache definitions.
+
+Environment:
+
+	Kernel-mode Driver Framework
+
+--*/
+
+#pragma once
+
+#include <ntddk.h>
+#include <wdf.h>
+#include <windef.h>
+#include "sfpdlru.h"
+
+EXTERN_C_START
+
+#define POOL_TAG_WARMCACHE    '2PFS'
+#define POOL_TAG_CONTENTCACHE '3PFS'
+#define POOL_TAG_WATCHER      '4PFS'
+
+// Room for the change records of one notification, overflowing it invalidates everything
+#define SFPD_WATCHER_BUFFER_SIZE 0x1000
+
+// Registry value (device hardware key) capping the warm cache, in bytes. 0 or missing disables it.
+#define SFPD_WARM_CACHE_BUDGET_VALUE_NAME L"SfpdWarmCacheBudget"
+
+//
+// The warm cache is a single read-only allocation laid out as
+//
+//   SFPD_WARM_CACHE header
+//   SFPD_WARM_CACHE_ENTRY index[EntryCount]
+//   NUL terminated item paths
+//   item data
+//
+// with every offset relative to the start of the header. Apart from the
+// Stale flags set by the change watcher it is never modified once
+// published, so lookups need no locking.
+//
+typedef struct _SFPD_WARM_CACHE_ENTRY
+{
+	ULONG PathOffset;
+	ULONG DataOffset;
+	ULONG DataSize;
+	LONG Stale; // The item changed on disk since the arena was built
+} SFPD_WARM_CACHE_ENTRY, * PSFPD_WARM_CACHE_ENTRY;
+
+typedef struct _SFPD_WARM_CACHE
+{
+	ULONG ArenaSize;
+	ULONG EntryCount;
+	SFPD_WARM_CACHE_ENTRY Entries[1];
+} SFPD_WARM_CACHE, * PSFPD_WARM_CACHE;
+
+//
+// Demand filled cache of whole items, in front of the disk and behind the warm
+// cache. Entries are evicted least recently used first once BytesUsed would
+// exceed Budget. The cache itself, in sfpdlru.h, has no locking, the device
+// context wraps it in ContentCacheLock.
+//
+// Items are only cached while the change watcher is running on the sfpd root.
+// Every change it sees bumps CacheGeneration and drops the affected entries,
+// fills read from disk under an older generation are thrown away.
+//
+
+// Registry value (device hardware key) capping the content cache, in bytes. 0 disables it.
+#define SFPD_CONTENT_CACHE_BUDGET_VALUE_NAME L"SfpdContentCacheBudget"
+
+// Used when the registry value is missing
+#define SFPD_CONTENT_CACHE_DEFAULT_BUDGET 0x10000
+
+NTSTATUS InitializeSFPDContentCache(WDFDEVICE device);
+VOID FlushSFPDContentCache(WDFDEVICE device);
+LONG GetSFPDCacheGeneration(WDFDEVICE device);
+VOID InsertSFPDContentCache(WDFDEVICE device, WCHAR* ItemPath, PVOID Data, DWORD DataSize, LONG Generation);
+BOOLEAN ReadSFPDCache(WDFDEVICE device, WCHAR* ItemPath, PVOID Data, DWORD DataSize, DWORD* ItemSize);
+
+NTSTATUS StartSFPDWatcher(WDFDEVICE device);
+VOID StopSFPDWatcher(WDFDEVICE device);
+
+NTSTATUS WarmSFPDCache(WDFDEVICE device);
+VOID FreeSFPDWarmCache(WDFDEVICE device);
+BOOLEAN LookupSFPDWarmCache(WDFDEVICE device, WCHAR* ItemPath, PVOID* Data, DWORD* DataSize);
+
+EXTERN_C_END
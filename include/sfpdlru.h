@@ -0,0 +1,293 @@
+/*++
+
+Copyright (c) 2021-2024 DuoWoA authors. All Rights Reserved.
+
+Module Name:
+
+	sfpdlru.h
+
+Abstract:
+
+	This file contains the core of the SFPD content cache: the path
+	comparisons, and finding, inserting, evicting and invalidating entries
+	of the LRU list.
+
+	Only uses the NT base types, LIST_ENTRY and its helpers, and the
+	allocator the cache is set up with, so the driver and
+	tools\sfpdcachetest.c run the same code. Nothing in here locks, the
+	callers serialize every call on one cache. Includers declare those
+	first, sfpdcache.h through ntddk.h.
+
+Environment:
+
+	Kernel-mode Driver Framework
+
+--*/
+
+#pragma once
+
+typedef PVOID SFPD_CONTENT_CACHE_ALLOCATE(SIZE_T Size);
+typedef VOID SFPD_CONTENT_CACHE_FREE(PVOID Block);
+
+typedef struct _SFPD_CONTENT_CACHE_ENTRY
+{
+	LIST_ENTRY Link;
+	WCHAR Path[MAX_PATH];
+	DWORD DataSize;
+	UCHAR Data[1];
+} SFPD_CONTENT_CACHE_ENTRY, * PSFPD_CONTENT_CACHE_ENTRY;
+
+typedef struct _SFPD_CONTENT_CACHE
+{
+	LIST_ENTRY LruList; // Most recently used first
+	ULONG Budget;
+	ULONG BytesUsed;
+
+	SFPD_CONTENT_CACHE_ALLOCATE* Allocate;
+	SFPD_CONTENT_CACHE_FREE* Free;
+
+	LONG Hits;
+	LONG Misses;
+	LONG Evictions;
+} SFPD_CONTENT_CACHE, * PSFPD_CONTENT_CACHE;
+
+// Case insensitive over ASCII, like the file system would be for the names sfpd uses.
+// Usable at any IRQL, unlike RtlEqualUnicodeString.
+FORCEINLINE BOOLEAN IsSFPDPathEqualNoCase(const WCHAR* Path1, const WCHAR* Path2)
+{
+	for (;; Path1++, Path2++)
+	{
+		WCHAR Char1 = *Path1;
+		WCHAR Char2 = *Path2;
+
+		if (Char1 >= L'a' && Char1 <= L'z')
+		{
+			Char1 -= L'a' - L'A';
+		}
+
+		if (Char2 >= L'a' && Char2 <= L'z')
+		{
+			Char2 -= L'a' - L'A';
+		}
+
+		if (Char1 != Char2)
+		{
+			return FALSE;
+		}
+
+		if (Char1 == UNICODE_NULL)
+		{
+			return TRUE;
+		}
+	}
+}
+
+// TRUE if both paths are the same or one is a directory containing the other
+FORCEINLINE BOOLEAN IsSFPDPathRelated(const WCHAR* Path1, const WCHAR* Path2)
+{
+	for (;; Path1++, Path2++)
+	{
+		WCHAR Char1 = *Path1;
+		WCHAR Char2 = *Path2;
+
+		if (Char1 >= L'a' && Char1 <= L'z')
+		{
+			Char1 -= L'a' - L'A';
+		}
+
+		if (Char2 >= L'a' && Char2 <= L'z')
+		{
+			Char2 -= L'a' - L'A';
+		}
+
+		if (Char1 != Char2)
+		{
+			return (Char1 == UNICODE_NULL && Char2 == L'\\') ||
+				(Char2 == UNICODE_NULL && Char1 == L'\\');
+		}
+
+		if (Char1 == UNICODE_NULL)
+		{
+			return TRUE;
+		}
+	}
+}
+
+// Saturates, so a size near 4 GiB can never look like it fits a budget
+FORCEINLINE ULONG GetSFPDContentCacheCost(DWORD DataSize)
+{
+	if (DataSize > MAXULONG - FIELD_OFFSET(SFPD_CONTENT_CACHE_ENTRY, Data))
+	{
+		return MAXULONG;
+	}
+
+	return FIELD_OFFSET(SFPD_CONTENT_CACHE_ENTRY, Data) + DataSize;
+}
+
+FORCEINLINE VOID InitializeSFPDContentCacheList(PSFPD_CONTENT_CACHE ContentCache, ULONG Budget, SFPD_CONTENT_CACHE_ALLOCATE* Allocate, SFPD_CONTENT_CACHE_FREE* Free)
+{
+	InitializeListHead(&ContentCache->LruList);
+	ContentCache->Budget = Budget;
+	ContentCache->BytesUsed = 0;
+	ContentCache->Allocate = Allocate;
+	ContentCache->Free = Free;
+	ContentCache->Hits = 0;
+	ContentCache->Misses = 0;
+	ContentCache->Evictions = 0;
+}
+
+//
+// Copies an item into a new entry, not linked into the cache yet. NULL when
+// the item could never fit the budget, its path is too long or the allocator
+// fails. Needs no serialization, so the copy can be made before locking.
+//
+FORCEINLINE PSFPD_CONTENT_CACHE_ENTRY CreateSFPDContentCacheEntry(PSFPD_CONTENT_CACHE ContentCache, const WCHAR* ItemPath, const VOID* Data, DWORD DataSize)
+{
+	ULONG Cost = GetSFPDContentCacheCost(DataSize);
+	PSFPD_CONTENT_CACHE_ENTRY Entry = NULL;
+	ULONG PathLength = 0;
+
+	if (ItemPath == NULL || (Data == NULL && DataSize != 0) || Cost > ContentCache->Budget)
+	{
+		return NULL;
+	}
+
+	while (ItemPath[PathLength] != UNICODE_NULL)
+	{
+		if (++PathLength == MAX_PATH)
+		{
+			return NULL;
+		}
+	}
+
+	Entry = (PSFPD_CONTENT_CACHE_ENTRY)ContentCache->Allocate(Cost);
+
+	if (Entry == NULL)
+	{
+		return NULL;
+	}
+
+	RtlCopyMemory(Entry->Path, ItemPath, (PathLength + 1) * sizeof(WCHAR));
+	Entry->DataSize = DataSize;
+
+	if (DataSize != 0)
+	{
+		RtlCopyMemory(Entry->Data, Data, DataSize);
+	}
+
+	return Entry;
+}
+
+FORCEINLINE PSFPD_CONTENT_CACHE_ENTRY FindSFPDContentCacheEntry(PSFPD_CONTENT_CACHE ContentCache, const WCHAR* ItemPath)
+{
+	for (PLIST_ENTRY Link = ContentCache->LruList.Flink; Link != &ContentCache->LruList; Link = Link->Flink)
+	{
+		PSFPD_CONTENT_CACHE_ENTRY Entry = CONTAINING_RECORD(Link, SFPD_CONTENT_CACHE_ENTRY, Link);
+
+		if (IsSFPDPathEqualNoCase(Entry->Path, ItemPath))
+		{
+			return Entry;
+		}
+	}
+
+	return NULL;
+}
+
+FORCEINLINE VOID RemoveSFPDContentCacheEntry(PSFPD_CONTENT_CACHE ContentCache, PSFPD_CONTENT_CACHE_ENTRY Entry)
+{
+	RemoveEntryList(&Entry->Link);
+	ContentCache->BytesUsed -= GetSFPDContentCacheCost(Entry->DataSize);
+
+	ContentCache->Free(Entry);
+}
+
+FORCEINLINE VOID ClearSFPDContentCache(PSFPD_CONTENT_CACHE ContentCache)
+{
+	while (!IsListEmpty(&ContentCache->LruList))
+	{
+		RemoveSFPDContentCacheEntry(ContentCache, CONTAINING_RECORD(ContentCache->LruList.Flink, SFPD_CONTENT_CACHE_ENTRY, Link));
+	}
+}
+
+//
+// Finds an item and makes it the most recently used one, counting the hit or
+// the miss. The entry stays valid until the next call on the cache.
+//
+FORCEINLINE PSFPD_CONTENT_CACHE_ENTRY LookupSFPDContentCacheEntry(PSFPD_CONTENT_CACHE ContentCache, const WCHAR* ItemPath)
+{
+	PSFPD_CONTENT_CACHE_ENTRY Entry = FindSFPDContentCacheEntry(ContentCache, ItemPath);
+
+	if (Entry == NULL)
+	{
+		ContentCache->Misses++;
+		return NULL;
+	}
+
+	RemoveEntryList(&Entry->Link);
+	InsertHeadList(&ContentCache->LruList, &Entry->Link);
+	ContentCache->Hits++;
+
+	return Entry;
+}
+
+//
+// Links a new entry in as the most recently used item. An older copy of the
+// same item goes, then the least recently used items until the entry fits
+// the budget. Generation is the cache generation taken before the item was
+// read, CurrentGeneration the one now. When they differ the item may have
+// changed while it was read: FALSE is returned and the entry is left to the
+// caller to free.
+//
+FORCEINLINE BOOLEAN InsertSFPDContentCacheEntry(PSFPD_CONTENT_CACHE ContentCache, PSFPD_CONTENT_CACHE_ENTRY Entry, LONG Generation, LONG CurrentGeneration)
+{
+	ULONG Cost = GetSFPDContentCacheCost(Entry->DataSize);
+
+	if (Generation != CurrentGeneration)
+	{
+		return FALSE;
+	}
+
+	PSFPD_CONTENT_CACHE_ENTRY ExistingEntry = FindSFPDContentCacheEntry(ContentCache, Entry->Path);
+
+	if (ExistingEntry != NULL)
+	{
+		RemoveSFPDContentCacheEntry(ContentCache, ExistingEntry);
+	}
+
+	// BytesUsed never exceeds Budget and Cost was checked against it, so this cannot wrap
+	while (Cost > ContentCache->Budget - ContentCache->BytesUsed && !IsListEmpty(&ContentCache->LruList))
+	{
+		RemoveSFPDContentCacheEntry(ContentCache, CONTAINING_RECORD(ContentCache->LruList.Blink, SFPD_CONTENT_CACHE_ENTRY, Link));
+		ContentCache->Evictions++;
+	}
+
+	InsertHeadList(&ContentCache->LruList, &Entry->Link);
+	ContentCache->BytesUsed += Cost;
+
+	return TRUE;
+}
+
+//
+// Drops the entries of ItemPath, of anything below it and of the
+// directories it is in. A NULL ItemPath drops everything. Returns how many
+// entries went.
+//
+FORCEINLINE ULONG InvalidateSFPDContentCache(PSFPD_CONTENT_CACHE ContentCache, const WCHAR* ItemPath)
+{
+	PLIST_ENTRY Link = ContentCache->LruList.Flink;
+	ULONG Dropped = 0;
+
+	while (Link != &ContentCache->LruList)
+	{
+		PSFPD_CONTENT_CACHE_ENTRY Entry = CONTAINING_RECORD(Link, SFPD_CONTENT_CACHE_ENTRY, Link);
+		Link = Link->Flink;
+
+		if (ItemPath == NULL || IsSFPDPathRelated(Entry->Path, ItemPath))
+		{
+			RemoveSFPDContentCacheEntry(ContentCache, Entry);
+			Dropped++;
+		}
+	}
+
+	return Dropped;
+}
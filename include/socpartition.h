@@ -0,0 +1,103 @@
+/*++
+
+Copyright (c) 2021-2024 DuoWoA authors. All Rights Reserved.
+
+Module Name:
+
+	socpartition.h
+
+Abstract:
+
+	This file contains the layout of SOCPartition requests and replies and
+	the helpers building replies.
+
+	Requests and replies share one header size, both buffers of a request
+	hold at least that much. Replies go into the output buffer: a few header
+	fields, then the data, then whatever is left of the buffer.
+
+Environment:
+
+	Kernel-mode Driver Framework
+
+--*/
+
+#pragma once
+
+#include <ntddk.h>
+#include <wdf.h>
+#include <windef.h>
+
+EXTERN_C_START
+
+typedef struct _SOCPARTITION_REQUEST
+{
+	UCHAR Reserved0[88];
+	WCHAR Path[48];            // e.g. QCOM\BT.PROVISION, not always terminated
+	UCHAR Reserved1[96];
+	DWORD FileProperty;        // GetFileProperty, SOCPARTITION_FILE_PROPERTY_SIZE for the file size
+	DWORD FileSystemProperty;  // ListDirectoryFiles, SOCPARTITION_FILE_SYSTEM_PROPERTY_LISTING for the files
+	UCHAR Reserved2[8];
+} SOCPARTITION_REQUEST, * PSOCPARTITION_REQUEST;
+
+C_ASSERT(FIELD_OFFSET(SOCPARTITION_REQUEST, Path) == 88);
+C_ASSERT(FIELD_OFFSET(SOCPARTITION_REQUEST, FileProperty) == 280);
+C_ASSERT(FIELD_OFFSET(SOCPARTITION_REQUEST, FileSystemProperty) == 284);
+C_ASSERT(sizeof(SOCPARTITION_REQUEST) == 296);
+
+// Smallest input and output buffer a request comes with
+#define SOCPARTITION_HEADER_SIZE ((ULONG)sizeof(SOCPARTITION_REQUEST))
+
+// The only FileProperty and FileSystemProperty the filter answers
+#define SOCPARTITION_FILE_PROPERTY_SIZE 2
+#define SOCPARTITION_FILE_SYSTEM_PROPERTY_LISTING 10
+
+typedef struct _SOCPARTITION_REPLY
+{
+	DWORD IoControlCode;       // Same as the request's
+	NTSTATUS Status;
+	ULONG NeededSize;          // Data size wanted when Status is STATUS_BUFFER_TOO_SMALL
+	ULONG Reserved;
+	ULONG DataSize;
+	UCHAR Data[ANYSIZE_ARRAY];
+} SOCPARTITION_REPLY, * PSOCPARTITION_REPLY;
+
+// SOCPartition callers read these at fixed offsets
+C_ASSERT(FIELD_OFFSET(SOCPARTITION_REPLY, IoControlCode) == 0);
+C_ASSERT(FIELD_OFFSET(SOCPARTITION_REPLY, Status) == 4);
+C_ASSERT(FIELD_OFFSET(SOCPARTITION_REPLY, NeededSize) == 8);
+C_ASSERT(FIELD_OFFSET(SOCPARTITION_REPLY, Reserved) == 12);
+C_ASSERT(FIELD_OFFSET(SOCPARTITION_REPLY, DataSize) == 16);
+C_ASSERT(FIELD_OFFSET(SOCPARTITION_REPLY, Data) == 20);
+
+#define SOCPARTITION_REPLY_HEADER_SIZE ((ULONG)FIELD_OFFSET(SOCPARTITION_REPLY, Data))
+
+// Where the data of a reply goes, for providers to fill it in place
+FORCEINLINE PUCHAR GetSOCPartitionReplyData(PUCHAR OutputBuffer)
+{
+	return ((PSOCPARTITION_REPLY)OutputBuffer)->Data;
+}
+
+//
+// Finishes a reply whose DataSize bytes of data are already in place. Writes
+// the header fields and zeroes the rest of the buffer past the data, so
+// nothing the lower driver left behind goes back to the caller. The data
+// itself is never touched, a large reply is written once.
+//
+FORCEINLINE VOID FinishSOCPartitionReply(PUCHAR OutputBuffer, ULONG OutputBufferLength, DWORD IoControlCode, NTSTATUS ReplyStatus, ULONG NeededSize, ULONG DataSize)
+{
+	PSOCPARTITION_REPLY Reply = (PSOCPARTITION_REPLY)OutputBuffer;
+	ULONG DataEnd = SOCPARTITION_REPLY_HEADER_SIZE + DataSize;
+
+	Reply->IoControlCode = IoControlCode;
+	Reply->Status = ReplyStatus;
+	Reply->NeededSize = NeededSize;
+	Reply->Reserved = 0;
+	Reply->DataSize = DataSize;
+
+	if (DataEnd < OutputBufferLength)
+	{
+		RtlZeroMemory(OutputBuffer + DataEnd, OutputBufferLength - DataEnd);
+	}
+}
+
+EXTERN_C_END
@@ -0,0 +1,75 @@
+/*++
+
+Copyright (c) 2021-2024 DuoWoA authors. All Rights Reserved.
+
+Module Name:
+
+	vfile.h
+
+Abstract:
+
+	This file contains the virtual file definitions.
+
+	Virtual files are the paths SOCPartition gets asked for that this filter
+	answers on its behalf, either from blobs built into the driver or from
+	files on sfpd.
+
+Environment:
+
+	Kernel-mode Driver Framework
+
+--*/
+
+#pragma once
+
+#include <ntddk.h>
+#include <wdf.h>
+#include <windef.h>
+
+EXTERN_C_START
+
+// Longest path in a SOCPartition request, in WCHARs (96 bytes at +88)
+#define VIRTUAL_FILE_MAX_PATH 48
+
+typedef enum _VIRTUAL_FILE_KIND
+{
+	VirtualFileStatic,     // Blob from constants.c or packedblobs.h, handed out as is
+	VirtualFileDerived,    // Blob from constants.c, patched with data from sfpd first
+	VirtualFileSFPD,       // Passed through from a file on sfpd
+	VirtualFileStatusOnly  // Always answered with StatusOverride
+} VIRTUAL_FILE_KIND;
+
+typedef struct _VIRTUAL_FILE VIRTUAL_FILE, * PVIRTUAL_FILE;
+
+// Returns the size of the file in FileSize
+typedef NTSTATUS VIRTUAL_FILE_SIZE_PROVIDER(WDFDEVICE device, PVIRTUAL_FILE File, PWCHAR RequestPath, DWORD* FileSize);
+
+// Reads the whole file into Data, or returns STATUS_BUFFER_TOO_SMALL along with the size needed
+typedef NTSTATUS VIRTUAL_FILE_CONTENT_PROVIDER(WDFDEVICE device, PVIRTUAL_FILE File, PWCHAR RequestPath, PVOID Data, DWORD DataSize, DWORD* FileSize);
+
+// Fills in the device specific bytes of a derived file, on a private copy of its template
+typedef NTSTATUS VIRTUAL_FILE_PATCH(WDFDEVICE device, PUCHAR Data);
+
+struct _VIRTUAL_FILE
+{
+	PCWSTR Path;       // As SOCPartition sends it, e.g. QCOM\BT.PROVISION
+	BOOLEAN Prefix;    // Also matches every path starting with Path
+	VIRTUAL_FILE_KIND Kind;
+	NTSTATUS StatusOverride;
+
+	CONST VOID* Data;  // Static files, and the template of derived ones
+	DWORD DataSize;
+
+	VIRTUAL_FILE_SIZE_PROVIDER* GetSize;
+	VIRTUAL_FILE_CONTENT_PROVIDER* GetContent;
+	VIRTUAL_FILE_PATCH* Patch;  // Derived files only
+
+	USHORT PathLength; // In WCHARs
+};
+
+NTSTATUS InitializeVirtualFileDeviceContext(WDFDEVICE device);
+PVIRTUAL_FILE LookupVirtualFile(PWCHAR RequestPath);
+BOOLEAN VirtualFileNeedsIo(WDFDEVICE device, PVIRTUAL_FILE File, BOOLEAN Content);
+VOID RefreshVirtualFileSnapshots(WDFDEVICE device);
+
+EXTERN_C_END
@@ -0,0 +1,81 @@
+/*++
+
+Copyright (c) 2021-2024 DuoWoA authors. All Rights Reserved.
+
+Module Name:
+
+	vfilelookup.h
+
+Abstract:
+
+	This file contains the lookup of request paths in the virtual file table.
+
+	Only uses vfiletable.h, the NT base types and RtlCompareMemory, so the
+	driver and tools\vfilebench.c run the same code. Includers include
+	vfiletable.h first, vfile.c right after declaring the providers.
+
+Environment:
+
+	Kernel-mode Driver Framework
+
+--*/
+
+#pragma once
+
+//
+// FNV-1a over the WCHARs at VirtualFileHashPositions. vfilegen.py picked the
+// positions and seed so that no two exact entries share a bucket, and only
+// positions up to the terminator of the shortest entry, so a request for an
+// entry always hashes like the entry whatever follows its terminator.
+//
+FORCEINLINE ULONG HashVirtualFilePath(PCWSTR Path)
+{
+	ULONG Hash = VIRTUAL_FILE_HASH_SEED;
+
+	for (ULONG i = 0; i < ARRAYSIZE(VirtualFileHashPositions); i++)
+	{
+		Hash ^= Path[VirtualFileHashPositions[i]];
+		Hash *= 16777619;
+	}
+
+	return Hash & (VIRTUAL_FILE_BUCKET_COUNT - 1);
+}
+
+//
+// Finds the virtual file for a request path, NULL if SOCPartition's own answer
+// should stand. Exact entries match the whole path, case sensitive, like the
+// RtlCompareMemory chains this replaces. RequestPath is the whole 48 WCHAR
+// field of the request.
+//
+FORCEINLINE PVIRTUAL_FILE FindVirtualFile(PCWSTR RequestPath)
+{
+	C_ASSERT(ARRAYSIZE(VirtualFiles) < MAXUCHAR);
+
+	UCHAR Index = VirtualFileBuckets[HashVirtualFilePath(RequestPath)];
+
+	if (Index != 0)
+	{
+		PVIRTUAL_FILE File = &VirtualFiles[Index - 1];
+
+		// Compare the terminator too, that rules out longer paths sharing the entry as prefix
+		SIZE_T CompareSize = (File->PathLength + 1) * sizeof(WCHAR);
+
+		if (RtlCompareMemory(File->Path, RequestPath, CompareSize) == CompareSize)
+		{
+			return File;
+		}
+	}
+
+	for (ULONG i = 0; i < VIRTUAL_FILE_PREFIX_COUNT; i++)
+	{
+		PVIRTUAL_FILE File = &VirtualFiles[VirtualFilePrefixes[i]];
+		SIZE_T CompareSize = File->PathLength * sizeof(WCHAR);
+
+		if (RtlCompareMemory(File->Path, RequestPath, CompareSize) == CompareSize)
+		{
+			return File;
+		}
+	}
+
+	return NULL;
+}
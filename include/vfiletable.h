@@ -0,0 +1,52 @@
+/*++
+
+Copyright (c) 2021-2024 DuoWoA authors. All Rights Reserved.
+
+Module Name:
+
+	vfiletable.h
+
+Abstract:
+
+	This file contains the virtual file table and its lookup hash.
+
+	Generated by tools\vfilegen.py from src\vfile.manifest, edit the manifest
+	instead. vfile.c includes it after declaring the providers, and
+	tools\vfilebench.c to check and time the lookup in vfilelookup.h.
+
+Environment:
+
+	Kernel-mode Driver Framework
+
+--*/
+
+#pragma once
+
+#define VIRTUAL_FILE_COUNT 8
+#define VIRTUAL_FILE_HASH_SEED 0x811C9DC5
+#define VIRTUAL_FILE_BUCKET_COUNT 8
+
+// WCHAR positions of the request path that go into the hash
+static const UCHAR VirtualFileHashPositions[] = { 7, 15 };
+
+static VIRTUAL_FILE VirtualFiles[VIRTUAL_FILE_COUNT] =
+{
+	{ L"QCOM\\BT_NVMTAG36.PROVISION", FALSE, VirtualFileStatic, STATUS_SUCCESS, BT_NVMTAG36_PROVISION, sizeof(BT_NVMTAG36_PROVISION), GetVirtualFileBlobSize, ReadVirtualFileBlob, NULL, 26 },
+	{ L"QCOM\\BT_NVMTAG83.PROVISION", FALSE, VirtualFileStatic, STATUS_SUCCESS, BT_NVMTAG83_PROVISION, sizeof(BT_NVMTAG83_PROVISION), GetVirtualFileBlobSize, ReadVirtualFileBlob, NULL, 26 },
+	{ L"QCOM\\BT.PROVISION", FALSE, VirtualFileDerived, STATUS_SUCCESS, BT_PROVISION, sizeof(BT_PROVISION), GetVirtualFileBlobSize, ReadVirtualFileSnapshot, PatchBTProvision, 17 },
+	{ L"JSON\\", TRUE, VirtualFileSFPD, STATUS_SUCCESS, NULL, 0, GetSensorFileSize, ReadSensorFile, NULL, 5 },
+	{ L"QCOM\\WLAN_PMICXO.PROVISION", FALSE, VirtualFileStatusOnly, STATUS_FILE_NOT_AVAILABLE, NULL, 0, NULL, NULL, NULL, 26 },
+	{ L"QCOM\\WLAN.PROVISION", FALSE, VirtualFileDerived, STATUS_SUCCESS, WLAN_PROVISION, sizeof(WLAN_PROVISION), GetVirtualFileBlobSize, ReadVirtualFileSnapshot, PatchWLANProvision, 19 },
+	{ L"QCOM\\WLAN_CLPC.PROVISION", FALSE, VirtualFileStatic, STATUS_SUCCESS, WLAN_CLPC_PROVISION_PACKED, sizeof(WLAN_CLPC_PROVISION_PACKED), GetPackedVirtualFileBlobSize, ReadPackedVirtualFileBlob, NULL, 24 },
+	{ L"QCOM\\WLAN_SAR2CFG.PROVISION", FALSE, VirtualFileStatic, STATUS_SUCCESS, WLAN_SAR2CFG_PROVISION, sizeof(WLAN_SAR2CFG_PROVISION), GetVirtualFileBlobSize, ReadVirtualFileBlob, NULL, 27 },
+};
+
+// Index + 1 into VirtualFiles of the only exact entry hashing there, 0 when none does
+static const UCHAR VirtualFileBuckets[VIRTUAL_FILE_BUCKET_COUNT] =
+{
+	1, 5, 3, 0, 7, 6, 8, 2,
+};
+
+// Indexes into VirtualFiles of the prefix entries, checked when no exact entry matches
+static const UCHAR VirtualFilePrefixes[] = { 3 };
+#define VIRTUAL_FILE_PREFIX_COUNT 1
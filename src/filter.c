@@ -14,17 +14,27 @@
 #include <filter.tmh>
 #include <qcomdefs.h>
 #include <sfpd.h>
-
-#include <constants.h>
+#include <vfile.h>
+#include <probememo.h>
+#include <socpartition.h>
+#include <sfpdcache.h>
 
 #ifdef ALLOC_PRAGMA
 #pragma alloc_text (INIT, DriverEntry)
 #pragma alloc_text (PAGE, OnDeviceAdd)
+#pragma alloc_text (PAGE, OnDeviceSurpriseRemoval)
+#pragma alloc_text (PAGE, OnDeviceSelfManagedIoInit)
+#pragma alloc_text (PAGE, OnDeviceSelfManagedIoCleanup)
 #pragma alloc_text (PAGE, OnInternalDeviceControl)
 #pragma alloc_text (PAGE, OnContextCleanup)
-#pragma alloc_text (PAGE, OnRequestCompletionRoutine)
 #endif
 
+static NTSTATUS InitializeFilterDeviceContext(WDFDEVICE device);
+static NTSTATUS CreateFilterCostQueues(WDFDEVICE device);
+static BOOLEAN ServeVirtualFileRequest(WDFDEVICE device, PFILTER_REQUEST_CONTEXT requestContext, PUCHAR outputBuffer, ULONG outputBufferLength, NTSTATUS* RequestStatus);
+static VOID InsertNegativeCache(WDFDEVICE device, PFILTER_REQUEST_CONTEXT requestContext);
+static WDFREQUEST DequeuePipelineRequest(PFILTER_DEVICE_CONTEXT filterContext);
+
 NTSTATUS
 DriverEntry(
 	IN PDRIVER_OBJECT  DriverObject,
@@ -120,6 +130,9 @@ Return Value:
 {
 	WDFDEVICE device;
 	WDF_IO_QUEUE_CONFIG queueConfig;
+	WDF_PNPPOWER_EVENT_CALLBACKS pnpPowerCallbacks;
+	WDF_OBJECT_ATTRIBUTES requestAttributes;
+	WDF_OBJECT_ATTRIBUTES deviceAttributes;
 	NTSTATUS status;
 
 	UNREFERENCED_PARAMETER(Driver);
@@ -133,9 +146,25 @@ Return Value:
 	//
 	WdfFdoInitSetFilter(DeviceInit);
 
+	WDF_PNPPOWER_EVENT_CALLBACKS_INIT(&pnpPowerCallbacks);
+	pnpPowerCallbacks.EvtDeviceSurpriseRemoval = OnDeviceSurpriseRemoval;
+	pnpPowerCallbacks.EvtDeviceSelfManagedIoInit = OnDeviceSelfManagedIoInit;
+	pnpPowerCallbacks.EvtDeviceSelfManagedIoCleanup = OnDeviceSelfManagedIoCleanup;
+
+	WdfDeviceInitSetPnpPowerEventCallbacks(DeviceInit, &pnpPowerCallbacks);
+
+	//
+	// Every request we see carries room for what the completion routine needs
+	//
+	WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&requestAttributes, FILTER_REQUEST_CONTEXT);
+
+	WdfDeviceInitSetRequestAttributes(DeviceInit, &requestAttributes);
+
+	WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&deviceAttributes, FILTER_DEVICE_CONTEXT);
+
 	status = WdfDeviceCreate(
 		&DeviceInit,
-		WDF_NO_OBJECT_ATTRIBUTES,
+		&deviceAttributes,
 		&device);
 
 	if (!NT_SUCCESS(status))
@@ -150,1143 +179,1312 @@ Return Value:
 	}
 
 	//
-	// Create a parallel dispatch queue to handle requests from HID Class
+	// Serving mode and the list of requests SOCPartition is known to fail
 	//
-	WDF_IO_QUEUE_CONFIG_INIT_DEFAULT_QUEUE(
-		&queueConfig,
-		WdfIoQueueDispatchSequential);
-
-	queueConfig.EvtIoDeviceControl = OnIoDeviceControl;
-
-	status = WdfIoQueueCreate(
-		device,
-		&queueConfig,
-		WDF_NO_OBJECT_ATTRIBUTES,
-		WDF_NO_HANDLE); // pointer to default queue
+	status = InitializeFilterDeviceContext(device);
 
 	if (!NT_SUCCESS(status))
 	{
 		Trace(
 			TRACE_LEVEL_ERROR,
 			TRACE_INIT,
-			"Error creating WDF default queue - 0x%08lX",
+			"InitializeFilterDeviceContext failed - 0x%08lX",
 			status);
 
 		goto exit;
 	}
 
-exit:
-
-	return status;
-}
-
-VOID OnIoDeviceControl(
-	IN WDFQUEUE      Queue,
-	IN WDFREQUEST    Request,
-	IN size_t        OutputBufferLength,
-	IN size_t        InputBufferLength,
-	IN ULONG         IoControlCode
-)
-{
-	NTSTATUS status;
-	WDFDEVICE device;
-	BOOLEAN forwardWithCompletionRoutine = FALSE;
-	BOOLEAN requestSent = TRUE;
-	WDF_REQUEST_SEND_OPTIONS options;
-	WDFMEMORY inputMemory = NULL;
-	WDFMEMORY outputMemory = NULL;
-	WDFIOTARGET Target;
-
-	PAGED_CODE();
-
-	device = WdfIoQueueGetDevice(Queue);
-	Target = WdfDeviceGetIoTarget(device);
-
-	Trace(
-		TRACE_LEVEL_ERROR,
-		TRACE_INIT,
-		"OnIoDeviceControl: OutputBufferLength: %d, InputBufferLength: %d, IoControlCode: %d\n",
-		(int)OutputBufferLength, (int)InputBufferLength, IoControlCode);
-
 	//
-	// Please note that QCSOCPartition provides the buffer in the Irp->UserBuffer
-	// field irrespective of the ioctl buffer type. However, framework is very
-	// strict about type checking. You cannot get Irp->UserBuffer by using
-	// WdfRequestRetrieveOutputMemory if the ioctl is not a METHOD_NEITHER
-	// internal ioctl. So depending on the ioctl code, we will either
-	// use retreive function or escape to WDM to get the UserBuffer.
+	// Cache for the sfpd partition location and other per-device SFPD state
 	//
+	status = InitializeSFPDDeviceContext(device);
 
-	//switch (IoControlCode) {
-	//case 0:
-		//
-		// Obtains the report descriptor for the HID device
-		//
-	forwardWithCompletionRoutine = TRUE;
-	Trace(
-		TRACE_LEVEL_ERROR,
-		TRACE_INIT,
-		"OnIoDeviceControl: forwardWithCompletionRoutine = TRUE!\n");
-	//    break;
-	//
-	//default:
-	//    break;
-	//}
+	if (!NT_SUCCESS(status))
+	{
+		Trace(
+			TRACE_LEVEL_ERROR,
+			TRACE_INIT,
+			"InitializeSFPDDeviceContext failed - 0x%08lX",
+			status);
+
+		goto exit;
+	}
 
 	//
-	// Forward the request down. WdfDeviceGetIoTarget returns
-	// the default target, which represents the device attached to us below in
-	// the stack.
+	// Answers for the paths we own, per device
 	//
-	if (forwardWithCompletionRoutine) {
-		if (InputBufferLength > 0)
-		{
-			//
-			// Format the request with the input memory so the completion routine
-			// can access the input data in order to cache it into the context area
-			//
-			status = WdfRequestRetrieveInputMemory(Request, &inputMemory);
-
-			if (!NT_SUCCESS(status)) {
-				Trace(
-					TRACE_LEVEL_ERROR,
-					TRACE_INIT,
-					"WdfRequestRetrieveInputMemory failed: 0x%x\n",
-					status);
+	status = InitializeVirtualFileDeviceContext(device);
 
-				WdfRequestComplete(Request, status);
-				return;
-			}
-		}
+	if (!NT_SUCCESS(status))
+	{
+		Trace(
+			TRACE_LEVEL_ERROR,
+			TRACE_INIT,
+			"InitializeVirtualFileDeviceContext failed - 0x%08lX",
+			status);
 
-		if (OutputBufferLength > 0)
-		{
-			//
-			// Format the request with the output memory so the completion routine
-			// can access the return data in order to cache it into the context area
-			//
-			status = WdfRequestRetrieveOutputMemory(Request, &outputMemory);
+		goto exit;
+	}
 
-			if (!NT_SUCCESS(status)) {
-				Trace(
-					TRACE_LEVEL_ERROR,
-					TRACE_INIT,
-					"WdfRequestRetrieveOutputMemory failed: 0x%x\n",
-					status);
+	//
+	// Remembers size probes for the retry that follows them
+	//
+	status = InitializeProbeMemo(device);
 
-				WdfRequestComplete(Request, status);
-				return;
-			}
-		}
+	if (!NT_SUCCESS(status))
+	{
+		Trace(
+			TRACE_LEVEL_ERROR,
+			TRACE_INIT,
+			"InitializeProbeMemo failed - 0x%08lX",
+			status);
 
-		status = WdfIoTargetFormatRequestForIoctl(
-			Target,
-			Request,
-			IoControlCode,
-			inputMemory,
-			NULL,
-			outputMemory,
-			NULL);
+		goto exit;
+	}
 
-		if (!NT_SUCCESS(status)) {
-			Trace(
-				TRACE_LEVEL_ERROR,
-				TRACE_INIT,
-				"WdfIoTargetFormatRequestForIoctl failed: 0x%x\n",
-				status);
+	//
+	// Create a parallel dispatch queue to handle requests from SOCPartition
+	// clients, so one slow sfpd read doesn't hold up every other lookup.
+	// Everything a request touches is either read only or has its own lock:
+	// the negative cache its spinlock, the sfpd caches the locks in
+	// SFPD_DEVICE_CONTEXT and derived files their per-device snapshots. The
+	// handled IOCTLs only get parsed here and move on to a cost class queue.
+	//
+	WDF_IO_QUEUE_CONFIG_INIT_DEFAULT_QUEUE(
+		&queueConfig,
+		WdfIoQueueDispatchParallel);
 
-			WdfRequestComplete(Request, status);
-			return;
-		}
+	queueConfig.EvtIoDeviceControl = OnIoDeviceControl;
 
-		//
-		// Set our completion routine with a context area that we will save
-		// the output data into
-		//
-		WdfRequestSetCompletionRoutine(
-			Request,
-			OnRequestCompletionRoutine,
-			&InputBufferLength);
+	status = WdfIoQueueCreate(
+		device,
+		&queueConfig,
+		WDF_NO_OBJECT_ATTRIBUTES,
+		WDF_NO_HANDLE); // pointer to default queue
 
-		requestSent = WdfRequestSend(
-			Request,
-			Target,
-			WDF_NO_SEND_OPTIONS);
-	}
-	else
+	if (!NT_SUCCESS(status))
 	{
-		//
-		// We are not interested in post processing the IRP so
-		// fire and forget.
-		//
-		WDF_REQUEST_SEND_OPTIONS_INIT(
-			&options,
-			WDF_REQUEST_SEND_OPTION_SEND_AND_FORGET);
+		Trace(
+			TRACE_LEVEL_ERROR,
+			TRACE_INIT,
+			"Error creating WDF default queue - 0x%08lX",
+			status);
 
-		requestSent = WdfRequestSend(Request, Target, &options);
+		goto exit;
 	}
 
-	if (requestSent == FALSE) {
-		status = WdfRequestGetStatus(Request);
+	//
+	// One parallel queue per cost class, each with its own limit on requests
+	// presented at once, so memcpy answers never wait behind sfpd reads
+	//
+	status = CreateFilterCostQueues(device);
 
+	if (!NT_SUCCESS(status))
+	{
 		Trace(
 			TRACE_LEVEL_ERROR,
 			TRACE_INIT,
-			"WdfRequestSend failed: 0x%x\n",
+			"CreateFilterCostQueues failed - 0x%08lX",
 			status);
 
-		WdfRequestComplete(Request, status);
+		goto exit;
 	}
 
-	return;
-}
-
-VOID
-OnRequestCompletionRoutine(
-	IN WDFREQUEST  Request,
-	IN WDFIOTARGET  Target,
-	IN PWDF_REQUEST_COMPLETION_PARAMS  Params,
-	IN WDFCONTEXT  Context
-)
-/*++
-
-Routine Description:
-
-	Completion Routine
-
-Arguments:
-
-	Target - Target handle
-	Request - Request handle
-	Params - request completion params
-	Context - Driver supplied context
-
-
-Return Value:
+exit:
 
-	VOID
+	return status;
+}
 
---*/
+static NTSTATUS InitializeFilterDeviceContext(WDFDEVICE device)
 {
 	NTSTATUS status = STATUS_UNSUCCESSFUL;
+	PFILTER_DEVICE_CONTEXT filterContext = GetFilterDeviceContext(device);
+	WDF_OBJECT_ATTRIBUTES attributes;
+	WDFKEY key = NULL;
+	ULONG localServing = 0;
 
-	if (Params == NULL)
-	{
-		goto exit;
-	}
+	WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+	attributes.ParentObject = device;
 
-	if (Context == NULL)
-	{
-		goto exit;
-	}
+	status = WdfSpinLockCreate(&attributes, &filterContext->NegativeCacheLock);
 
-	WDFDEVICE device = WdfIoTargetGetDevice(Target);
-	if (device == NULL)
+	if (!NT_SUCCESS(status))
 	{
 		goto exit;
 	}
 
-	// The result of the IOCTL call to the SOCPartition driver
-	status = Params->IoStatus.Status;
+	if (NT_SUCCESS(WdfDeviceOpenRegistryKey(device, PLUGPLAY_REGKEY_DEVICE, KEY_READ, WDF_NO_OBJECT_ATTRIBUTES, &key)))
+	{
+		DECLARE_CONST_UNICODE_STRING(valueName, FILTER_LOCAL_SERVING_VALUE_NAME);
 
-	// The input buffer for the IOCTL call to the SOCPartition driver
-	WDFMEMORY inputMemory = Params->Parameters.Ioctl.Input.Buffer;
+		if (!NT_SUCCESS(WdfRegistryQueryULong(key, &valueName, &localServing)))
+		{
+			localServing = 0;
+		}
 
-	// The output buffer for the IOCTL call to the SOCPartition driver
-	WDFMEMORY outputMemory = Params->Parameters.Ioctl.Output.Buffer;
+		WdfRegistryClose(key);
+	}
 
-	// The length of the input buffer sent to SOCPartition
-	ULONG inputBufferLength = *(PULONG)Context;
+	filterContext->LocalServing = localServing != 0;
 
-	// The length of the output buffer sent to SOCPartition
-	ULONG outputBufferLength = (ULONG)Params->Parameters.Ioctl.Output.Length;
+	WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+	attributes.ParentObject = device;
 
-	DWORD IoControlCode = Params->Parameters.Ioctl.IoControlCode;
+	status = WdfSpinLockCreate(&attributes, &filterContext->PipelineLock);
 
-	// Check the for the buffer lengths, which must be at least 296 respectively (header structure)
-	if (inputBufferLength < 296 || outputBufferLength < 296)
+	if (!NT_SUCCESS(status))
 	{
 		goto exit;
 	}
 
-	if (IoControlCode != 0xECAF32C2 && // ReadFile
-		IoControlCode != 0xECAF32CE && // ListDirectoryFiles
-		IoControlCode != 0xECAF32C6) // GetFileProperty
+	InitializeListHead(&filterContext->PipelineRequests);
+
+	for (ULONG i = 0; i < FILTER_PIPELINE_WORKER_COUNT; i++)
 	{
-		// We only handle above IOCTLs. If it doesn't match, return now.
-		goto exit;
-	}
+		WDF_WORKITEM_CONFIG workItemConfig;
+		WDF_WORKITEM_CONFIG_INIT(&workItemConfig, OnPipelineWorkItem);
+		workItemConfig.AutomaticSerialization = FALSE;
 
-	PUCHAR inputBuffer = NULL;
-	PUCHAR outputBuffer = NULL;
+		WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&attributes, FILTER_PIPELINE_WORKER_CONTEXT);
+		attributes.ParentObject = device;
 
-	Trace(
-		TRACE_LEVEL_ERROR,
-		TRACE_INIT,
-		"OnRequestCompletionRoutine: IoControlCode: %d - Status: %d\n",
-		IoControlCode,
-		Params->IoStatus.Status);
+		status = WdfWorkItemCreate(&workItemConfig, &attributes, &filterContext->PipelineWorkers[i]);
 
-	// Retrieve the input buffer, as an array of BYTE
-	inputBuffer = (PUCHAR)ExAllocatePoolWithTag(
-		NonPagedPoolNx,
-		inputBufferLength,
-		HID_DESCRIPTOR_POOL_TAG);
+		if (!NT_SUCCESS(status))
+		{
+			goto exit;
+		}
+	}
 
-	if (NULL == inputBuffer) {
-		Trace(
-			TRACE_LEVEL_ERROR,
-			TRACE_INIT,
-			"Could not allocate input buffer!");
+exit:
+	return status;
+}
 
-		goto exit;
+static NTSTATUS CreateFilterCostQueues(WDFDEVICE device)
+{
+	static const ULONG concurrency[FilterCostClassCount] =
+	{
+		FILTER_STATIC_QUEUE_CONCURRENCY,
+		FILTER_DERIVED_QUEUE_CONCURRENCY,
+		FILTER_FILE_BACKED_QUEUE_CONCURRENCY
+	};
+
+	PFILTER_DEVICE_CONTEXT filterContext = GetFilterDeviceContext(device);
+	NTSTATUS status = STATUS_SUCCESS;
+
+	for (ULONG i = 0; i < FilterCostClassCount; i++)
+	{
+		WDF_IO_QUEUE_CONFIG queueConfig;
+		WDF_OBJECT_ATTRIBUTES attributes;
+
+		WDF_IO_QUEUE_CONFIG_INIT(&queueConfig, WdfIoQueueDispatchParallel);
+		queueConfig.Settings.Parallel.NumberOfPresentedRequests = concurrency[i];
+		queueConfig.EvtIoDeviceControl = OnIoDeviceControl;
+
+		WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&attributes, FILTER_QUEUE_CONTEXT);
+
+		//
+		// A queue at its limit presents the next request when one completes,
+		// which can be from OnRequestCompletionRoutine at DISPATCH_LEVEL.
+		// OnIoDeviceControl is paged and may read sfpd, so keep it passive.
+		//
+		attributes.ExecutionLevel = WdfExecutionLevelPassive;
+
+		status = WdfIoQueueCreate(device, &queueConfig, &attributes, &filterContext->CostQueues[i]);
+
+		if (!NT_SUCCESS(status))
+		{
+			goto exit;
+		}
+
+		GetFilterQueueContext(filterContext->CostQueues[i])->CostClass = (FILTER_COST_CLASS)i;
 	}
 
-	NTSTATUS filterStatus = WdfMemoryCopyToBuffer(
-		inputMemory,
-		Params->Parameters.Ioctl.Input.Offset,
-		inputBuffer,
-		inputBufferLength);
+exit:
+	return status;
+}
 
-	if (!NT_SUCCESS(filterStatus)) {
-		Trace(
-			TRACE_LEVEL_ERROR,
-			TRACE_INIT,
-			"WdfMemoryCopyToBuffer failed: 0x%x\n",
-			filterStatus);
+static FILTER_COST_CLASS ClassifyFilterRequest(PFILTER_REQUEST_CONTEXT requestContext)
+{
+	if (!requestContext->Parsed)
+	{
+		// Goes straight down and back up
+		return FilterCostStatic;
+	}
 
-		ExFreePoolWithTag(inputBuffer, HID_DESCRIPTOR_POOL_TAG);
-		goto exit;
+	if (requestContext->IoControlCode == IOCTL_SOCPARTITION_LIST_DIRECTORY_FILES)
+	{
+		return FilterCostFileBacked;
 	}
 
-	// Retrieve the output buffer, as an array of BYTE
-	outputBuffer = (PUCHAR)ExAllocatePoolWithTag(
-		NonPagedPoolNx,
-		outputBufferLength,
-		HID_DESCRIPTOR_POOL_TAG);
+	if (requestContext->File == NULL)
+	{
+		return FilterCostStatic;
+	}
 
-	if (NULL == outputBuffer) {
-		Trace(
-			TRACE_LEVEL_ERROR,
-			TRACE_INIT,
-			"Could not allocate output buffer!");
+	switch (requestContext->File->Kind)
+	{
+	case VirtualFileSFPD:
+		return FilterCostFileBacked;
+	case VirtualFileDerived:
+		return FilterCostDerived;
+	default:
+		return FilterCostStatic;
+	}
+}
 
-		// Free the previously allocated input buffer
-		ExFreePoolWithTag(inputBuffer, HID_DESCRIPTOR_POOL_TAG);
-		goto exit;
+//
+// Moves a parsed request from the default queue to the queue of its cost
+// class, which presents it back to OnIoDeviceControl. Returns FALSE when
+// the request stays with the caller.
+//
+static BOOLEAN RouteFilterRequest(WDFDEVICE device, WDFREQUEST Request, PFILTER_REQUEST_CONTEXT requestContext)
+{
+	WDFQUEUE queue = GetFilterDeviceContext(device)->CostQueues[ClassifyFilterRequest(requestContext)];
+	PFILTER_QUEUE_CONTEXT queueContext = GetFilterQueueContext(queue);
+
+	requestContext->RoutedAt = KeQueryInterruptTime();
+
+	// Before forwarding, the queue may present it right away
+	LONG depth = InterlockedIncrement(&queueContext->Depth);
+
+	for (LONG peak = queueContext->PeakDepth; depth > peak; peak = queueContext->PeakDepth)
+	{
+		if (InterlockedCompareExchange(&queueContext->PeakDepth, depth, peak) == peak)
+		{
+			break;
+		}
 	}
 
-	filterStatus = WdfMemoryCopyToBuffer(
-		outputMemory,
-		Params->Parameters.Ioctl.Output.Offset,
-		outputBuffer,
-		outputBufferLength);
+	if (!NT_SUCCESS(WdfRequestForwardToIoQueue(Request, queue)))
+	{
+		InterlockedDecrement(&queueContext->Depth);
+		return FALSE;
+	}
 
-	if (!NT_SUCCESS(filterStatus)) {
-		Trace(
-			TRACE_LEVEL_ERROR,
-			TRACE_INIT,
-			"WdfMemoryCopyToBuffer failed: 0x%x\n",
-			filterStatus);
+	return TRUE;
+}
 
-		ExFreePoolWithTag(outputBuffer, HID_DESCRIPTOR_POOL_TAG);
+// Accounts for the time a request presented by a cost class queue spent waiting there
+static VOID AccountFilterRequestWait(WDFQUEUE Queue, PFILTER_REQUEST_CONTEXT requestContext)
+{
+	PFILTER_QUEUE_CONTEXT queueContext = GetFilterQueueContext(Queue);
+	LONG64 wait = (LONG64)(KeQueryInterruptTime() - requestContext->RoutedAt);
 
-		// Free the previously allocated input buffer
-		ExFreePoolWithTag(inputBuffer, HID_DESCRIPTOR_POOL_TAG);
-		goto exit;
+	InterlockedDecrement(&queueContext->Depth);
+	InterlockedIncrement(&queueContext->Presented);
+	InterlockedExchangeAdd64(&queueContext->TotalWait, wait);
+
+	for (LONG64 longest = queueContext->LongestWait; wait > longest; longest = queueContext->LongestWait)
+	{
+		if (InterlockedCompareExchange64(&queueContext->LongestWait, wait, longest) == longest)
+		{
+			break;
+		}
 	}
+}
 
-	// Check the output buffer provided IOCTL, it must match the input.
-	DWORD OutputBufferIOCTL = *(DWORD*)(outputBuffer);
+static BOOLEAN LookupNegativeCache(WDFDEVICE device, PFILTER_REQUEST_CONTEXT requestContext)
+{
+	PFILTER_DEVICE_CONTEXT filterContext = GetFilterDeviceContext(device);
+	BOOLEAN found = FALSE;
 
-	if (OutputBufferIOCTL != IoControlCode)
+	WdfSpinLockAcquire(filterContext->NegativeCacheLock);
+
+	for (ULONG i = 0; i < filterContext->NegativeCacheCount; i++)
 	{
-		ExFreePoolWithTag(outputBuffer, HID_DESCRIPTOR_POOL_TAG);
-		ExFreePoolWithTag(inputBuffer, HID_DESCRIPTOR_POOL_TAG);
-		goto exit;
+		PFILTER_NEGATIVE_CACHE_ENTRY entry = &filterContext->NegativeCache[i];
+
+		if (entry->IoControlCode == requestContext->IoControlCode &&
+			entry->PathHash == requestContext->PathHash &&
+			RtlCompareMemory(entry->Path, requestContext->Path, sizeof(entry->Path)) == sizeof(entry->Path))
+		{
+			found = TRUE;
+			break;
+		}
 	}
 
-	// Now check the output buffer provided return code.
-	// We will only deal with non successful codes in our filter
-	NTSTATUS OutputBufferStatus = *(NTSTATUS*)(outputBuffer + 4);
+	WdfSpinLockRelease(filterContext->NegativeCacheLock);
+
+	return found;
+}
 
-	if (NT_SUCCESS(OutputBufferStatus))
+static VOID InsertNegativeCache(WDFDEVICE device, PFILTER_REQUEST_CONTEXT requestContext)
+{
+	PFILTER_DEVICE_CONTEXT filterContext = GetFilterDeviceContext(device);
+
+	if (LookupNegativeCache(device, requestContext))
 	{
-		ExFreePoolWithTag(outputBuffer, HID_DESCRIPTOR_POOL_TAG);
-		ExFreePoolWithTag(inputBuffer, HID_DESCRIPTOR_POOL_TAG);
-		goto exit;
+		return;
 	}
 
-	// We know that we have a non successful valid request to SOCPartition at the moment.
-	// Handle it on our own :)
+	WdfSpinLockAcquire(filterContext->NegativeCacheLock);
 
-	switch (IoControlCode)
+	PFILTER_NEGATIVE_CACHE_ENTRY entry = &filterContext->NegativeCache[filterContext->NegativeCacheNext];
+
+	entry->IoControlCode = requestContext->IoControlCode;
+	entry->PathHash = requestContext->PathHash;
+	RtlCopyMemory(entry->Path, requestContext->Path, sizeof(entry->Path));
+
+	filterContext->NegativeCacheNext = (filterContext->NegativeCacheNext + 1) % FILTER_NEGATIVE_CACHE_SIZE;
+
+	if (filterContext->NegativeCacheCount < FILTER_NEGATIVE_CACHE_SIZE)
 	{
-	case 0xECAF32C2: // ReadFile
+		filterContext->NegativeCacheCount++;
+	}
+
+	WdfSpinLockRelease(filterContext->NegativeCacheLock);
+}
+
+static VOID FlushNegativeCache(WDFDEVICE device)
+{
+	PFILTER_DEVICE_CONTEXT filterContext = GetFilterDeviceContext(device);
+
+	WdfSpinLockAcquire(filterContext->NegativeCacheLock);
+
+	filterContext->NegativeCacheCount = 0;
+	filterContext->NegativeCacheNext = 0;
+
+	WdfSpinLockRelease(filterContext->NegativeCacheLock);
+}
+
+//
+// Copies what the filter looks at out of the request header, once, at
+// dispatch: the path, terminated and zero filled, its hash, the property
+// codes and, for ReadFile and GetFileProperty, the virtual file it names.
+// Leaves Parsed FALSE when the input does not hold a whole header.
+//
+static VOID ParseFilterRequest(WDFREQUEST Request, PFILTER_REQUEST_CONTEXT requestContext)
+{
+	PSOCPARTITION_REQUEST header = NULL;
+	ULONG pathHash = FILTER_PATH_HASH_SEED;
+	ULONG i = 0;
+
+	requestContext->Parsed = FALSE;
+
+	if (!NT_SUCCESS(WdfRequestRetrieveInputBuffer(Request, SOCPARTITION_HEADER_SIZE, (PVOID*)&header, NULL)))
 	{
-		PWCHAR FilePath = (PWCHAR)(inputBuffer + 88); // 96 size
+		return;
+	}
 
-		if (RtlCompareMemory(L"QCOM\\BT_NVMTAG36.PROVISION", FilePath, sizeof(L"QCOM\\BT_NVMTAG36.PROVISION")) == sizeof(L"QCOM\\BT_NVMTAG36.PROVISION"))
-		{
-			// Buffer too small
-			if (outputBufferLength < 296 + sizeof(BT_NVMTAG36_PROVISION))
-			{
-				status = STATUS_SUCCESS;
+	for (; i < VIRTUAL_FILE_MAX_PATH && header->Path[i] != UNICODE_NULL; i++)
+	{
+		requestContext->Path[i] = header->Path[i];
 
-				RtlZeroMemory(outputBuffer, outputBufferLength);
+		pathHash ^= header->Path[i];
+		pathHash *= FILTER_PATH_HASH_PRIME;
+	}
 
-				// IOCTL
-				*(DWORD*)(outputBuffer) = IoControlCode;
+	for (; i < VIRTUAL_FILE_MAX_PATH; i++)
+	{
+		requestContext->Path[i] = UNICODE_NULL;
+	}
 
-				// Status
-				*(NTSTATUS*)(outputBuffer + 4) = STATUS_BUFFER_TOO_SMALL;
+	requestContext->PathHash = pathHash;
+	requestContext->FileProperty = header->FileProperty;
+	requestContext->FileSystemProperty = header->FileSystemProperty;
 
-				// Needed Buffer Size
-				*(ULONG*)(outputBuffer + 8) = sizeof(BT_NVMTAG36_PROVISION);
-			}
-			else
-			{
-				status = STATUS_SUCCESS;
+	switch (requestContext->IoControlCode)
+	{
+	case IOCTL_SOCPARTITION_READ_FILE:
+	case IOCTL_SOCPARTITION_GET_FILE_PROPERTY:
+		requestContext->File = LookupVirtualFile(requestContext->Path);
+		break;
+	default:
+		requestContext->File = NULL;
+		break;
+	}
 
-				RtlZeroMemory(outputBuffer, outputBufferLength);
+	requestContext->Parsed = TRUE;
+}
 
-				// IOCTL
-				*(DWORD*)(outputBuffer) = IoControlCode;
+//
+// Completes a handled request without sending it to SOCPartition, when local
+// serving is on or SOCPartition already failed the same request before, and
+// the filter has an answer. Returns FALSE if the request still has to go down.
+//
+static BOOLEAN ServeRequestLocally(WDFDEVICE device, WDFREQUEST Request, PFILTER_REQUEST_CONTEXT requestContext)
+{
+	PFILTER_DEVICE_CONTEXT filterContext = GetFilterDeviceContext(device);
+	PUCHAR outputBuffer = NULL;
+	size_t outputBufferLength = 0;
+	NTSTATUS status = STATUS_UNSUCCESSFUL;
 
-				// Status
-				*(NTSTATUS*)(outputBuffer + 4) = STATUS_SUCCESS;
+	// Both buffers must hold at least the header, the input one was checked when parsing it
+	if (!requestContext->Parsed ||
+		!NT_SUCCESS(WdfRequestRetrieveOutputBuffer(Request, SOCPARTITION_HEADER_SIZE, (PVOID*)&outputBuffer, &outputBufferLength)))
+	{
+		return FALSE;
+	}
 
-				// Needed Buffer Size
-				*(ULONG*)(outputBuffer + 8) = 0;
+	if (!filterContext->LocalServing && !LookupNegativeCache(device, requestContext))
+	{
+		return FALSE;
+	}
 
-				// Data Size
-				*(ULONG*)(outputBuffer + 16) = sizeof(BT_NVMTAG36_PROVISION);
+	if (!ServeVirtualFileRequest(device, requestContext, outputBuffer, (ULONG)outputBufferLength, &status))
+	{
+		return FALSE;
+	}
 
-				// File Data
-				RtlCopyMemory(outputBuffer + 20, BT_NVMTAG36_PROVISION, sizeof(BT_NVMTAG36_PROVISION));
-			}
-		}
-		else if (RtlCompareMemory(L"QCOM\\BT_NVMTAG83.PROVISION", FilePath, sizeof(L"QCOM\\BT_NVMTAG83.PROVISION")) == sizeof(L"QCOM\\BT_NVMTAG83.PROVISION"))
-		{
-			// Buffer too small
-			if (outputBufferLength < 296 + sizeof(BT_NVMTAG83_PROVISION))
-			{
-				status = STATUS_SUCCESS;
+	InterlockedIncrement(&filterContext->LocallyServed);
 
-				RtlZeroMemory(outputBuffer, outputBufferLength);
+	WdfRequestCompleteWithInformation(Request, status, outputBufferLength);
 
-				// IOCTL
-				*(DWORD*)(outputBuffer) = IoControlCode;
+	return TRUE;
+}
 
-				// Status
-				*(NTSTATUS*)(outputBuffer + 4) = STATUS_BUFFER_TOO_SMALL;
+VOID
+OnDeviceSurpriseRemoval(
+	IN WDFDEVICE Device
+)
+/*++
 
-				// Needed Buffer Size
-				*(ULONG*)(outputBuffer + 8) = sizeof(BT_NVMTAG83_PROVISION);
-			}
-			else
-			{
-				status = STATUS_SUCCESS;
+Routine Description:
 
-				RtlZeroMemory(outputBuffer, outputBufferLength);
+	Drops the cached sfpd partition location, the storage stack may have
+	gone away with us, along with the requests SOCPartition was seen to fail.
 
-				// IOCTL
-				*(DWORD*)(outputBuffer) = IoControlCode;
+Arguments:
 
-				// Status
-				*(NTSTATUS*)(outputBuffer + 4) = STATUS_SUCCESS;
+	Device - handle to a WDF Device object.
 
-				// Needed Buffer Size
-				*(ULONG*)(outputBuffer + 8) = 0;
+Return Value:
 
-				// Data Size
-				*(ULONG*)(outputBuffer + 16) = sizeof(BT_NVMTAG83_PROVISION);
+	VOID.
 
-				// File Data
-				RtlCopyMemory(outputBuffer + 20, BT_NVMTAG83_PROVISION, sizeof(BT_NVMTAG83_PROVISION));
-			}
-		}
-		else if (RtlCompareMemory(L"QCOM\\BT.PROVISION", FilePath, sizeof(L"QCOM\\BT.PROVISION")) == sizeof(L"QCOM\\BT.PROVISION"))
-		{
-			// Buffer too small
-			if (outputBufferLength < 296 + sizeof(BT_PROVISION))
-			{
-				status = STATUS_SUCCESS;
+--*/
+{
+	PAGED_CODE();
 
-				RtlZeroMemory(outputBuffer, outputBufferLength);
+	InvalidateSFPDVolumePath(Device);
+	FlushNegativeCache(Device);
+}
 
-				// IOCTL
-				*(DWORD*)(outputBuffer) = IoControlCode;
+NTSTATUS
+OnDeviceSelfManagedIoInit(
+	IN WDFDEVICE Device
+)
+/*++
 
-				// Status
-				*(NTSTATUS*)(outputBuffer + 4) = STATUS_BUFFER_TOO_SMALL;
+Routine Description:
 
-				// Needed Buffer Size
-				*(ULONG*)(outputBuffer + 8) = sizeof(BT_PROVISION);
-			}
-			else
-			{
-				status = STATUS_SUCCESS;
+	Starts listening for partition and volume arrivals so the sfpd
+	partition gets resolved as soon as it shows up.
 
-				RtlZeroMemory(outputBuffer, outputBufferLength);
+Arguments:
 
-				// IOCTL
-				*(DWORD*)(outputBuffer) = IoControlCode;
+	Device - handle to a WDF Device object.
 
-				// Status
-				*(NTSTATUS*)(outputBuffer + 4) = STATUS_SUCCESS;
+Return Value:
 
-				// Needed Buffer Size
-				*(ULONG*)(outputBuffer + 8) = 0;
+	NTSTATUS indicating success or failure
 
-				// Data Size
-				*(ULONG*)(outputBuffer + 16) = sizeof(BT_PROVISION);
+--*/
+{
+	NTSTATUS status;
 
-				// Fill in the real BT MAC
-				BYTE BT_NV[9] = { 0 };
+	PAGED_CODE();
 
-				filterStatus = GetSFPDItem(device, BT_NV_FILE_PATH, BT_NV, sizeof(BT_NV));
-				if (NT_SUCCESS(filterStatus))
-				{
-					BT_PROVISION[2] = BT_NV[8];
-					BT_PROVISION[3] = BT_NV[7];
-					BT_PROVISION[4] = BT_NV[6];
-					BT_PROVISION[5] = BT_NV[5];
-					BT_PROVISION[6] = BT_NV[4];
-					BT_PROVISION[7] = BT_NV[3];
-				}
+	status = StartSFPDDiscovery(Device);
 
-				// File Data
-				RtlCopyMemory(outputBuffer + 20, BT_PROVISION, sizeof(BT_PROVISION));
-			}
-		}
-		// Sensor files
-		else if (RtlCompareMemory(L"JSON\\", FilePath, sizeof(L"JSON\\")) == (sizeof(L"JSON\\") - sizeof(WCHAR)))
-		{
-			WCHAR SensorFilePath[92 + (sizeof(SENSOR_DATA_DIRECTORY) - sizeof(WCHAR)) / sizeof(WCHAR)] = SENSOR_DATA_DIRECTORY;
-			RtlCopyMemory(SensorFilePath + (sizeof(SENSOR_DATA_DIRECTORY) - sizeof(WCHAR)) / sizeof(WCHAR), FilePath + 4, 92);
+	if (!NT_SUCCESS(status))
+	{
+		//
+		// Not fatal, requests will scan the disks themselves
+		//
+		Trace(
+			TRACE_LEVEL_ERROR,
+			TRACE_PNP,
+			"StartSFPDDiscovery failed - 0x%08lX",
+			status);
+	}
 
-			DWORD ItemSize = 0;
+	return STATUS_SUCCESS;
+}
 
-			if (device == NULL)
-			{
-				ExFreePoolWithTag(outputBuffer, HID_DESCRIPTOR_POOL_TAG);
-				ExFreePoolWithTag(inputBuffer, HID_DESCRIPTOR_POOL_TAG);
-				goto exit;
-			}
+VOID
+OnDeviceSelfManagedIoCleanup(
+	IN WDFDEVICE Device
+)
+/*++
 
-			filterStatus = GetSFPDItemSize(device, SensorFilePath, &ItemSize);
+Routine Description:
 
-			if (!NT_SUCCESS(filterStatus))
-			{
+	Waits for the pipeline workers, cancels whatever they left parked and
+	traces how the cost class queues did, then stops listening for partition
+	and volume arrivals and closes any sfpd handles still cached.
 
-				ExFreePoolWithTag(outputBuffer, HID_DESCRIPTOR_POOL_TAG);
-				ExFreePoolWithTag(inputBuffer, HID_DESCRIPTOR_POOL_TAG);
-				goto exit;
-			}
+Arguments:
 
-			// Size is not enough
-			if (outputBufferLength - 20 < ItemSize)
-			{
-				status = STATUS_SUCCESS;
+	Device - handle to a WDF Device object.
 
-				RtlZeroMemory(outputBuffer, outputBufferLength);
+Return Value:
 
-				// IOCTL
-				*(DWORD*)(outputBuffer) = IoControlCode;
+	VOID.
 
-				// Status
-				*(NTSTATUS*)(outputBuffer + 4) = STATUS_BUFFER_TOO_SMALL;
+--*/
+{
+	PFILTER_DEVICE_CONTEXT filterContext = GetFilterDeviceContext(Device);
+	WDFREQUEST request = NULL;
 
-				// Needed Buffer Size
-				*(ULONG*)(outputBuffer + 8) = ItemSize;
-			}
-			else
-			{
-				status = STATUS_SUCCESS;
+	PAGED_CODE();
+
+	// Let requests still waiting for sfpd finish first
+	for (ULONG i = 0; i < FILTER_PIPELINE_WORKER_COUNT; i++)
+	{
+		WdfWorkItemFlush(filterContext->PipelineWorkers[i]);
+	}
+
+	// Parked after the workers last looked, nobody is coming for them anymore
+	while ((request = DequeuePipelineRequest(filterContext)) != NULL)
+	{
+		WdfRequestComplete(request, STATUS_CANCELLED);
+	}
+
+	Trace(
+		TRACE_LEVEL_INFORMATION,
+		TRACE_DRIVER,
+		"Requests served without SOCPartition: %d",
+		filterContext->LocallyServed);
+
+	for (ULONG i = 0; i < FilterCostClassCount; i++)
+	{
+		PFILTER_QUEUE_CONTEXT queueContext = GetFilterQueueContext(filterContext->CostQueues[i]);
+
+		Trace(
+			TRACE_LEVEL_INFORMATION,
+			TRACE_DRIVER,
+			"Cost class %u queue - presented: %d, depth: %d, peak depth: %d, average wait: %I64d, longest wait: %I64d (100ns)",
+			i,
+			queueContext->Presented,
+			queueContext->Depth,
+			queueContext->PeakDepth,
+			queueContext->Presented != 0 ? queueContext->TotalWait / queueContext->Presented : 0,
+			queueContext->LongestWait);
+	}
+
+	StopSFPDDiscovery(Device);
+	StopSFPDWatcher(Device);
+	FlushSFPDHandleCache(Device);
+	FlushSFPDContentCache(Device);
+	FreeSFPDWarmCache(Device);
+}
+
+VOID OnIoDeviceControl(
+	IN WDFQUEUE      Queue,
+	IN WDFREQUEST    Request,
+	IN size_t        OutputBufferLength,
+	IN size_t        InputBufferLength,
+	IN ULONG         IoControlCode
+)
+{
+	NTSTATUS status;
+	WDFDEVICE device;
+	BOOLEAN forwardWithCompletionRoutine = FALSE;
+	BOOLEAN requestSent = TRUE;
+	WDF_REQUEST_SEND_OPTIONS options;
+	WDFMEMORY inputMemory = NULL;
+	WDFMEMORY outputMemory = NULL;
+	WDFIOTARGET Target;
+
+	PAGED_CODE();
+
+	device = WdfIoQueueGetDevice(Queue);
+	Target = WdfDeviceGetIoTarget(device);
 
-				RtlZeroMemory(outputBuffer, outputBufferLength);
+	Trace(
+		TRACE_LEVEL_ERROR,
+		TRACE_INIT,
+		"OnIoDeviceControl: OutputBufferLength: %d, InputBufferLength: %d, IoControlCode: %d\n",
+		(int)OutputBufferLength, (int)InputBufferLength, IoControlCode);
 
-				// IOCTL
-				*(DWORD*)(outputBuffer) = IoControlCode;
+	//
+	// Please note that QCSOCPartition provides the buffer in the Irp->UserBuffer
+	// field irrespective of the ioctl buffer type. However, framework is very
+	// strict about type checking. You cannot get Irp->UserBuffer by using
+	// WdfRequestRetrieveOutputMemory if the ioctl is not a METHOD_NEITHER
+	// internal ioctl. So depending on the ioctl code, we will either
+	// use retreive function or escape to WDM to get the UserBuffer.
+	//
+
+	switch (IoControlCode) {
+	case IOCTL_SOCPARTITION_READ_FILE:
+	case IOCTL_SOCPARTITION_GET_FILE_PROPERTY:
+	case IOCTL_SOCPARTITION_LIST_DIRECTORY_FILES:
+		//
+		// Replies to these may have to be rewritten once SOCPartition is done
+		//
+		forwardWithCompletionRoutine = TRUE;
+		break;
 
-				// Status
-				*(NTSTATUS*)(outputBuffer + 4) = STATUS_SUCCESS;
+	default:
+		break;
+	}
 
-				// Needed Buffer Size
-				*(ULONG*)(outputBuffer + 8) = 0;
+	//
+	// Coming from the default queue, parse the request header once, everything
+	// after this works from the request context, and route the request to the
+	// queue of its cost class, which presents it back here. There, answer right
+	// away if SOCPartition isn't needed.
+	//
+	if (forwardWithCompletionRoutine) {
+		PFILTER_REQUEST_CONTEXT requestContext = GetFilterRequestContext(Request);
 
-				// Data Size
-				*(ULONG*)(outputBuffer + 16) = ItemSize;
+		if (Queue == WdfDeviceGetDefaultQueue(device)) {
+			requestContext->IoControlCode = IoControlCode;
+			requestContext->InputBufferLength = InputBufferLength;
+			requestContext->OutputBufferLength = OutputBufferLength;
 
-				filterStatus = GetSFPDItem(device, SensorFilePath, outputBuffer + 20, ItemSize);
+			ParseFilterRequest(Request, requestContext);
 
-				if (!NT_SUCCESS(filterStatus))
-				{
-					ExFreePoolWithTag(outputBuffer, HID_DESCRIPTOR_POOL_TAG);
-					ExFreePoolWithTag(inputBuffer, HID_DESCRIPTOR_POOL_TAG);
-					goto exit;
-				}
+			if (RouteFilterRequest(device, Request, requestContext)) {
+				return;
 			}
 		}
-		else if (RtlCompareMemory(L"QCOM\\WLAN_PMICXO.PROVISION", FilePath, sizeof(L"QCOM\\WLAN_PMICXO.PROVISION")) == sizeof(L"QCOM\\WLAN_PMICXO.PROVISION"))
+		else {
+			AccountFilterRequestWait(Queue, requestContext);
+		}
+
+		if (ServeRequestLocally(device, Request, requestContext)) {
+			return;
+		}
+	}
+
+	//
+	// Forward the request down. WdfDeviceGetIoTarget returns
+	// the default target, which represents the device attached to us below in
+	// the stack.
+	//
+	if (forwardWithCompletionRoutine) {
+		if (InputBufferLength > 0)
 		{
-			status = STATUS_FILE_NOT_AVAILABLE;
+			//
+			// Format the request with the input memory so the completion routine
+			// can access the input data in order to cache it into the context area
+			//
+			status = WdfRequestRetrieveInputMemory(Request, &inputMemory);
+
+			if (!NT_SUCCESS(status)) {
+				Trace(
+					TRACE_LEVEL_ERROR,
+					TRACE_INIT,
+					"WdfRequestRetrieveInputMemory failed: 0x%x\n",
+					status);
+
+				WdfRequestComplete(Request, status);
+				return;
+			}
+		}
+
+		if (OutputBufferLength > 0)
+		{
+			//
+			// Format the request with the output memory so the completion routine
+			// can access the return data in order to cache it into the context area
+			//
+			status = WdfRequestRetrieveOutputMemory(Request, &outputMemory);
+
+			if (!NT_SUCCESS(status)) {
+				Trace(
+					TRACE_LEVEL_ERROR,
+					TRACE_INIT,
+					"WdfRequestRetrieveOutputMemory failed: 0x%x\n",
+					status);
 
-			RtlZeroMemory(outputBuffer, outputBufferLength);
+				WdfRequestComplete(Request, status);
+				return;
+			}
+		}
+
+		status = WdfIoTargetFormatRequestForIoctl(
+			Target,
+			Request,
+			IoControlCode,
+			inputMemory,
+			NULL,
+			outputMemory,
+			NULL);
+
+		if (!NT_SUCCESS(status)) {
+			Trace(
+				TRACE_LEVEL_ERROR,
+				TRACE_INIT,
+				"WdfIoTargetFormatRequestForIoctl failed: 0x%x\n",
+				status);
+
+			WdfRequestComplete(Request, status);
+			return;
+		}
+
+		//
+		// Set our completion routine with the request's own context, which
+		// unlike our parameters is still around when it runs
+		//
+		WdfRequestSetCompletionRoutine(
+			Request,
+			OnRequestCompletionRoutine,
+			GetFilterRequestContext(Request));
+
+		requestSent = WdfRequestSend(
+			Request,
+			Target,
+			WDF_NO_SEND_OPTIONS);
+	}
+	else
+	{
+		//
+		// We are not interested in post processing the IRP so
+		// fire and forget.
+		//
+		WDF_REQUEST_SEND_OPTIONS_INIT(
+			&options,
+			WDF_REQUEST_SEND_OPTION_SEND_AND_FORGET);
+
+		requestSent = WdfRequestSend(Request, Target, &options);
+	}
+
+	if (requestSent == FALSE) {
+		status = WdfRequestGetStatus(Request);
+
+		Trace(
+			TRACE_LEVEL_ERROR,
+			TRACE_INIT,
+			"WdfRequestSend failed: 0x%x\n",
+			status);
+
+		WdfRequestComplete(Request, status);
+	}
+
+	return;
+}
 
-			// IOCTL
-			*(DWORD*)(outputBuffer) = IoControlCode;
+//
+// Answers a ReadFile, GetFileProperty or ListDirectoryFiles request for a path
+// the filter owns, writing the reply into outputBuffer. Returns FALSE, with
+// the output untouched, when the filter has nothing to say about the request.
+// The output buffer must hold at least the header. Returning FALSE leaves
+// the reply already in the output buffer, if any, standing.
+//
+static BOOLEAN ServeVirtualFileRequest(WDFDEVICE device, PFILTER_REQUEST_CONTEXT requestContext, PUCHAR outputBuffer, ULONG outputBufferLength, NTSTATUS* RequestStatus)
+{
+	DWORD IoControlCode = requestContext->IoControlCode;
+	PWCHAR FilePath = requestContext->Path;
+	PVIRTUAL_FILE File = requestContext->File;
 
-			// Status
-			*(NTSTATUS*)(outputBuffer + 4) = STATUS_FILE_NOT_AVAILABLE;
+	NTSTATUS filterStatus;
 
-			// Needed Buffer Size
-			*(ULONG*)(outputBuffer + 8) = 0;
+	// Taken before any sfpd read, so a memo never outlives what it was worked out from
+	LONG Generation = GetSFPDCacheGeneration(device);
 
-			if (outputBufferLength > 296)
-			{
-				// Data Size
-				*(ULONG*)(outputBuffer + 16) = 1;
+	// Second half of a size probe
+	if (ServeFromProbeMemo(device, requestContext, outputBuffer, outputBufferLength, RequestStatus))
+	{
+		return TRUE;
+	}
 
-				// File Data
-				*(ULONG*)(outputBuffer + 20) = 0;
-			}
-		}
-		else if (RtlCompareMemory(L"QCOM\\WLAN.PROVISION", FilePath, sizeof(L"QCOM\\WLAN.PROVISION")) == sizeof(L"QCOM\\WLAN.PROVISION"))
+	switch (IoControlCode)
+	{
+	case IOCTL_SOCPARTITION_READ_FILE:
+	{
+		if (File == NULL)
 		{
-			// Buffer too small
-			if (outputBufferLength < 296 + sizeof(WLAN_PROVISION))
-			{
-				status = STATUS_SUCCESS;
-
-				RtlZeroMemory(outputBuffer, outputBufferLength);
+			// We do not support anything else currently.
+			return FALSE;
+		}
 
-				// IOCTL
-				*(DWORD*)(outputBuffer) = IoControlCode;
+		if (File->Kind == VirtualFileStatusOnly)
+		{
+			*RequestStatus = File->StatusOverride;
 
-				// Status
-				*(NTSTATUS*)(outputBuffer + 4) = STATUS_BUFFER_TOO_SMALL;
+			// A single zero byte of data when there is room for it
+			ULONG StatusDataSize = outputBufferLength > SOCPARTITION_HEADER_SIZE ? 1 : 0;
 
-				// Needed Buffer Size
-				*(ULONG*)(outputBuffer + 8) = sizeof(WLAN_PROVISION);
-			}
-			else
+			if (StatusDataSize != 0)
 			{
-				status = STATUS_SUCCESS;
-
-				RtlZeroMemory(outputBuffer, outputBufferLength);
-
-				// IOCTL
-				*(DWORD*)(outputBuffer) = IoControlCode;
-
-				// Status
-				*(NTSTATUS*)(outputBuffer + 4) = STATUS_SUCCESS;
-
-				// Needed Buffer Size
-				*(ULONG*)(outputBuffer + 8) = 0;
-
-				// Data Size
-				*(ULONG*)(outputBuffer + 16) = sizeof(WLAN_PROVISION);
-
-				// Fill in the real BT MAC
-				BYTE WLAN_MAC[33] = { 0 };
-
-				filterStatus = GetSFPDItem(device, WLAN_MAC_FILE_PATH, WLAN_MAC, sizeof(WLAN_MAC));
-				if (NT_SUCCESS(filterStatus))
-				{
-					BYTE MAC_ADDRESS[6] = { 0 };
-
-					for (DWORD i = 0; i < sizeof(MAC_ADDRESS); i++)
-					{
-						DWORD HighIndex = 16 + i * 2;
-						DWORD LowIndex = 16 + (i * 2) + 1;
-
-						DWORD ByteHigh = WLAN_MAC[HighIndex];
-						DWORD ByteLow = WLAN_MAC[LowIndex];
-
-						if (0x30 <= ByteHigh && ByteHigh <= 0x39)
-						{
-							MAC_ADDRESS[i] |= ((ByteHigh - 0x30) << 4) & 0xF0;
-						}
-						else if (0x41 <= ByteHigh && ByteHigh <= 0x46)
-						{
-							MAC_ADDRESS[i] |= ((ByteHigh - 0x37) << 4) & 0xF0;
-						}
-						else
-						{
-							goto skip_mac;
-						}
-
-						if (0x30 <= ByteLow && ByteLow <= 0x39)
-						{
-							MAC_ADDRESS[i] |= (ByteLow - 0x30) & 0x0F;
-						}
-						else if (0x41 <= ByteLow && ByteLow <= 0x46)
-						{
-							MAC_ADDRESS[i] |= (ByteLow - 0x37) & 0x0F;
-						}
-						else
-						{
-							goto skip_mac;
-						}
-					}
-
-					WLAN_PROVISION[3] = MAC_ADDRESS[0];
-					WLAN_PROVISION[4] = MAC_ADDRESS[1];
-					WLAN_PROVISION[5] = MAC_ADDRESS[2];
-					WLAN_PROVISION[6] = MAC_ADDRESS[3];
-					WLAN_PROVISION[7] = MAC_ADDRESS[4];
-					WLAN_PROVISION[8] = MAC_ADDRESS[5];
-				}
-
-skip_mac:
 				// File Data
-				RtlCopyMemory(outputBuffer + 20, WLAN_PROVISION, sizeof(WLAN_PROVISION));
+				*(ULONG*)GetSOCPartitionReplyData(outputBuffer) = 0;
 			}
-		}
-		else if (RtlCompareMemory(L"QCOM\\WLAN_CLPC.PROVISION", FilePath, sizeof(L"QCOM\\WLAN_CLPC.PROVISION")) == sizeof(L"QCOM\\WLAN_CLPC.PROVISION"))
-		{
-			// Buffer too small
-			if (outputBufferLength < 296 + sizeof(WLAN_CLPC_PROVISION))
-			{
-				status = STATUS_SUCCESS;
 
-				RtlZeroMemory(outputBuffer, outputBufferLength);
+			FinishSOCPartitionReply(outputBuffer, outputBufferLength, IoControlCode, File->StatusOverride, 0, StatusDataSize);
 
-				// IOCTL
-				*(DWORD*)(outputBuffer) = IoControlCode;
+			break;
+		}
 
-				// Status
-				*(NTSTATUS*)(outputBuffer + 4) = STATUS_BUFFER_TOO_SMALL;
+		DWORD FileSize = 0;
 
-				// Needed Buffer Size
-				*(ULONG*)(outputBuffer + 8) = sizeof(WLAN_CLPC_PROVISION);
-			}
-			else
-			{
-				status = STATUS_SUCCESS;
+		// Blobs need room for a whole header after the data, sfpd files only the reply fields
+		DWORD DataSize = File->Kind == VirtualFileSFPD ? outputBufferLength - SOCPARTITION_REPLY_HEADER_SIZE : outputBufferLength - SOCPARTITION_HEADER_SIZE;
 
-				RtlZeroMemory(outputBuffer, outputBufferLength);
+		filterStatus = File->GetContent(device, File, FilePath, GetSOCPartitionReplyData(outputBuffer), DataSize, &FileSize);
 
-				// IOCTL
-				*(DWORD*)(outputBuffer) = IoControlCode;
+		// Size is not enough
+		if (filterStatus == STATUS_BUFFER_TOO_SMALL)
+		{
+			*RequestStatus = STATUS_SUCCESS;
 
-				// Status
-				*(NTSTATUS*)(outputBuffer + 4) = STATUS_SUCCESS;
+			FinishSOCPartitionReply(outputBuffer, outputBufferLength, IoControlCode, STATUS_BUFFER_TOO_SMALL, FileSize, 0);
 
-				// Needed Buffer Size
-				*(ULONG*)(outputBuffer + 8) = 0;
+			// Blobs are a copy anyway, only sfpd files are worth remembering. The
+			// retry reads through the content cache, only the size is kept here.
+			if (File->Kind == VirtualFileSFPD)
+			{
+				RecordProbeMemo(device, IoControlCode, FilePath, Generation, FileSize, SOCPARTITION_REPLY_HEADER_SIZE, STATUS_SUCCESS);
+			}
+		}
+		else if (!NT_SUCCESS(filterStatus))
+		{
+			return FALSE;
+		}
+		else
+		{
+			*RequestStatus = STATUS_SUCCESS;
 
-				// Data Size
-				*(ULONG*)(outputBuffer + 16) = sizeof(WLAN_CLPC_PROVISION);
+			// File data is already in place
+			FinishSOCPartitionReply(outputBuffer, outputBufferLength, IoControlCode, STATUS_SUCCESS, 0, FileSize);
+		}
 
-				// File Data
-				RtlCopyMemory(outputBuffer + 20, WLAN_CLPC_PROVISION, sizeof(WLAN_CLPC_PROVISION));
-			}
+		break;
+	}
+	case IOCTL_SOCPARTITION_LIST_DIRECTORY_FILES:
+	{
+		if (requestContext->FileSystemProperty != SOCPARTITION_FILE_SYSTEM_PROPERTY_LISTING)
+		{
+			// We only support number of files currently
+			return FALSE;
 		}
-		else if (RtlCompareMemory(L"QCOM\\WLAN_SAR2CFG.PROVISION", FilePath, sizeof(L"QCOM\\WLAN_SAR2CFG.PROVISION")) == sizeof(L"QCOM\\WLAN_SAR2CFG.PROVISION"))
+
+		if (RtlCompareMemory(L"JSON", FilePath, sizeof(L"JSON")) == sizeof(L"JSON"))
 		{
-			// Buffer too small
-			if (outputBufferLength < 296 + sizeof(WLAN_SAR2CFG_PROVISION))
-			{
-				status = STATUS_SUCCESS;
+			DWORD ListingSize = 0;
 
-				// IOCTL
-				RtlZeroMemory(outputBuffer, outputBufferLength);
+			// Probe and fill in one go, the records land in the reply directly
+			filterStatus = GetSFPDDirectoryListing(device, SENSOR_DATA_DIRECTORY, GetSOCPartitionReplyData(outputBuffer), outputBufferLength - SOCPARTITION_HEADER_SIZE, &ListingSize);
 
-				*(DWORD*)(outputBuffer) = IoControlCode;
+			// Buffer too small
+			if (filterStatus == STATUS_BUFFER_TOO_SMALL)
+			{
+				*RequestStatus = STATUS_BUFFER_TOO_SMALL;
 
-				// Status
-				*(NTSTATUS*)(outputBuffer + 4) = STATUS_BUFFER_TOO_SMALL;
+				FinishSOCPartitionReply(outputBuffer, outputBufferLength, IoControlCode, STATUS_BUFFER_TOO_SMALL, ListingSize, 0);
 
-				// Needed Buffer Size
-				*(ULONG*)(outputBuffer + 8) = sizeof(WLAN_SAR2CFG_PROVISION);
+				RecordProbeMemo(device, IoControlCode, FilePath, Generation, ListingSize, SOCPARTITION_HEADER_SIZE, STATUS_BUFFER_TOO_SMALL);
+			}
+			else if (!NT_SUCCESS(filterStatus))
+			{
+				return FALSE;
 			}
 			else
 			{
-				status = STATUS_SUCCESS;
-
-				RtlZeroMemory(outputBuffer, outputBufferLength);
-
-				// IOCTL
-				*(DWORD*)(outputBuffer) = IoControlCode;
-
-				// Status
-				*(NTSTATUS*)(outputBuffer + 4) = STATUS_SUCCESS;
-
-				// Needed Buffer Size
-				*(ULONG*)(outputBuffer + 8) = 0;
-
-				// Data Size
-				*(ULONG*)(outputBuffer + 16) = sizeof(WLAN_SAR2CFG_PROVISION);
+				*RequestStatus = STATUS_SUCCESS;
 
-				// File Data
-				RtlCopyMemory(outputBuffer + 20, WLAN_SAR2CFG_PROVISION, sizeof(WLAN_SAR2CFG_PROVISION));
+				// Records are already in place
+				FinishSOCPartitionReply(outputBuffer, outputBufferLength, IoControlCode, STATUS_SUCCESS, 0, ListingSize);
 			}
 		}
 		else
 		{
 			// We do not support anything else currently.
-			ExFreePoolWithTag(outputBuffer, HID_DESCRIPTOR_POOL_TAG);
-			ExFreePoolWithTag(inputBuffer, HID_DESCRIPTOR_POOL_TAG);
-			goto exit;
+			return FALSE;
 		}
 
 		break;
 	}
-	case 0xECAF32CE: // ListDirectoryFiles
+	case IOCTL_SOCPARTITION_GET_FILE_PROPERTY:
 	{
-		PWCHAR FilePath = (PWCHAR)(inputBuffer + 88); // 96 size
-		DWORD FileSystemProperty = *(PDWORD)(inputBuffer + 284);
+		if (requestContext->FileProperty != SOCPARTITION_FILE_PROPERTY_SIZE)
+		{
+			// We only support actual file size currently
+			return FALSE;
+		}
 
-		if (FileSystemProperty != 10)
+		if (File == NULL)
 		{
-			// We only support number of files currently
-			ExFreePoolWithTag(outputBuffer, HID_DESCRIPTOR_POOL_TAG);
-			ExFreePoolWithTag(inputBuffer, HID_DESCRIPTOR_POOL_TAG);
-			goto exit;
+			// We do not support anything else currently.
+			return FALSE;
 		}
 
-		if (RtlCompareMemory(L"JSON", FilePath, sizeof(L"JSON")) == sizeof(L"JSON"))
+		// Buffer too small
+		if (outputBufferLength < SOCPARTITION_HEADER_SIZE + sizeof(DWORD))
 		{
-			DWORD NumberOfFiles = 0;
+			*RequestStatus = STATUS_SUCCESS;
 
-			if (device == NULL)
-			{
-				ExFreePoolWithTag(outputBuffer, HID_DESCRIPTOR_POOL_TAG);
-				ExFreePoolWithTag(inputBuffer, HID_DESCRIPTOR_POOL_TAG);
-				goto exit;
-			}
+			FinishSOCPartitionReply(outputBuffer, outputBufferLength, IoControlCode, STATUS_BUFFER_TOO_SMALL, sizeof(DWORD), 0);
 
-			filterStatus = GetSFPDNumberOfFilesInDirectory(device, SENSOR_DATA_DIRECTORY, &NumberOfFiles);
+			break;
+		}
 
-			if (!NT_SUCCESS(filterStatus))
-			{
+		if (File->Kind == VirtualFileStatusOnly)
+		{
+			*RequestStatus = File->StatusOverride;
 
-				ExFreePoolWithTag(outputBuffer, HID_DESCRIPTOR_POOL_TAG);
-				ExFreePoolWithTag(inputBuffer, HID_DESCRIPTOR_POOL_TAG);
-				goto exit;
-			}
+			// File Size
+			*(ULONG*)GetSOCPartitionReplyData(outputBuffer) = 0;
 
-			DWORD TotalNeededBufferSize = NumberOfFiles * 244;
+			FinishSOCPartitionReply(outputBuffer, outputBufferLength, IoControlCode, File->StatusOverride, 0, 1);
 
-			// Buffer too small
-			if (outputBufferLength < 296 + TotalNeededBufferSize)
-			{
-				status = STATUS_BUFFER_TOO_SMALL;
+			break;
+		}
 
-				RtlZeroMemory(outputBuffer, outputBufferLength);
+		DWORD FileSize = 0;
 
-				// IOCTL
-				*(DWORD*)(outputBuffer) = IoControlCode;
+		filterStatus = File->GetSize(device, File, FilePath, &FileSize);
 
-				// Status
-				*(NTSTATUS*)(outputBuffer + 4) = STATUS_BUFFER_TOO_SMALL;
+		if (!NT_SUCCESS(filterStatus))
+		{
+			return FALSE;
+		}
 
-				// Needed Buffer Size
-				*(ULONG*)(outputBuffer + 8) = TotalNeededBufferSize;
-			}
-			else
-			{
-				status = STATUS_SUCCESS;
+		*RequestStatus = STATUS_SUCCESS;
 
-				RtlZeroMemory(outputBuffer, outputBufferLength);
+		// File Size
+		*(ULONG*)GetSOCPartitionReplyData(outputBuffer) = FileSize;
 
-				// IOCTL
-				*(DWORD*)(outputBuffer) = IoControlCode;
+		FinishSOCPartitionReply(outputBuffer, outputBufferLength, IoControlCode, STATUS_SUCCESS, 0, sizeof(DWORD));
 
-				// Status
-				*(NTSTATUS*)(outputBuffer + 4) = STATUS_SUCCESS;
+		// Usually followed by a read sized from it, or the same question again
+		if (File->Kind == VirtualFileSFPD)
+		{
+			RecordProbeMemo(device, IoControlCode, FilePath, Generation, FileSize, 0, STATUS_SUCCESS);
+		}
 
-				// Needed Buffer Size
-				*(ULONG*)(outputBuffer + 8) = 0;
+		break;
+	}
+	default:
+		return FALSE;
+	}
 
-				// Data Size
-				*(ULONG*)(outputBuffer + 16) = TotalNeededBufferSize;
+	return TRUE;
+}
 
-				// Fill it in!
-				filterStatus = GetSFPDFilesInDirectory(device, SENSOR_DATA_DIRECTORY, NumberOfFiles, outputBuffer + 20);
+//
+// Whether the filter's answer to a request may have to read sfpd, which has
+// to wait for a pipeline worker when completing at raised IRQL.
+//
+static BOOLEAN IsFileBackedRequest(WDFDEVICE device, PFILTER_REQUEST_CONTEXT requestContext)
+{
+	PVIRTUAL_FILE File = requestContext->File;
 
-				if (!NT_SUCCESS(filterStatus))
-				{
+	switch (requestContext->IoControlCode)
+	{
+	case IOCTL_SOCPARTITION_READ_FILE:
+	case IOCTL_SOCPARTITION_GET_FILE_PROPERTY:
+		return File != NULL && VirtualFileNeedsIo(device, File, requestContext->IoControlCode == IOCTL_SOCPARTITION_READ_FILE);
+	case IOCTL_SOCPARTITION_LIST_DIRECTORY_FILES:
+		// Only the listing of JSON is answered from sfpd, as in ServeVirtualFileRequest
+		return requestContext->FileSystemProperty == SOCPARTITION_FILE_SYSTEM_PROPERTY_LISTING &&
+			RtlCompareMemory(L"JSON", requestContext->Path, sizeof(L"JSON")) == sizeof(L"JSON");
+	default:
+		return FALSE;
+	}
+}
 
-					ExFreePoolWithTag(outputBuffer, HID_DESCRIPTOR_POOL_TAG);
-					ExFreePoolWithTag(inputBuffer, HID_DESCRIPTOR_POOL_TAG);
-					goto exit;
-				}
-			}
-		}
-		else
-		{
-			// We do not support anything else currently.
-			ExFreePoolWithTag(outputBuffer, HID_DESCRIPTOR_POOL_TAG);
-			ExFreePoolWithTag(inputBuffer, HID_DESCRIPTOR_POOL_TAG);
-			goto exit;
-		}
+//
+// Parks a request for the pipeline workers. It stays cancelable while it
+// waits, the caller may give up on it before a worker gets to it.
+//
+static VOID QueuePipelineRequest(WDFDEVICE device, WDFREQUEST Request)
+{
+	PFILTER_DEVICE_CONTEXT filterContext = GetFilterDeviceContext(device);
+	PFILTER_REQUEST_CONTEXT requestContext = GetFilterRequestContext(Request);
 
-		break;
+	InterlockedIncrement(&filterContext->DeferredCompletions);
+
+	WdfSpinLockAcquire(filterContext->PipelineLock);
+
+	// The Ex flavor never calls the cancel routine itself, so holding the lock is fine
+	NTSTATUS status = WdfRequestMarkCancelableEx(Request, OnPipelineRequestCancel);
+
+	if (NT_SUCCESS(status))
+	{
+		InsertTailList(&filterContext->PipelineRequests, &requestContext->PipelineLink);
 	}
-	case 0xECAF32C6: // GetFileProperty
+
+	WdfSpinLockRelease(filterContext->PipelineLock);
+
+	if (!NT_SUCCESS(status))
 	{
-		PWCHAR FilePath = (PWCHAR)(inputBuffer + 88); // 96 size
-		DWORD FileProperty = *(PDWORD)(inputBuffer + 280);
+		WdfRequestComplete(Request, status);
+		return;
+	}
 
-		if (FileProperty != 2)
-		{
-			// We only support actual file size currently
+	// Wake an idle worker, busy ones drain the list before going idle
+	for (ULONG i = 0; i < FILTER_PIPELINE_WORKER_COUNT; i++)
+	{
+		WDFWORKITEM worker = filterContext->PipelineWorkers[i];
 
-			ExFreePoolWithTag(outputBuffer, HID_DESCRIPTOR_POOL_TAG);
-			ExFreePoolWithTag(inputBuffer, HID_DESCRIPTOR_POOL_TAG);
-			goto exit;
+		if (InterlockedCompareExchange(&GetFilterPipelineWorkerContext(worker)->Busy, 1, 0) == 0)
+		{
+			WdfWorkItemEnqueue(worker);
+			break;
 		}
+	}
+}
 
-		// Buffer too small
-		if (outputBufferLength < 296 + sizeof(DWORD))
-		{
-			status = STATUS_SUCCESS;
+//
+// Takes the oldest parked request off the list, no longer cancelable. Requests
+// being canceled are left to OnPipelineRequestCancel.
+//
+static WDFREQUEST DequeuePipelineRequest(PFILTER_DEVICE_CONTEXT filterContext)
+{
+	WDFREQUEST Request = NULL;
 
-			RtlZeroMemory(outputBuffer, outputBufferLength);
+	WdfSpinLockAcquire(filterContext->PipelineLock);
 
-			// IOCTL
-			*(DWORD*)(outputBuffer) = IoControlCode;
+	while (Request == NULL && !IsListEmpty(&filterContext->PipelineRequests))
+	{
+		PLIST_ENTRY link = RemoveHeadList(&filterContext->PipelineRequests);
+		PFILTER_REQUEST_CONTEXT requestContext = CONTAINING_RECORD(link, FILTER_REQUEST_CONTEXT, PipelineLink);
 
-			// Status
-			*(NTSTATUS*)(outputBuffer + 4) = STATUS_BUFFER_TOO_SMALL;
+		// Off the list, so the cancel routine finds nothing left to unlink
+		InitializeListHead(link);
 
-			// Needed Buffer Size
-			*(ULONG*)(outputBuffer + 8) = sizeof(DWORD);
-		}
-		else
+		Request = (WDFREQUEST)WdfObjectContextGetObject(requestContext);
+
+		if (WdfRequestUnmarkCancelable(Request) == STATUS_CANCELLED)
 		{
-			if (RtlCompareMemory(L"QCOM\\BT_NVMTAG36.PROVISION", FilePath, sizeof(L"QCOM\\BT_NVMTAG36.PROVISION")) == sizeof(L"QCOM\\BT_NVMTAG36.PROVISION"))
-			{
-				status = STATUS_SUCCESS;
+			Request = NULL;
+		}
+	}
 
-				// IOCTL
-				RtlZeroMemory(outputBuffer, outputBufferLength);
+	WdfSpinLockRelease(filterContext->PipelineLock);
 
-				*(DWORD*)(outputBuffer) = IoControlCode;
+	return Request;
+}
 
-				// Status
-				*(NTSTATUS*)(outputBuffer + 4) = STATUS_SUCCESS;
+VOID
+OnPipelineRequestCancel(
+	IN WDFREQUEST Request
+)
+/*++
 
-				// Needed Buffer Size
-				*(ULONG*)(outputBuffer + 8) = 0;
+Routine Description:
 
-				// Data Size
-				*(ULONG*)(outputBuffer + 16) = sizeof(DWORD);
+	Completes a request canceled while parked for the pipeline workers.
 
-				// File Size
-				*(ULONG*)(outputBuffer + 20) = sizeof(BT_NVMTAG36_PROVISION);
-			}
-			else if (RtlCompareMemory(L"QCOM\\BT_NVMTAG83.PROVISION", FilePath, sizeof(L"QCOM\\BT_NVMTAG83.PROVISION")) == sizeof(L"QCOM\\BT_NVMTAG83.PROVISION"))
-			{
-				status = STATUS_SUCCESS;
+Arguments:
 
-				RtlZeroMemory(outputBuffer, outputBufferLength);
+	Request - the canceled request.
 
-				// IOCTL
-				*(DWORD*)(outputBuffer) = IoControlCode;
+Return Value:
 
-				// Status
-				*(NTSTATUS*)(outputBuffer + 4) = STATUS_SUCCESS;
+	VOID.
 
-				// Needed Buffer Size
-				*(ULONG*)(outputBuffer + 8) = 0;
+--*/
+{
+	WDFDEVICE device = WdfIoQueueGetDevice(WdfRequestGetIoQueue(Request));
+	PFILTER_DEVICE_CONTEXT filterContext = GetFilterDeviceContext(device);
+	PFILTER_REQUEST_CONTEXT requestContext = GetFilterRequestContext(Request);
 
-				// Data Size
-				*(ULONG*)(outputBuffer + 16) = sizeof(DWORD);
+	// A worker may have taken it off the list already and lost the race to unmark it
+	WdfSpinLockAcquire(filterContext->PipelineLock);
+	RemoveEntryList(&requestContext->PipelineLink);
+	InitializeListHead(&requestContext->PipelineLink);
+	WdfSpinLockRelease(filterContext->PipelineLock);
 
-				// File Size
-				*(ULONG*)(outputBuffer + 20) = sizeof(BT_NVMTAG83_PROVISION);
-			}
-			else if (RtlCompareMemory(L"QCOM\\BT.PROVISION", FilePath, sizeof(L"QCOM\\BT.PROVISION")) == sizeof(L"QCOM\\BT.PROVISION"))
-			{
-				status = STATUS_SUCCESS;
+	WdfRequestComplete(Request, STATUS_CANCELLED);
+}
 
-				RtlZeroMemory(outputBuffer, outputBufferLength);
+VOID
+OnPipelineWorkItem(
+	IN WDFWORKITEM WorkItem
+)
+/*++
 
-				// IOCTL
-				*(DWORD*)(outputBuffer) = IoControlCode;
+Routine Description:
 
-				// Status
-				*(NTSTATUS*)(outputBuffer + 4) = STATUS_SUCCESS;
+	Second stage of the completion pipeline, at PASSIVE_LEVEL. Answers the
+	requests the completion routine left for it, reading sfpd as needed,
+	and completes them. Runs until no request is left waiting.
 
-				// Needed Buffer Size
-				*(ULONG*)(outputBuffer + 8) = 0;
+Arguments:
 
-				// Data Size
-				*(ULONG*)(outputBuffer + 16) = sizeof(DWORD);
+	WorkItem - one of the device's pipeline workers.
 
-				// File Size
-				*(ULONG*)(outputBuffer + 20) = sizeof(BT_PROVISION);
-			}
-			// Sensor files
-			else if (RtlCompareMemory(L"JSON\\", FilePath, sizeof(L"JSON\\")) == sizeof(L"JSON\\"))
-			{
-				WCHAR SensorFilePath[92 + (sizeof(SENSOR_DATA_DIRECTORY) - sizeof(WCHAR)) / sizeof(WCHAR)] = SENSOR_DATA_DIRECTORY;
-				RtlCopyMemory(SensorFilePath + (sizeof(SENSOR_DATA_DIRECTORY) - sizeof(WCHAR)) / sizeof(WCHAR), FilePath + 4, 92);
+Return Value:
 
-				DWORD ItemSize = 0;
+	VOID.
 
-				if (device == NULL)
-				{
-					ExFreePoolWithTag(outputBuffer, HID_DESCRIPTOR_POOL_TAG);
-					ExFreePoolWithTag(inputBuffer, HID_DESCRIPTOR_POOL_TAG);
-					goto exit;
-				}
+--*/
+{
+	WDFDEVICE device = (WDFDEVICE)WdfWorkItemGetParentObject(WorkItem);
+	PFILTER_DEVICE_CONTEXT filterContext = GetFilterDeviceContext(device);
+	PFILTER_PIPELINE_WORKER_CONTEXT workerContext = GetFilterPipelineWorkerContext(WorkItem);
 
-				filterStatus = GetSFPDItemSize(device, SensorFilePath, &ItemSize);
+	while (TRUE)
+	{
+		WDFREQUEST Request = DequeuePipelineRequest(filterContext);
 
-				if (!NT_SUCCESS(filterStatus))
-				{
-					ExFreePoolWithTag(outputBuffer, HID_DESCRIPTOR_POOL_TAG);
-					ExFreePoolWithTag(inputBuffer, HID_DESCRIPTOR_POOL_TAG);
-					goto exit;
-				}
+		if (Request == NULL)
+		{
+			InterlockedExchange(&workerContext->Busy, 0);
 
-				status = STATUS_SUCCESS;
+			//
+			// A request queued while we were finding the list empty may have
+			// seen us busy and woken nobody, look once more
+			//
+			WdfSpinLockAcquire(filterContext->PipelineLock);
+			BOOLEAN empty = IsListEmpty(&filterContext->PipelineRequests);
+			WdfSpinLockRelease(filterContext->PipelineLock);
 
-				RtlZeroMemory(outputBuffer, outputBufferLength);
+			if (empty || InterlockedCompareExchange(&workerContext->Busy, 1, 0) != 0)
+			{
+				break;
+			}
 
-				// IOCTL
-				*(DWORD*)(outputBuffer) = IoControlCode;
+			continue;
+		}
 
-				// Status
-				*(NTSTATUS*)(outputBuffer + 4) = STATUS_SUCCESS;
+		PFILTER_REQUEST_CONTEXT requestContext = GetFilterRequestContext(Request);
+		NTSTATUS status = requestContext->Status;
 
-				// Needed Buffer Size
-				*(ULONG*)(outputBuffer + 8) = 0;
+		if (ServeVirtualFileRequest(device, requestContext, requestContext->OutputBuffer, requestContext->OutputLength, &status))
+		{
+			// SOCPartition will keep failing this one, skip it next time
+			InsertNegativeCache(device, requestContext);
+		}
 
-				// Data Size
-				*(ULONG*)(outputBuffer + 16) = sizeof(DWORD);
+		WdfRequestComplete(Request, status);
+	}
+}
 
-				// File Size
-				*(ULONG*)(outputBuffer + 20) = ItemSize;
-			}
-			else if (RtlCompareMemory(L"QCOM\\WLAN_PMICXO.PROVISION", FilePath, sizeof(L"QCOM\\WLAN_PMICXO.PROVISION")) == sizeof(L"QCOM\\WLAN_PMICXO.PROVISION"))
-			{
-				status = STATUS_FILE_NOT_AVAILABLE;
+VOID
+OnRequestCompletionRoutine(
+	IN WDFREQUEST  Request,
+	IN WDFIOTARGET  Target,
+	IN PWDF_REQUEST_COMPLETION_PARAMS  Params,
+	IN WDFCONTEXT  Context
+)
+/*++
 
-				RtlZeroMemory(outputBuffer, outputBufferLength);
+Routine Description:
 
-				// IOCTL
-				*(DWORD*)(outputBuffer) = IoControlCode;
+	Completion Routine
 
-				// Status
-				*(NTSTATUS*)(outputBuffer + 4) = STATUS_FILE_NOT_AVAILABLE;
+Arguments:
 
-				// Needed Buffer Size
-				*(ULONG*)(outputBuffer + 8) = 0;
+	Target - Target handle
+	Request - Request handle
+	Params - request completion params
+	Context - Driver supplied context
 
-				// Data Size
-				*(ULONG*)(outputBuffer + 16) = 1;
 
-				// File Size
-				*(ULONG*)(outputBuffer + 20) = 0;
-			}
-			else if (RtlCompareMemory(L"QCOM\\WLAN.PROVISION", FilePath, sizeof(L"QCOM\\WLAN.PROVISION")) == sizeof(L"QCOM\\WLAN.PROVISION"))
-			{
-				status = STATUS_SUCCESS;
+Return Value:
 
-				RtlZeroMemory(outputBuffer, outputBufferLength);
+	VOID
 
-				// IOCTL
-				*(DWORD*)(outputBuffer) = IoControlCode;
+--*/
+{
+	NTSTATUS status = STATUS_UNSUCCESSFUL;
 
-				// Status
-				*(NTSTATUS*)(outputBuffer + 4) = STATUS_SUCCESS;
+	if (Params == NULL)
+	{
+		goto exit;
+	}
 
-				// Needed Buffer Size
-				*(ULONG*)(outputBuffer + 8) = 0;
+	if (Context == NULL)
+	{
+		goto exit;
+	}
 
-				// Data Size
-				*(ULONG*)(outputBuffer + 16) = sizeof(DWORD);
+	WDFDEVICE device = WdfIoTargetGetDevice(Target);
+	if (device == NULL)
+	{
+		goto exit;
+	}
 
-				// File Size
-				*(ULONG*)(outputBuffer + 20) = sizeof(WLAN_PROVISION);
-			}
-			else if (RtlCompareMemory(L"QCOM\\WLAN_CLPC.PROVISION", FilePath, sizeof(L"QCOM\\WLAN_CLPC.PROVISION")) == sizeof(L"QCOM\\WLAN_CLPC.PROVISION"))
-			{
-				status = STATUS_SUCCESS;
+	// The result of the IOCTL call to the SOCPartition driver
+	status = Params->IoStatus.Status;
 
-				RtlZeroMemory(outputBuffer, outputBufferLength);
+	// The output buffer for the IOCTL call to the SOCPartition driver
+	WDFMEMORY outputMemory = Params->Parameters.Ioctl.Output.Buffer;
 
-				// IOCTL
-				*(DWORD*)(outputBuffer) = IoControlCode;
+	// What OnIoDeviceControl saw when it sent the request on
+	PFILTER_REQUEST_CONTEXT requestContext = (PFILTER_REQUEST_CONTEXT)Context;
 
-				// Status
-				*(NTSTATUS*)(outputBuffer + 4) = STATUS_SUCCESS;
+	// The length of the output buffer sent to SOCPartition
+	ULONG outputBufferLength = (ULONG)Params->Parameters.Ioctl.Output.Length;
 
-				// Needed Buffer Size
-				*(ULONG*)(outputBuffer + 8) = 0;
+	DWORD IoControlCode = requestContext->IoControlCode;
 
-				// Data Size
-				*(ULONG*)(outputBuffer + 16) = sizeof(DWORD);
+	// Everything the filter needs from the input was parsed at dispatch, which needs a whole header
+	if (!requestContext->Parsed || outputMemory == NULL)
+	{
+		goto exit;
+	}
 
-				// File Size
-				*(ULONG*)(outputBuffer + 20) = sizeof(WLAN_CLPC_PROVISION);
-			}
-			else if (RtlCompareMemory(L"QCOM\\WLAN_SAR2CFG.PROVISION", FilePath, sizeof(L"QCOM\\WLAN_SAR2CFG.PROVISION")) == sizeof(L"QCOM\\WLAN_SAR2CFG.PROVISION"))
-			{
-				status = STATUS_SUCCESS;
+	//
+	// Work on the request's own output buffer, the IOCTLs are
+	// METHOD_OUT_DIRECT so input and output never share memory
+	//
+	size_t outputMemoryLength = 0;
 
-				RtlZeroMemory(outputBuffer, outputBufferLength);
+	PUCHAR outputBuffer = (PUCHAR)WdfMemoryGetBuffer(outputMemory, &outputMemoryLength);
 
-				// IOCTL
-				*(DWORD*)(outputBuffer) = IoControlCode;
+	if (outputMemoryLength < Params->Parameters.Ioctl.Output.Offset + outputBufferLength)
+	{
+		goto exit;
+	}
 
-				// Status
-				*(NTSTATUS*)(outputBuffer + 4) = STATUS_SUCCESS;
+	outputBuffer += Params->Parameters.Ioctl.Output.Offset;
 
-				// Needed Buffer Size
-				*(ULONG*)(outputBuffer + 8) = 0;
+	// Check the for the buffer length, which must be at least the header
+	if (outputBufferLength < SOCPARTITION_HEADER_SIZE)
+	{
+		goto exit;
+	}
 
-				// Data Size
-				*(ULONG*)(outputBuffer + 16) = sizeof(DWORD);
+	Trace(
+		TRACE_LEVEL_ERROR,
+		TRACE_INIT,
+		"OnRequestCompletionRoutine: IoControlCode: %d - Status: %d\n",
+		IoControlCode,
+		Params->IoStatus.Status);
 
-				// File Size
-				*(ULONG*)(outputBuffer + 20) = sizeof(WLAN_SAR2CFG_PROVISION);
-			}
-			else
-			{
-				// We do not support anything else currently.
-				ExFreePoolWithTag(outputBuffer, HID_DESCRIPTOR_POOL_TAG);
-				ExFreePoolWithTag(inputBuffer, HID_DESCRIPTOR_POOL_TAG);
-				goto exit;
-			}
-		}
+	PSOCPARTITION_REPLY Reply = (PSOCPARTITION_REPLY)outputBuffer;
 
-		break;
+	// Check the output buffer provided IOCTL, it must match the input.
+	if (Reply->IoControlCode != IoControlCode)
+	{
+		goto exit;
 	}
+
+	// Now check the output buffer provided return code.
+	// We will only deal with non successful codes in our filter
+	if (NT_SUCCESS(Reply->Status))
+	{
+		goto exit;
 	}
 
-	// Write out output buffer back to the output buffer for completion
-	// We are meant to modify it.
-	filterStatus = WdfMemoryCopyFromBuffer(
-		outputMemory,
-		0,
-		(PVOID)outputBuffer,
-		outputBufferLength
-	);
+	// We know that we have a non successful valid request to SOCPartition at the moment.
+	// Handle it on our own :)
 
-	if (!NT_SUCCESS(filterStatus)) {
-		Trace(
-			TRACE_LEVEL_ERROR,
-			TRACE_INIT,
-			"WdfMemoryCopyFromBuffer failed: 0x%x\n",
-			filterStatus);
+	//
+	// Built in blobs and retries of a remembered size probe are answered
+	// right here, anything reading sfpd is handed to the pipeline workers
+	// which complete the request themselves
+	//
+	if (ServeFromProbeMemo(device, requestContext, outputBuffer, outputBufferLength, &status))
+	{
+		InsertNegativeCache(device, requestContext);
+		goto exit;
+	}
 
-		ExFreePoolWithTag(outputBuffer, HID_DESCRIPTOR_POOL_TAG);
+	if (IsFileBackedRequest(device, requestContext))
+	{
+		requestContext->OutputBuffer = outputBuffer;
+		requestContext->OutputLength = outputBufferLength;
+		requestContext->Status = status;
 
-		// Free the previously allocated input buffer
-		ExFreePoolWithTag(inputBuffer, HID_DESCRIPTOR_POOL_TAG);
-		goto exit;
+		QueuePipelineRequest(device, Request);
+		return;
 	}
 
-	ExFreePoolWithTag(outputBuffer, HID_DESCRIPTOR_POOL_TAG);
-	ExFreePoolWithTag(inputBuffer, HID_DESCRIPTOR_POOL_TAG);
+	if (ServeVirtualFileRequest(device, requestContext, outputBuffer, outputBufferLength, &status))
+	{
+		// SOCPartition will keep failing this one, skip it next time
+		InsertNegativeCache(device, requestContext);
+	}
 
 exit:
 
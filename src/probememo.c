@@ -0,0 +1,224 @@
+/*++
+
+Copyright (c) 2021-2024 DuoWoA authors. All Rights Reserved.
+
+Module Name:
+
+	probememo.c
+
+Abstract:
+
+	This file contains the size probe memo functions.
+
+Environment:
+
+	Kernel-mode Driver Framework
+
+--*/
+
+#include "filter.h"
+#include "probememo.h"
+#include "socpartition.h"
+#include "sfpd.h"
+#include "sfpdcache.h"
+#include <probememo.tmh>
+
+//
+// Looked up from completion routines, so the table is non-paged and behind a
+// spinlock. Entries answer for one (IOCTL, path) and only while the sfpd
+// cache generation they were worked out under is current.
+//
+typedef struct _PROBE_MEMO
+{
+	WDFSPINLOCK Lock;
+	PROBE_MEMO_ENTRY Entries[PROBE_MEMO_SIZE];
+	ULONG Next;
+
+	LONG SizeHits;
+	LONG Misses;
+} PROBE_MEMO, * PPROBE_MEMO;
+
+WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(PROBE_MEMO, GetProbeMemo)
+
+static EVT_WDF_OBJECT_CONTEXT_CLEANUP OnProbeMemoCleanup;
+
+static VOID FreeProbeMemoEntry(PPROBE_MEMO_ENTRY Entry)
+{
+	RtlZeroMemory(Entry, sizeof(PROBE_MEMO_ENTRY));
+}
+
+NTSTATUS InitializeProbeMemo(WDFDEVICE device)
+{
+	NTSTATUS status = STATUS_UNSUCCESSFUL;
+	PPROBE_MEMO ProbeMemo = NULL;
+	WDF_OBJECT_ATTRIBUTES Attributes;
+
+	WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&Attributes, PROBE_MEMO);
+	Attributes.EvtCleanupCallback = OnProbeMemoCleanup;
+
+	status = WdfObjectAllocateContext(device, &Attributes, (PVOID*)&ProbeMemo);
+
+	if (!NT_SUCCESS(status))
+	{
+		goto exit;
+	}
+
+	WDF_OBJECT_ATTRIBUTES_INIT(&Attributes);
+	Attributes.ParentObject = device;
+
+	status = WdfSpinLockCreate(&Attributes, &ProbeMemo->Lock);
+
+exit:
+	return status;
+}
+
+static VOID OnProbeMemoCleanup(WDFOBJECT Object)
+{
+	PPROBE_MEMO ProbeMemo = GetProbeMemo(Object);
+
+	Trace(
+		TRACE_LEVEL_INFORMATION,
+		TRACE_DRIVER,
+		"Probe memo - size hits: %d, misses: %d",
+		ProbeMemo->SizeHits,
+		ProbeMemo->Misses);
+}
+
+// Must be called with the memo lock held, drops expired entries on the way
+static PPROBE_MEMO_ENTRY FindProbeMemoEntryLocked(PPROBE_MEMO ProbeMemo, DWORD IoControlCode, WCHAR Path[VIRTUAL_FILE_MAX_PATH], LONG Generation)
+{
+	ULONGLONG Now = KeQueryInterruptTime();
+	PPROBE_MEMO_ENTRY Found = NULL;
+
+	for (ULONG i = 0; i < PROBE_MEMO_SIZE; i++)
+	{
+		PPROBE_MEMO_ENTRY Entry = &ProbeMemo->Entries[i];
+
+		if (Entry->IoControlCode == 0)
+		{
+			continue;
+		}
+
+		if (Entry->Expires <= Now || Entry->Generation != Generation)
+		{
+			FreeProbeMemoEntry(Entry);
+			continue;
+		}
+
+		if (Entry->IoControlCode == IoControlCode &&
+			RtlCompareMemory(Entry->Path, Path, sizeof(Entry->Path)) == sizeof(Entry->Path))
+		{
+			Found = Entry;
+		}
+	}
+
+	return Found;
+}
+
+//
+// Answers a request from an earlier probe of the same path, as long as the
+// entry lives: the size for GetFileProperty, STATUS_BUFFER_TOO_SMALL and the
+// size needed for a read or listing whose buffer is still too small. Returns
+// FALSE, with the output untouched, when the memo can't answer, which is
+// always the case once the buffer is big enough for the data.
+//
+BOOLEAN ServeFromProbeMemo(WDFDEVICE device, PFILTER_REQUEST_CONTEXT requestContext, PUCHAR outputBuffer, ULONG outputBufferLength, NTSTATUS* RequestStatus)
+{
+	PPROBE_MEMO ProbeMemo = GetProbeMemo(device);
+	DWORD IoControlCode = requestContext->IoControlCode;
+	BOOLEAN Served = FALSE;
+
+	switch (IoControlCode)
+	{
+	case IOCTL_SOCPARTITION_READ_FILE:
+		break;
+	case IOCTL_SOCPARTITION_LIST_DIRECTORY_FILES:
+		if (requestContext->FileSystemProperty != SOCPARTITION_FILE_SYSTEM_PROPERTY_LISTING)
+		{
+			return FALSE;
+		}
+		break;
+	case IOCTL_SOCPARTITION_GET_FILE_PROPERTY:
+		if (requestContext->FileProperty != SOCPARTITION_FILE_PROPERTY_SIZE || outputBufferLength < SOCPARTITION_HEADER_SIZE + sizeof(DWORD))
+		{
+			return FALSE;
+		}
+		break;
+	default:
+		return FALSE;
+	}
+
+	LONG Generation = GetSFPDCacheGeneration(device);
+
+	WdfSpinLockAcquire(ProbeMemo->Lock);
+
+	PPROBE_MEMO_ENTRY Entry = FindProbeMemoEntryLocked(ProbeMemo, IoControlCode, requestContext->Path, Generation);
+
+	if (Entry == NULL)
+	{
+		goto exit;
+	}
+
+	if (IoControlCode == IOCTL_SOCPARTITION_GET_FILE_PROPERTY)
+	{
+		*RequestStatus = STATUS_SUCCESS;
+
+		// File Size
+		*(ULONG*)GetSOCPartitionReplyData(outputBuffer) = Entry->Size;
+
+		FinishSOCPartitionReply(outputBuffer, outputBufferLength, IoControlCode, STATUS_SUCCESS, 0, sizeof(DWORD));
+
+		InterlockedIncrement(&ProbeMemo->SizeHits);
+		Served = TRUE;
+	}
+	else if (outputBufferLength < Entry->Headroom || outputBufferLength - Entry->Headroom < Entry->Size)
+	{
+		*RequestStatus = Entry->TooSmallStatus;
+
+		FinishSOCPartitionReply(outputBuffer, outputBufferLength, IoControlCode, STATUS_BUFFER_TOO_SMALL, Entry->Size, 0);
+
+		InterlockedIncrement(&ProbeMemo->SizeHits);
+		Served = TRUE;
+	}
+
+exit:
+	if (!Served)
+	{
+		InterlockedIncrement(&ProbeMemo->Misses);
+	}
+
+	WdfSpinLockRelease(ProbeMemo->Lock);
+
+	return Served;
+}
+
+//
+// Remembers the data size answering a request worked out. FilePath is the
+// parsed path of the request context, already zero filled.
+//
+VOID RecordProbeMemo(WDFDEVICE device, DWORD IoControlCode, PWCHAR FilePath, LONG Generation, DWORD Size, ULONG Headroom, NTSTATUS TooSmallStatus)
+{
+	PPROBE_MEMO ProbeMemo = GetProbeMemo(device);
+
+	WdfSpinLockAcquire(ProbeMemo->Lock);
+
+	PPROBE_MEMO_ENTRY Entry = FindProbeMemoEntryLocked(ProbeMemo, IoControlCode, FilePath, Generation);
+
+	if (Entry == NULL)
+	{
+		Entry = &ProbeMemo->Entries[ProbeMemo->Next];
+		ProbeMemo->Next = (ProbeMemo->Next + 1) % PROBE_MEMO_SIZE;
+	}
+
+	FreeProbeMemoEntry(Entry);
+
+	Entry->IoControlCode = IoControlCode;
+	RtlCopyMemory(Entry->Path, FilePath, sizeof(Entry->Path));
+	Entry->Generation = Generation;
+	Entry->Expires = KeQueryInterruptTime() + MILLISECONDS(PROBE_MEMO_LIFETIME_MS);
+	Entry->Size = Size;
+	Entry->Headroom = Headroom;
+	Entry->TooSmallStatus = TooSmallStatus;
+
+	WdfSpinLockRelease(ProbeMemo->Lock);
+}
@@ -17,6 +17,10 @@ Environment:
 --*/
 
 #include "sfpd.h"
+#include "vfile.h"
+#include <wdmguid.h>
+#include <trace.h>
+#include <sfpd.tmh>
 
 // ntifs header is incompatible with wdm header...
 
@@ -40,7 +44,7 @@ ZwQueryDirectoryFile(
 );
 #endif
 
-typedef struct _FILE_BOTH_DIR_INFORMATION {
+typedef struct _FILE_DIRECTORY_INFORMATION {
 	ULONG NextEntryOffset;
 	ULONG FileIndex;
 	LARGE_INTEGER CreationTime;
@@ -51,473 +55,625 @@ typedef struct _FILE_BOTH_DIR_INFORMATION {
 	LARGE_INTEGER AllocationSize;
 	ULONG FileAttributes;
 	ULONG FileNameLength;
-	ULONG EaSize;
-	CCHAR ShortNameLength;
-	WCHAR ShortName[12];
 	_Field_size_bytes_(FileNameLength) WCHAR FileName[1];
-} FILE_BOTH_DIR_INFORMATION, * PFILE_BOTH_DIR_INFORMATION;
+} FILE_DIRECTORY_INFORMATION, * PFILE_DIRECTORY_INFORMATION;
 
 // end of workaround for ntifs
 
-NTSTATUS GetSFPDPixelAlignmentData(WDFDEVICE device, PSFPD_DISPLAY_PIXEL_ALIGNMENT_DATA PixelAlignmentData)
+static NTSTATUS ScanSFPDVolumePath(WDFDEVICE device, WCHAR* VolumePath, DWORD VolumePathLength);
+static EVT_WDF_WORKITEM OnSFPDDiscoveryWorkItem;
+static EVT_WDF_TIMER OnSFPDHandleCacheTimer;
+static DRIVER_NOTIFICATION_CALLBACK_ROUTINE OnSFPDInterfaceChange;
+
+NTSTATUS InitializeSFPDDeviceContext(WDFDEVICE device)
 {
 	NTSTATUS status = STATUS_UNSUCCESSFUL;
+	PSFPD_DEVICE_CONTEXT SFPDContext = NULL;
+	WDF_OBJECT_ATTRIBUTES Attributes;
 
-	if (PixelAlignmentData == NULL)
+	WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&Attributes, SFPD_DEVICE_CONTEXT);
+
+	status = WdfObjectAllocateContext(device, &Attributes, (PVOID*)&SFPDContext);
+
+	if (!NT_SUCCESS(status))
 	{
-		status = STATUS_INVALID_PARAMETER;
 		goto exit;
 	}
 
-	DWORD PixelAlignmentDataSize = sizeof(SFPD_DISPLAY_PIXEL_ALIGNMENT_DATA);
-	DWORD ActualSFPDFileSize = 0;
+	WDF_OBJECT_ATTRIBUTES_INIT(&Attributes);
+	Attributes.ParentObject = device;
 
-	status = GetSFPDItemSize(device, PIXEL_ALIGNMENT_DATA_FILE_PATH, &ActualSFPDFileSize);
+	status = WdfSpinLockCreate(&Attributes, &SFPDContext->VolumePathLock);
 
 	if (!NT_SUCCESS(status))
 	{
 		goto exit;
 	}
 
-	if (PixelAlignmentDataSize != ActualSFPDFileSize)
-	{
-		status = STATUS_FILE_CORRUPT_ERROR;
-		goto exit;
-	}
+	WDF_WORKITEM_CONFIG WorkItemConfig;
+	WDF_WORKITEM_CONFIG_INIT(&WorkItemConfig, OnSFPDDiscoveryWorkItem);
+
+	WDF_OBJECT_ATTRIBUTES_INIT(&Attributes);
+	Attributes.ParentObject = device;
 
-	status = GetSFPDItem(device, PIXEL_ALIGNMENT_DATA_FILE_PATH, PixelAlignmentData, PixelAlignmentDataSize);
+	status = WdfWorkItemCreate(&WorkItemConfig, &Attributes, &SFPDContext->DiscoveryWorkItem);
 
 	if (!NT_SUCCESS(status))
 	{
 		goto exit;
 	}
 
-exit:
-	return status;
-}
+	// Signaled whenever no discovery pass is queued or running
+	KeInitializeEvent(&SFPDContext->DiscoveryIdleEvent, NotificationEvent, TRUE);
 
-NTSTATUS GetSFPDItem(WDFDEVICE device, WCHAR* ItemPath, PVOID Data, DWORD DataSize)
-{
-	NTSTATUS status = STATUS_UNSUCCESSFUL;
-	WCHAR* FilePath = NULL;
-	HANDLE FileHandle = NULL;
+	WDF_OBJECT_ATTRIBUTES_INIT(&Attributes);
+	Attributes.ParentObject = device;
 
-	if (Data == NULL || DataSize == 0 || ItemPath == NULL)
+	status = WdfWaitLockCreate(&Attributes, &SFPDContext->HandleCacheLock);
+
+	if (!NT_SUCCESS(status))
 	{
-		status = STATUS_INVALID_PARAMETER;
 		goto exit;
 	}
 
-	FilePath = (WCHAR*)ExAllocatePoolWithTag(NonPagedPool, MAX_PATH * sizeof(WCHAR), POOL_TAG_FILEPATH);
+	WDF_TIMER_CONFIG TimerConfig;
+	WDF_TIMER_CONFIG_INIT(&TimerConfig, OnSFPDHandleCacheTimer);
+	TimerConfig.AutomaticSerialization = FALSE;
+
+	// Closing handles needs PASSIVE_LEVEL
+	WDF_OBJECT_ATTRIBUTES_INIT(&Attributes);
+	Attributes.ParentObject = device;
+	Attributes.ExecutionLevel = WdfExecutionLevelPassive;
 
-	if (FilePath == NULL)
+	status = WdfTimerCreate(&TimerConfig, &Attributes, &SFPDContext->HandleCacheTimer);
+
+	if (!NT_SUCCESS(status))
 	{
-		status = STATUS_INSUFFICIENT_RESOURCES;
 		goto exit;
 	}
 
-	status = GetSFPDVolumePath(device, FilePath, MAX_PATH);
+	status = InitializeSFPDContentCache(device);
 
 	if (!NT_SUCCESS(status))
 	{
-		status = STATUS_NOT_FOUND;
 		goto exit;
 	}
 
-	status = RtlStringCbCatW(FilePath, MAX_PATH * sizeof(WCHAR), ItemPath);
+	WDF_OBJECT_ATTRIBUTES_INIT(&Attributes);
+	Attributes.ParentObject = device;
+
+	status = WdfWaitLockCreate(&Attributes, &SFPDContext->ReadFlightLock);
 
 	if (!NT_SUCCESS(status))
 	{
-		status = STATUS_INSUFFICIENT_RESOURCES;
 		goto exit;
 	}
 
-	UNICODE_STRING FilePathUnicode;
-	RtlInitUnicodeString(&FilePathUnicode, FilePath);
-
-	OBJECT_ATTRIBUTES Attributes = { 0 };
-	InitializeObjectAttributes(&Attributes, &FilePathUnicode, OBJ_CASE_INSENSITIVE | OBJ_KERNEL_HANDLE, NULL, NULL);
+	InitializeListHead(&SFPDContext->ReadFlights);
 
-	IO_STATUS_BLOCK IOStatusBlock = { 0 };
+	WDF_OBJECT_ATTRIBUTES_INIT(&Attributes);
+	Attributes.ParentObject = device;
 
-	status = ZwCreateFile(&FileHandle, GENERIC_READ, &Attributes, &IOStatusBlock, NULL, FILE_ATTRIBUTE_NORMAL, 0, FILE_OPEN, FILE_SYNCHRONOUS_IO_NONALERT, NULL, 0);
+	status = WdfLookasideListCreate(&Attributes, MAX_PATH * sizeof(WCHAR), NonPagedPoolNx, WDF_NO_OBJECT_ATTRIBUTES, POOL_TAG_FILEPATH, &SFPDContext->PathLookaside);
 
 	if (!NT_SUCCESS(status))
 	{
-		status = STATUS_FILE_INVALID;
 		goto exit;
 	}
 
-	status = ZwReadFile(FileHandle, NULL, NULL, NULL, &IOStatusBlock, Data, DataSize, NULL, NULL);
+	WDF_OBJECT_ATTRIBUTES_INIT(&Attributes);
+	Attributes.ParentObject = device;
+
+	status = WdfLookasideListCreate(&Attributes, SFPD_ENUMERATION_BUFFER_SIZE, PagedPool, WDF_NO_OBJECT_ATTRIBUTES, POOL_TAG_FILEPATH, &SFPDContext->EnumerationLookaside);
 
 	if (!NT_SUCCESS(status))
 	{
-		status = STATUS_FILE_INVALID;
 		goto exit;
 	}
 
 exit:
+	return status;
+}
+
+//
+// Hands out a scratch buffer from the per-device lookaside lists, which the
+// system sizes by how often they miss. ScratchHighWater records the most
+// buffers ever out at once. Every buffer goes back through FreeSFPDScratch.
+//
+PVOID AllocateSFPDScratch(WDFDEVICE device, SFPD_SCRATCH_KIND Kind, WDFMEMORY* Memory)
+{
+	PSFPD_DEVICE_CONTEXT SFPDContext = GetSFPDDeviceContext(device);
+	WDFLOOKASIDE Lookaside = Kind == SFPDScratchPath ? SFPDContext->PathLookaside : SFPDContext->EnumerationLookaside;
+
+	*Memory = NULL;
 
-	if (NULL != FilePath)
+	if (!NT_SUCCESS(WdfMemoryCreateFromLookaside(Lookaside, Memory)))
 	{
-		ExFreePool(FilePath);
+		*Memory = NULL;
+		return NULL;
 	}
 
-	if (NULL != FileHandle)
+	LONG InUse = InterlockedIncrement(&SFPDContext->ScratchInUse);
+	LONG HighWater = SFPDContext->ScratchHighWater;
+
+	while (InUse > HighWater)
 	{
-		ZwClose(FileHandle);
+		LONG Previous = InterlockedCompareExchange(&SFPDContext->ScratchHighWater, InUse, HighWater);
+
+		if (Previous == HighWater)
+		{
+			Trace(
+				TRACE_LEVEL_INFORMATION,
+				TRACE_DRIVER,
+				"SFPD scratch buffers in use peaked at %d",
+				InUse);
+
+			break;
+		}
+
+		HighWater = Previous;
 	}
 
-	return status;
+	return WdfMemoryGetBuffer(*Memory, NULL);
 }
 
-NTSTATUS GetSFPDNumberOfFilesInDirectory(WDFDEVICE device, WCHAR* DirectoryPath, DWORD* NumberOfFiles)
+VOID FreeSFPDScratch(WDFDEVICE device, WDFMEMORY Memory)
 {
-	NTSTATUS status = STATUS_UNSUCCESSFUL;
+	PSFPD_DEVICE_CONTEXT SFPDContext = GetSFPDDeviceContext(device);
 
-	BOOLEAN bIsStarted = TRUE;
-	UINT uSize = sizeof(FILE_BOTH_DIR_INFORMATION);
-	FILE_BOTH_DIR_INFORMATION* pfbInfo = NULL;
+	WdfObjectDelete(Memory);
+	InterlockedDecrement(&SFPDContext->ScratchInUse);
+}
 
-	HANDLE FileHandle = NULL;
-	WCHAR* FilePath = (WCHAR*)ExAllocatePoolWithTag(NonPagedPool, MAX_PATH * sizeof(WCHAR), POOL_TAG_FILEPATH);
+VOID InvalidateSFPDVolumePath(WDFDEVICE device)
+{
+	PSFPD_DEVICE_CONTEXT SFPDContext = GetSFPDDeviceContext(device);
+
+	WdfSpinLockAcquire(SFPDContext->VolumePathLock);
+	SFPDContext->VolumePathValid = FALSE;
+	WdfSpinLockRelease(SFPDContext->VolumePathLock);
+
+	// Handles are relative to the old root, drop them on the next cache access.
+	// Closing them here could block PnP notifications behind an in-progress open.
+	InterlockedExchange(&SFPDContext->HandleCacheStale, TRUE);
+	InterlockedExchange(&SFPDContext->ContentCacheStale, TRUE);
+
+	Trace(
+		TRACE_LEVEL_INFORMATION,
+		TRACE_DRIVER,
+		"SFPD volume path invalidated - hits: %d, misses: %d",
+		SFPDContext->VolumePathCacheHits,
+		SFPDContext->VolumePathCacheMisses);
+}
 
-	if (NULL == FilePath)
-	{
-		status = STATUS_INSUFFICIENT_RESOURCES;
-		goto exit;
-	}
+// Status codes meaning the cached volume path no longer points at a live partition
+static BOOLEAN IsSFPDVolumeGoneStatus(NTSTATUS status)
+{
+	return status == STATUS_OBJECT_PATH_NOT_FOUND ||
+		status == STATUS_NO_SUCH_DEVICE ||
+		status == STATUS_DEVICE_NOT_CONNECTED ||
+		status == STATUS_VOLUME_DISMOUNTED;
+}
 
-	if (NULL == NumberOfFiles)
+static BOOLEAN IsSFPDPathEqual(WCHAR* Path1, WCHAR* Path2)
+{
+	UNICODE_STRING Path1Unicode;
+	UNICODE_STRING Path2Unicode;
+
+	RtlInitUnicodeString(&Path1Unicode, Path1);
+	RtlInitUnicodeString(&Path2Unicode, Path2);
+
+	return RtlEqualUnicodeString(&Path1Unicode, &Path2Unicode, TRUE);
+}
+
+// Must be called with HandleCacheLock held. Entries still referenced are only
+// detached, ReleaseSFPDHandle closes them once their holder is done.
+static VOID CloseSFPDHandlesLocked(PSFPD_DEVICE_CONTEXT SFPDContext, BOOLEAN IdleOnly)
+{
+	ULONGLONG CurrentTime = KeQueryInterruptTime();
+
+	for (DWORD i = 0; i < SFPD_HANDLE_CACHE_SIZE; i++)
 	{
-		status = STATUS_INSUFFICIENT_RESOURCES;
-		goto exit;
-	}
+		PSFPD_HANDLE_CACHE_ENTRY Entry = &SFPDContext->HandleCache[i];
 
-	*NumberOfFiles = 0;
+		if (Entry->Handle == NULL)
+		{
+			continue;
+		}
 
-	status = GetSFPDVolumePath(device, FilePath, MAX_PATH);
+		if (IdleOnly && (Entry->RefCount != 0 || CurrentTime - Entry->LastUsed < (ULONGLONG)MILLISECONDS(SFPD_HANDLE_IDLE_TIMEOUT_MS)))
+		{
+			continue;
+		}
 
-	if (!NT_SUCCESS(status))
+		if (Entry->RefCount == 0)
+		{
+			ZwClose(Entry->Handle);
+		}
+
+		RtlZeroMemory(Entry, sizeof(SFPD_HANDLE_CACHE_ENTRY));
+	}
+
+	if (!IdleOnly && SFPDContext->RootHandle != NULL)
 	{
-		status = STATUS_NOT_FOUND;
-		goto exit;
+		ZwClose(SFPDContext->RootHandle);
+		SFPDContext->RootHandle = NULL;
 	}
+}
 
-	status = RtlStringCbCatW(FilePath, MAX_PATH * sizeof(WCHAR), DirectoryPath);
+// Must be called with HandleCacheLock held. VolumePath is only needed, and
+// must be resolved beforehand, when the root isn't open yet.
+static NTSTATUS OpenSFPDRootLocked(PSFPD_DEVICE_CONTEXT SFPDContext, WCHAR* VolumePath)
+{
+	NTSTATUS status = STATUS_UNSUCCESSFUL;
 
-	if (!NT_SUCCESS(status))
+	if (SFPDContext->RootHandle != NULL)
 	{
-		status = STATUS_INSUFFICIENT_RESOURCES;
+		status = STATUS_SUCCESS;
 		goto exit;
 	}
 
-	UNICODE_STRING FilePathUnicode;
-	RtlInitUnicodeString(&FilePathUnicode, FilePath);
+	UNICODE_STRING VolumePathUnicode;
+	RtlInitUnicodeString(&VolumePathUnicode, VolumePath);
 
 	OBJECT_ATTRIBUTES Attributes = { 0 };
-	InitializeObjectAttributes(&Attributes, &FilePathUnicode, OBJ_CASE_INSENSITIVE | OBJ_KERNEL_HANDLE, NULL, NULL);
+	InitializeObjectAttributes(&Attributes, &VolumePathUnicode, OBJ_CASE_INSENSITIVE | OBJ_KERNEL_HANDLE, NULL, NULL);
 
 	IO_STATUS_BLOCK IOStatusBlock = { 0 };
 
-	status = ZwCreateFile(&FileHandle, GENERIC_READ | SYNCHRONIZE, &Attributes, &IOStatusBlock, NULL, FILE_ATTRIBUTE_NORMAL, FILE_SHARE_READ, FILE_OPEN, FILE_SYNCHRONOUS_IO_NONALERT, NULL, 0);
+	status = ZwCreateFile(&SFPDContext->RootHandle, FILE_LIST_DIRECTORY | FILE_TRAVERSE | SYNCHRONIZE, &Attributes, &IOStatusBlock, NULL, FILE_ATTRIBUTE_NORMAL, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, FILE_OPEN, FILE_DIRECTORY_FILE | FILE_SYNCHRONOUS_IO_NONALERT, NULL, 0);
+
 	if (!NT_SUCCESS(status))
 	{
-		status = STATUS_FILE_NOT_AVAILABLE;
+		SFPDContext->RootHandle = NULL;
 		goto exit;
 	}
 
-	//
-	// https://community.osr.com/t/zwquerydirectoryfile-api-question-enumerating-files-in-a-directory-or-in-a-volumes/31914/3
-	//
+exit:
+	return status;
+}
+
+//
+// Returns a handle to an sfpd item, from the per-device handle cache when possible.
+// File handles are shared between callers, so reads must always pass an explicit
+// offset. Directory handles carry the enumeration position and are only handed out
+// to one caller at a time. Every acquired handle goes back through ReleaseSFPDHandle.
+//
+static NTSTATUS AcquireSFPDHandle(WDFDEVICE device, WCHAR* ItemPath, BOOLEAN Directory, PHANDLE FileHandle)
+{
+	NTSTATUS status = STATUS_UNSUCCESSFUL;
+	PSFPD_DEVICE_CONTEXT SFPDContext = GetSFPDDeviceContext(device);
+	PSFPD_HANDLE_CACHE_ENTRY CacheSlot = NULL;
+	BOOLEAN CacheResult = TRUE;
+	BOOLEAN Retried = FALSE;
+	WDFMEMORY VolumePathMemory = NULL;
+	WCHAR* VolumePath = NULL;
+	BOOLEAN VolumePathResolved = FALSE;
+
+	*FileHandle = NULL;
+
+	// Items are opened relative to the sfpd root
+	if (ItemPath == NULL || ItemPath[0] != L'\\')
+	{
+		return STATUS_INVALID_PARAMETER;
+	}
+
+	WdfWaitLockAcquire(SFPDContext->HandleCacheLock, NULL);
 
-	pfbInfo = ExAllocatePoolWithTag(PagedPool, uSize, '0000');
+lookup:
+	CacheSlot = NULL;
+	CacheResult = TRUE;
 
-	if (pfbInfo == NULL)
+	if (InterlockedExchange(&SFPDContext->HandleCacheStale, FALSE))
 	{
-		status = STATUS_NO_MEMORY;
-		goto exit;
+		CloseSFPDHandlesLocked(SFPDContext, FALSE);
 	}
 
-	while (TRUE)
+	for (DWORD i = 0; i < SFPD_HANDLE_CACHE_SIZE; i++)
 	{
-	lbl_retry:
-		RtlZeroMemory(pfbInfo, uSize);
-		status = ZwQueryDirectoryFile(FileHandle, 0, NULL, NULL, &IOStatusBlock, pfbInfo,
-			uSize, FileBothDirectoryInformation, FALSE, NULL, bIsStarted);
+		PSFPD_HANDLE_CACHE_ENTRY Entry = &SFPDContext->HandleCache[i];
 
-		if (STATUS_BUFFER_OVERFLOW == status)
+		if (Entry->Handle == NULL)
 		{
-			ExFreePool(pfbInfo);
-
-			uSize = uSize * 2;
-			pfbInfo = ExAllocatePoolWithTag(PagedPool, uSize, '0000');
-
-			if (pfbInfo == NULL)
+			if (CacheSlot == NULL || CacheSlot->Handle != NULL)
 			{
-				status = STATUS_NO_MEMORY;
-				goto exit;
+				CacheSlot = Entry;
 			}
 
-			goto lbl_retry;
+			continue;
 		}
-		else if (STATUS_NO_MORE_FILES == status)
+
+		if (Entry->Directory == Directory && IsSFPDPathEqual(Entry->Path, ItemPath))
 		{
+			if (Directory && Entry->RefCount != 0)
+			{
+				// Someone is walking this directory, give this caller its own handle
+				CacheResult = FALSE;
+				continue;
+			}
+
+			Entry->RefCount++;
+			Entry->LastUsed = KeQueryInterruptTime();
+			*FileHandle = Entry->Handle;
+
+			InterlockedIncrement(&SFPDContext->OpensAvoided);
+
 			status = STATUS_SUCCESS;
 			goto exit;
 		}
-		else if (STATUS_SUCCESS != status)
+
+		// Least recently used idle entry, in case there is no free slot
+		if (Entry->RefCount == 0 && (CacheSlot == NULL || (CacheSlot->Handle != NULL && Entry->LastUsed < CacheSlot->LastUsed)))
 		{
-			goto exit;
+			CacheSlot = Entry;
 		}
+	}
 
-		if (bIsStarted)
+retry:
+	if (SFPDContext->RootHandle == NULL && !VolumePathResolved)
+	{
+		//
+		// Finding the volume may wait seconds for discovery, every other sfpd
+		// reader would wait along if the lock stayed held. Someone else may
+		// open the root or this very item meanwhile, so look again after.
+		//
+		WdfWaitLockRelease(SFPDContext->HandleCacheLock);
+
+		if (VolumePath == NULL)
 		{
-			bIsStarted = FALSE;
+			VolumePath = (WCHAR*)AllocateSFPDScratch(device, SFPDScratchPath, &VolumePathMemory);
 		}
 
-		while (TRUE)
+		if (VolumePath == NULL)
 		{
-			// We do not want to touch directories
-			if ((pfbInfo->FileAttributes & FILE_ATTRIBUTE_DIRECTORY) != FILE_ATTRIBUTE_DIRECTORY)
-			{
-				*NumberOfFiles = *NumberOfFiles + 1;
-			}
+			status = STATUS_INSUFFICIENT_RESOURCES;
+		}
+		else if (!NT_SUCCESS(GetSFPDVolumePath(device, VolumePath, MAX_PATH)))
+		{
+			status = STATUS_NOT_FOUND;
+		}
+		else
+		{
+			status = STATUS_SUCCESS;
+			VolumePathResolved = TRUE;
+		}
 
-			if (pfbInfo->NextEntryOffset == 0)
-			{
-				break;
-			}
+		WdfWaitLockAcquire(SFPDContext->HandleCacheLock, NULL);
 
-			pfbInfo += pfbInfo->NextEntryOffset;
+		if (!NT_SUCCESS(status))
+		{
+			goto exit;
 		}
-	}
 
-exit:
-	if (pfbInfo != NULL)
-	{
-		ExFreePool(pfbInfo);
+		goto lookup;
 	}
 
-	if (FilePath != NULL)
-	{
-		ExFreePool(FilePath);
-	}
+	status = OpenSFPDRootLocked(SFPDContext, VolumePath);
 
-	if (FileHandle != NULL)
+	if (!NT_SUCCESS(status))
 	{
-		ZwClose(FileHandle);
+		goto exit;
 	}
 
-	return status;
-}
+	UNICODE_STRING RelativePathUnicode;
+	RtlInitUnicodeString(&RelativePathUnicode, ItemPath + 1);
 
-// This function is very specifically crafted for SOCPartition, I know.
-NTSTATUS GetSFPDFilesInDirectory(WDFDEVICE device, WCHAR* DirectoryPath, DWORD NumberOfFiles, PUCHAR Buffer)
-{
-	NTSTATUS status = STATUS_UNSUCCESSFUL;
+	OBJECT_ATTRIBUTES Attributes = { 0 };
+	InitializeObjectAttributes(&Attributes, &RelativePathUnicode, OBJ_CASE_INSENSITIVE | OBJ_KERNEL_HANDLE, SFPDContext->RootHandle, NULL);
 
-	BOOLEAN bIsStarted = TRUE;
-	UINT uSize = sizeof(FILE_BOTH_DIR_INFORMATION);
-	FILE_BOTH_DIR_INFORMATION* pfbInfo = NULL;
+	IO_STATUS_BLOCK IOStatusBlock = { 0 };
 
-	HANDLE FileHandle = NULL;
-	WCHAR* FilePath = (WCHAR*)ExAllocatePoolWithTag(NonPagedPool, MAX_PATH * sizeof(WCHAR), POOL_TAG_FILEPATH);
+	status = ZwCreateFile(
+		FileHandle,
+		Directory ? (FILE_LIST_DIRECTORY | SYNCHRONIZE) : GENERIC_READ,
+		&Attributes,
+		&IOStatusBlock,
+		NULL,
+		FILE_ATTRIBUTE_NORMAL,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		FILE_OPEN,
+		FILE_SYNCHRONOUS_IO_NONALERT | (Directory ? FILE_DIRECTORY_FILE : FILE_NON_DIRECTORY_FILE),
+		NULL,
+		0);
 
-	if (NULL == FilePath)
+	if (!NT_SUCCESS(status))
 	{
-		status = STATUS_INSUFFICIENT_RESOURCES;
-		goto exit;
-	}
+		*FileHandle = NULL;
 
-	status = GetSFPDVolumePath(device, FilePath, MAX_PATH);
+		// The partition went away or moved since we cached its location, look it up again once
+		if (!Retried && IsSFPDVolumeGoneStatus(status))
+		{
+			WdfSpinLockAcquire(SFPDContext->VolumePathLock);
+			SFPDContext->VolumePathValid = FALSE;
+			WdfSpinLockRelease(SFPDContext->VolumePathLock);
 
-	if (!NT_SUCCESS(status))
-	{
-		status = STATUS_NOT_FOUND;
+			CloseSFPDHandlesLocked(SFPDContext, FALSE);
+
+			Retried = TRUE;
+			VolumePathResolved = FALSE;
+			goto retry;
+		}
+
+		status = STATUS_FILE_NOT_AVAILABLE;
 		goto exit;
 	}
 
-	status = RtlStringCbCatW(FilePath, MAX_PATH * sizeof(WCHAR), DirectoryPath);
+	InterlockedIncrement(&SFPDContext->OpensPerformed);
 
-	if (!NT_SUCCESS(status))
+	if (!CacheResult || CacheSlot == NULL)
 	{
-		status = STATUS_INSUFFICIENT_RESOURCES;
 		goto exit;
 	}
 
-	UNICODE_STRING FilePathUnicode;
-	RtlInitUnicodeString(&FilePathUnicode, FilePath);
-
-	OBJECT_ATTRIBUTES Attributes = { 0 };
-	InitializeObjectAttributes(&Attributes, &FilePathUnicode, OBJ_CASE_INSENSITIVE | OBJ_KERNEL_HANDLE, NULL, NULL);
-
-	IO_STATUS_BLOCK IOStatusBlock = { 0 };
+	if (CacheSlot->Handle != NULL)
+	{
+		ZwClose(CacheSlot->Handle);
+		RtlZeroMemory(CacheSlot, sizeof(SFPD_HANDLE_CACHE_ENTRY));
+	}
 
-	status = ZwCreateFile(&FileHandle, GENERIC_READ | SYNCHRONIZE, &Attributes, &IOStatusBlock, NULL, FILE_ATTRIBUTE_NORMAL, FILE_SHARE_READ, FILE_OPEN, FILE_SYNCHRONOUS_IO_NONALERT, NULL, 0);
-	if (!NT_SUCCESS(status))
+	if (!NT_SUCCESS(RtlStringCchCopyW(CacheSlot->Path, MAX_PATH, ItemPath)))
 	{
-		status = STATUS_FILE_NOT_AVAILABLE;
 		goto exit;
 	}
 
-	//
-	// https://community.osr.com/t/zwquerydirectoryfile-api-question-enumerating-files-in-a-directory-or-in-a-volumes/31914/3
-	//
-
-	pfbInfo = ExAllocatePoolWithTag(PagedPool, uSize, '0000');
+	CacheSlot->Handle = *FileHandle;
+	CacheSlot->Directory = Directory;
+	CacheSlot->RefCount = 1;
+	CacheSlot->LastUsed = KeQueryInterruptTime();
 
-	if (pfbInfo == NULL)
+	if (!SFPDContext->HandleCacheTimerArmed)
 	{
-		status = STATUS_NO_MEMORY;
-		goto exit;
+		SFPDContext->HandleCacheTimerArmed = TRUE;
+		WdfTimerStart(SFPDContext->HandleCacheTimer, WDF_REL_TIMEOUT_IN_MS(SFPD_HANDLE_IDLE_TIMEOUT_MS));
 	}
 
-	DWORD CurrentNumberOfFiles = 0;
-	DWORD CurrentFileAllocation = 0;
+exit:
+	WdfWaitLockRelease(SFPDContext->HandleCacheLock);
 
-	while (TRUE)
+	if (VolumePathMemory != NULL)
 	{
-	lbl_retry:
-		RtlZeroMemory(pfbInfo, uSize);
-		status = ZwQueryDirectoryFile(FileHandle, 0, NULL, NULL, &IOStatusBlock, pfbInfo,
-			uSize, FileBothDirectoryInformation, FALSE, NULL, bIsStarted);
-
-		if (STATUS_BUFFER_OVERFLOW == status)
-		{
-			ExFreePool(pfbInfo);
+		FreeSFPDScratch(device, VolumePathMemory);
+	}
 
-			uSize = uSize * 2;
-			pfbInfo = ExAllocatePoolWithTag(PagedPool, uSize, '0000');
+	return status;
+}
 
-			if (pfbInfo == NULL)
-			{
-				status = STATUS_NO_MEMORY;
-				goto exit;
-			}
+static VOID ReleaseSFPDHandle(WDFDEVICE device, HANDLE FileHandle)
+{
+	PSFPD_DEVICE_CONTEXT SFPDContext = GetSFPDDeviceContext(device);
+	BOOLEAN Cached = FALSE;
 
-			goto lbl_retry;
-		}
-		else if (STATUS_NO_MORE_FILES == status)
-		{
-			status = STATUS_SUCCESS;
-			goto exit;
-		}
-		else if (STATUS_SUCCESS != status)
-		{
-			goto exit;
-		}
+	WdfWaitLockAcquire(SFPDContext->HandleCacheLock, NULL);
 
-		if (bIsStarted)
-		{
-			bIsStarted = FALSE;
-		}
+	for (DWORD i = 0; i < SFPD_HANDLE_CACHE_SIZE; i++)
+	{
+		PSFPD_HANDLE_CACHE_ENTRY Entry = &SFPDContext->HandleCache[i];
 
-		while (TRUE)
+		if (Entry->Handle == FileHandle)
 		{
-			// We do not want to touch directories
-			if ((pfbInfo->FileAttributes & FILE_ATTRIBUTE_DIRECTORY) != FILE_ATTRIBUTE_DIRECTORY)
-			{
-				CurrentNumberOfFiles++;
-				if (CurrentNumberOfFiles > NumberOfFiles)
-				{
-					status = STATUS_NO_MEMORY;
-					goto exit;
-				}
+			Entry->RefCount--;
+			Entry->LastUsed = KeQueryInterruptTime();
 
-				PUCHAR FileBlockBuffer = Buffer + (CurrentNumberOfFiles - 1) * 244;
-
-				RtlCopyMemory(FileBlockBuffer, pfbInfo->FileName, min(pfbInfo->FileNameLength, 49 * sizeof(WCHAR)));
-				RtlCopyMemory(FileBlockBuffer + (49 * sizeof(WCHAR)), L"JSON", sizeof(L"JSON"));
+			Cached = TRUE;
+			break;
+		}
+	}
 
-				DWORD FileSize = pfbInfo->EndOfFile.LowPart;
-				DWORD FileAllocation = FileSize;
+	WdfWaitLockRelease(SFPDContext->HandleCacheLock);
 
-				if ((FileSize % 256) != 0)
-				{
-					FileAllocation = FileSize + (256 - (FileSize % 256));
-				}
+	if (!Cached)
+	{
+		ZwClose(FileHandle);
+	}
+}
 
-				*(DWORD*)(FileBlockBuffer + (49 * sizeof(WCHAR)) + (49 * sizeof(WCHAR))) = FileAllocation; // File Allocation
-				*(DWORD*)(FileBlockBuffer + (49 * sizeof(WCHAR)) + (49 * sizeof(WCHAR)) + 4) = FileSize; // FileSize
-				*(DWORD*)(FileBlockBuffer + (49 * sizeof(WCHAR)) + (49 * sizeof(WCHAR)) + 4 + 4) = 1; // ?, always one
-				*(DWORD*)(FileBlockBuffer + (49 * sizeof(WCHAR)) + (49 * sizeof(WCHAR)) + 4 + 4 + 4) = CurrentFileAllocation; // Offset
+static VOID OnSFPDHandleCacheTimer(WDFTIMER Timer)
+{
+	WDFDEVICE device = (WDFDEVICE)WdfTimerGetParentObject(Timer);
+	PSFPD_DEVICE_CONTEXT SFPDContext = GetSFPDDeviceContext(device);
+	BOOLEAN HandlesLeft = FALSE;
 
-				CurrentFileAllocation += FileAllocation;
-			}
+	WdfWaitLockAcquire(SFPDContext->HandleCacheLock, NULL);
 
-			if (pfbInfo->NextEntryOffset == 0)
-			{
-				break;
-			}
+	CloseSFPDHandlesLocked(SFPDContext, TRUE);
 
-			pfbInfo += pfbInfo->NextEntryOffset;
+	for (DWORD i = 0; i < SFPD_HANDLE_CACHE_SIZE; i++)
+	{
+		if (SFPDContext->HandleCache[i].Handle != NULL)
+		{
+			HandlesLeft = TRUE;
+			break;
 		}
 	}
 
-exit:
-	if (pfbInfo != NULL)
-	{
-		ExFreePool(pfbInfo);
-	}
+	SFPDContext->HandleCacheTimerArmed = HandlesLeft;
 
-	if (FilePath != NULL)
+	if (HandlesLeft)
 	{
-		ExFreePool(FilePath);
+		WdfTimerStart(SFPDContext->HandleCacheTimer, WDF_REL_TIMEOUT_IN_MS(SFPD_HANDLE_IDLE_TIMEOUT_MS));
 	}
 
-	if (FileHandle != NULL)
-	{
-		ZwClose(FileHandle);
-	}
+	WdfWaitLockRelease(SFPDContext->HandleCacheLock);
+
+	Trace(
+		TRACE_LEVEL_INFORMATION,
+		TRACE_DRIVER,
+		"SFPD handle cache - opens avoided: %d, opens performed: %d",
+		SFPDContext->OpensAvoided,
+		SFPDContext->OpensPerformed);
+
+	// Fires once reads have gone quiet, a good time to see how many of them shared a read
+	Trace(
+		TRACE_LEVEL_INFORMATION,
+		TRACE_DRIVER,
+		"SFPD item reads - started: %d, coalesced: %d",
+		SFPDContext->ReadFlightsStarted,
+		SFPDContext->ReadFlightsCoalesced);
+}
 
-	return status;
+VOID FlushSFPDHandleCache(WDFDEVICE device)
+{
+	PSFPD_DEVICE_CONTEXT SFPDContext = GetSFPDDeviceContext(device);
+
+	WdfTimerStop(SFPDContext->HandleCacheTimer, TRUE);
+
+	WdfWaitLockAcquire(SFPDContext->HandleCacheLock, NULL);
+
+	CloseSFPDHandlesLocked(SFPDContext, FALSE);
+	SFPDContext->HandleCacheTimerArmed = FALSE;
+
+	WdfWaitLockRelease(SFPDContext->HandleCacheLock);
 }
 
-NTSTATUS GetSFPDItemSize(WDFDEVICE device, WCHAR* ItemPath, DWORD* ItemSize)
+NTSTATUS GetSFPDPixelAlignmentData(WDFDEVICE device, PSFPD_DISPLAY_PIXEL_ALIGNMENT_DATA PixelAlignmentData)
 {
 	NTSTATUS status = STATUS_UNSUCCESSFUL;
 
-	HANDLE FileHandle = NULL;
-	WCHAR* FilePath = (WCHAR*)ExAllocatePoolWithTag(NonPagedPool, MAX_PATH * sizeof(WCHAR), POOL_TAG_FILEPATH);
-
-	if (NULL == FilePath)
+	if (PixelAlignmentData == NULL)
 	{
-		status = STATUS_INSUFFICIENT_RESOURCES;
+		status = STATUS_INVALID_PARAMETER;
 		goto exit;
 	}
 
-	status = GetSFPDVolumePath(device, FilePath, MAX_PATH);
+	DWORD PixelAlignmentDataSize = sizeof(SFPD_DISPLAY_PIXEL_ALIGNMENT_DATA);
+	DWORD ActualSFPDFileSize = 0;
 
-	if (!NT_SUCCESS(status))
+	status = GetSFPDItemWithSize(device, PIXEL_ALIGNMENT_DATA_FILE_PATH, PixelAlignmentData, PixelAlignmentDataSize, &ActualSFPDFileSize);
+
+	if (status == STATUS_BUFFER_TOO_SMALL || (NT_SUCCESS(status) && PixelAlignmentDataSize != ActualSFPDFileSize))
 	{
-		status = STATUS_NOT_FOUND;
+		status = STATUS_FILE_CORRUPT_ERROR;
 		goto exit;
 	}
 
-	status = RtlStringCbCatW(FilePath, MAX_PATH * sizeof(WCHAR), ItemPath);
-
 	if (!NT_SUCCESS(status))
 	{
-		status = STATUS_INSUFFICIENT_RESOURCES;
 		goto exit;
 	}
 
-	UNICODE_STRING FilePathUnicode;
-	RtlInitUnicodeString(&FilePathUnicode, FilePath);
+exit:
+	return status;
+}
 
-	OBJECT_ATTRIBUTES Attributes = { 0 };
-	InitializeObjectAttributes(&Attributes, &FilePathUnicode, OBJ_CASE_INSENSITIVE | OBJ_KERNEL_HANDLE, NULL, NULL);
+// Reads a whole item into a new pool buffer
+static NTSTATUS ReadSFPDItemFromDisk(WDFDEVICE device, WCHAR* ItemPath, PUCHAR* Data, DWORD* DataSize)
+{
+	NTSTATUS status = STATUS_UNSUCCESSFUL;
+	HANDLE FileHandle = NULL;
+	PUCHAR Buffer = NULL;
 
-	IO_STATUS_BLOCK IOStatusBlock = { 0 };
+	*Data = NULL;
+	*DataSize = 0;
+
+	status = AcquireSFPDHandle(device, ItemPath, FALSE, &FileHandle);
 
-	status = ZwCreateFile(&FileHandle, GENERIC_READ, &Attributes, &IOStatusBlock, NULL, FILE_ATTRIBUTE_NORMAL, 0, FILE_OPEN, FILE_SYNCHRONOUS_IO_NONALERT, NULL, 0);
 	if (!NT_SUCCESS(status))
 	{
-		status = STATUS_FILE_NOT_AVAILABLE;
 		goto exit;
 	}
 
+	IO_STATUS_BLOCK IOStatusBlock = { 0 };
+
 	FILE_STANDARD_INFORMATION FileStandardInfo = { 0 };
 
 	status = ZwQueryInformationFile(FileHandle, &IOStatusBlock, &FileStandardInfo, sizeof(FILE_STANDARD_INFORMATION), FileStandardInformation);
@@ -528,23 +684,855 @@ NTSTATUS GetSFPDItemSize(WDFDEVICE device, WCHAR* ItemPath, DWORD* ItemSize)
 		goto exit;
 	}
 
-	*ItemSize = FileStandardInfo.EndOfFile.LowPart;
+	DWORD ItemSize = FileStandardInfo.EndOfFile.LowPart;
 
-exit:
-	if (FilePath != NULL)
-	{
-		ExFreePool(FilePath);
-	}
+	Buffer = (PUCHAR)ExAllocatePoolWithTag(PagedPool, ItemSize != 0 ? ItemSize : 1, POOL_TAG_READFLIGHT);
+
+	if (Buffer == NULL)
+	{
+		status = STATUS_INSUFFICIENT_RESOURCES;
+		goto exit;
+	}
+
+	if (ItemSize != 0)
+	{
+		LARGE_INTEGER ByteOffset = { 0 };
+
+		status = ZwReadFile(FileHandle, NULL, NULL, NULL, &IOStatusBlock, Buffer, ItemSize, &ByteOffset, NULL);
+
+		if (!NT_SUCCESS(status))
+		{
+			status = STATUS_FILE_INVALID;
+			goto exit;
+		}
+
+		ItemSize = (DWORD)IOStatusBlock.Information;
+	}
+
+	*Data = Buffer;
+	*DataSize = ItemSize;
+	Buffer = NULL;
+
+	status = STATUS_SUCCESS;
+
+exit:
+	if (Buffer != NULL)
+	{
+		ExFreePoolWithTag(Buffer, POOL_TAG_READFLIGHT);
+	}
+
+	if (FileHandle != NULL)
+	{
+		ReleaseSFPDHandle(device, FileHandle);
+	}
+
+	return status;
+}
+
+static VOID LeaveSFPDReadFlight(PSFPD_READ_FLIGHT Flight)
+{
+	if (InterlockedDecrement(&Flight->RefCount) == 0)
+	{
+		if (Flight->Data != NULL)
+		{
+			ExFreePoolWithTag(Flight->Data, POOL_TAG_READFLIGHT);
+		}
+
+		ExFreePoolWithTag(Flight, POOL_TAG_READFLIGHT);
+	}
+}
+
+//
+// Returns the finished read of an item, either started here or joined while
+// another caller was reading the same path. Paths are matched ignoring case.
+// The caller copies what it needs and hands the flight to LeaveSFPDReadFlight.
+//
+static PSFPD_READ_FLIGHT JoinSFPDReadFlight(WDFDEVICE device, WCHAR* ItemPath)
+{
+	PSFPD_DEVICE_CONTEXT SFPDContext = GetSFPDDeviceContext(device);
+	PSFPD_READ_FLIGHT Flight = NULL;
+
+	WdfWaitLockAcquire(SFPDContext->ReadFlightLock, NULL);
+
+	for (PLIST_ENTRY Link = SFPDContext->ReadFlights.Flink; Link != &SFPDContext->ReadFlights; Link = Link->Flink)
+	{
+		PSFPD_READ_FLIGHT Candidate = CONTAINING_RECORD(Link, SFPD_READ_FLIGHT, Link);
+
+		if (IsSFPDPathEqual(Candidate->Path, ItemPath))
+		{
+			Flight = Candidate;
+			InterlockedIncrement(&Flight->RefCount);
+			break;
+		}
+	}
+
+	if (Flight != NULL)
+	{
+		WdfWaitLockRelease(SFPDContext->ReadFlightLock);
+
+		InterlockedIncrement(&SFPDContext->ReadFlightsCoalesced);
+
+		KeWaitForSingleObject(&Flight->Done, Executive, KernelMode, FALSE, NULL);
+
+		return Flight;
+	}
+
+	// Waited on, so not from paged pool
+	Flight = (PSFPD_READ_FLIGHT)ExAllocatePoolWithTag(NonPagedPoolNx, sizeof(SFPD_READ_FLIGHT), POOL_TAG_READFLIGHT);
+
+	if (Flight == NULL || !NT_SUCCESS(RtlStringCchCopyW(Flight->Path, MAX_PATH, ItemPath)))
+	{
+		WdfWaitLockRelease(SFPDContext->ReadFlightLock);
+
+		if (Flight != NULL)
+		{
+			ExFreePoolWithTag(Flight, POOL_TAG_READFLIGHT);
+		}
+
+		return NULL;
+	}
+
+	KeInitializeEvent(&Flight->Done, NotificationEvent, FALSE);
+	Flight->RefCount = 1;
+	Flight->Data = NULL;
+	Flight->DataSize = 0;
+
+	InsertTailList(&SFPDContext->ReadFlights, &Flight->Link);
+
+	WdfWaitLockRelease(SFPDContext->ReadFlightLock);
+
+	InterlockedIncrement(&SFPDContext->ReadFlightsStarted);
+
+	LONG CacheGeneration = GetSFPDCacheGeneration(device);
+
+	Flight->Status = ReadSFPDItemFromDisk(device, ItemPath, &Flight->Data, &Flight->DataSize);
+
+	if (NT_SUCCESS(Flight->Status))
+	{
+		InsertSFPDContentCache(device, ItemPath, Flight->Data, Flight->DataSize, CacheGeneration);
+	}
+
+	WdfWaitLockAcquire(SFPDContext->ReadFlightLock, NULL);
+	RemoveEntryList(&Flight->Link);
+	WdfWaitLockRelease(SFPDContext->ReadFlightLock);
+
+	KeSetEvent(&Flight->Done, IO_NO_INCREMENT, FALSE);
+
+	return Flight;
+}
+
+NTSTATUS GetSFPDItem(WDFDEVICE device, WCHAR* ItemPath, PVOID Data, DWORD DataSize)
+{
+	NTSTATUS status = STATUS_UNSUCCESSFUL;
+	PSFPD_READ_FLIGHT Flight = NULL;
+
+	if (Data == NULL || DataSize == 0 || ItemPath == NULL)
+	{
+		status = STATUS_INVALID_PARAMETER;
+		goto exit;
+	}
+
+	DWORD CachedItemSize = 0;
+
+	// Partial reads of a cached item still go to disk
+	if (ReadSFPDCache(device, ItemPath, Data, DataSize, &CachedItemSize) && DataSize >= CachedItemSize)
+	{
+		status = STATUS_SUCCESS;
+		goto exit;
+	}
+
+	Flight = JoinSFPDReadFlight(device, ItemPath);
+
+	if (Flight == NULL)
+	{
+		status = STATUS_INSUFFICIENT_RESOURCES;
+		goto exit;
+	}
+
+	status = Flight->Status;
+
+	if (!NT_SUCCESS(status))
+	{
+		goto exit;
+	}
+
+	// As much of the item as fits
+	RtlCopyMemory(Data, Flight->Data, min(DataSize, Flight->DataSize));
+
+exit:
+	if (Flight != NULL)
+	{
+		LeaveSFPDReadFlight(Flight);
+	}
+
+	return status;
+}
+
+// Called for every entry of a directory, return FALSE to stop the enumeration
+typedef BOOLEAN SFPD_DIRECTORY_ENTRY_CALLBACK(PFILE_DIRECTORY_INFORMATION DirectoryEntry, PVOID Context);
+typedef SFPD_DIRECTORY_ENTRY_CALLBACK* PSFPD_DIRECTORY_ENTRY_CALLBACK;
+
+//
+// Walks every entry of a directory. Each ZwQueryDirectoryFile call fills a whole
+// page with FileDirectoryInformation records (names, sizes and attributes, no short
+// names), which are then walked by their byte offsets.
+//
+static NTSTATUS EnumerateSFPDDirectory(WDFDEVICE device, WCHAR* DirectoryPath, PSFPD_DIRECTORY_ENTRY_CALLBACK Callback, PVOID Context)
+{
+	NTSTATUS status = STATUS_UNSUCCESSFUL;
+	HANDLE FileHandle = NULL;
+	WDFMEMORY BufferMemory = NULL;
+	PUCHAR Buffer = NULL;
+	BOOLEAN RestartScan = TRUE;
+	ULONG Queries = 0;
+	ULONG Entries = 0;
+
+	status = AcquireSFPDHandle(device, DirectoryPath, TRUE, &FileHandle);
+
+	if (!NT_SUCCESS(status))
+	{
+		goto exit;
+	}
+
+	Buffer = (PUCHAR)AllocateSFPDScratch(device, SFPDScratchEnumeration, &BufferMemory);
+
+	if (Buffer == NULL)
+	{
+		status = STATUS_NO_MEMORY;
+		goto exit;
+	}
+
+	while (TRUE)
+	{
+		IO_STATUS_BLOCK IOStatusBlock = { 0 };
+
+		// Cached directory handles keep their position, so the first call always restarts
+		status = ZwQueryDirectoryFile(FileHandle, NULL, NULL, NULL, &IOStatusBlock, Buffer,
+			SFPD_ENUMERATION_BUFFER_SIZE, FileDirectoryInformation, FALSE, NULL, RestartScan);
+
+		RestartScan = FALSE;
+		Queries++;
+
+		if (status == STATUS_NO_MORE_FILES)
+		{
+			status = STATUS_SUCCESS;
+			goto exit;
+		}
+
+		// STATUS_BUFFER_OVERFLOW would mean a single entry does not fit in a page
+		if (status != STATUS_SUCCESS)
+		{
+			goto exit;
+		}
+
+		ULONG Offset = 0;
+
+		while (TRUE)
+		{
+			PFILE_DIRECTORY_INFORMATION DirectoryEntry = (PFILE_DIRECTORY_INFORMATION)(Buffer + Offset);
+
+			Entries++;
+
+			if (!Callback(DirectoryEntry, Context))
+			{
+				status = STATUS_SUCCESS;
+				goto exit;
+			}
+
+			if (DirectoryEntry->NextEntryOffset == 0)
+			{
+				break;
+			}
+
+			Offset += DirectoryEntry->NextEntryOffset;
+		}
+	}
+
+exit:
+	if (BufferMemory != NULL)
+	{
+		FreeSFPDScratch(device, BufferMemory);
+	}
 
 	if (FileHandle != NULL)
 	{
-		ZwClose(FileHandle);
+		ReleaseSFPDHandle(device, FileHandle);
+	}
+
+	// A full walk counts one last query, the one finding no more files
+	Trace(
+		TRACE_LEVEL_VERBOSE,
+		TRACE_DRIVER,
+		"SFPD enumeration of %ws - %u entries in %u queries - 0x%08lX",
+		DirectoryPath,
+		Entries,
+		Queries,
+		status);
+
+	return status;
+}
+
+typedef struct _SFPD_DIRECTORY_LISTING_CONTEXT
+{
+	NTSTATUS Status;
+	PUCHAR Buffer;
+	DWORD MaximumNumberOfFiles;
+	DWORD CurrentNumberOfFiles;
+	DWORD CurrentFileAllocation;
+} SFPD_DIRECTORY_LISTING_CONTEXT, * PSFPD_DIRECTORY_LISTING_CONTEXT;
+
+// This function is very specifically crafted for SOCPartition, I know.
+static BOOLEAN AddSFPDDirectoryListingRecord(PFILE_DIRECTORY_INFORMATION DirectoryEntry, PVOID Context)
+{
+	PSFPD_DIRECTORY_LISTING_CONTEXT ListingContext = (PSFPD_DIRECTORY_LISTING_CONTEXT)Context;
+
+	// We do not want to touch directories
+	if ((DirectoryEntry->FileAttributes & FILE_ATTRIBUTE_DIRECTORY) == FILE_ATTRIBUTE_DIRECTORY)
+	{
+		return TRUE;
+	}
+
+	if (ListingContext->CurrentNumberOfFiles == ListingContext->MaximumNumberOfFiles)
+	{
+		DWORD MaximumNumberOfFiles = ListingContext->MaximumNumberOfFiles == 0 ? 16 : ListingContext->MaximumNumberOfFiles * 2;
+		PUCHAR NewBuffer = ExAllocatePoolWithTag(PagedPool, MaximumNumberOfFiles * SFPD_DIRECTORY_RECORD_SIZE, POOL_TAG_FILEPATH);
+
+		if (NewBuffer == NULL)
+		{
+			ListingContext->Status = STATUS_NO_MEMORY;
+			return FALSE;
+		}
+
+		if (ListingContext->Buffer != NULL)
+		{
+			RtlCopyMemory(NewBuffer, ListingContext->Buffer, ListingContext->CurrentNumberOfFiles * SFPD_DIRECTORY_RECORD_SIZE);
+			ExFreePoolWithTag(ListingContext->Buffer, POOL_TAG_FILEPATH);
+		}
+
+		ListingContext->Buffer = NewBuffer;
+		ListingContext->MaximumNumberOfFiles = MaximumNumberOfFiles;
+	}
+
+	PUCHAR FileBlockBuffer = ListingContext->Buffer + ListingContext->CurrentNumberOfFiles * SFPD_DIRECTORY_RECORD_SIZE;
+	ListingContext->CurrentNumberOfFiles++;
+
+	RtlZeroMemory(FileBlockBuffer, SFPD_DIRECTORY_RECORD_SIZE);
+	RtlCopyMemory(FileBlockBuffer, DirectoryEntry->FileName, min(DirectoryEntry->FileNameLength, 49 * sizeof(WCHAR)));
+	RtlCopyMemory(FileBlockBuffer + (49 * sizeof(WCHAR)), L"JSON", sizeof(L"JSON"));
+
+	DWORD FileSize = DirectoryEntry->EndOfFile.LowPart;
+	DWORD FileAllocation = FileSize;
+
+	if ((FileSize % 256) != 0)
+	{
+		FileAllocation = FileSize + (256 - (FileSize % 256));
+	}
+
+	*(DWORD*)(FileBlockBuffer + (49 * sizeof(WCHAR)) + (49 * sizeof(WCHAR))) = FileAllocation; // File Allocation
+	*(DWORD*)(FileBlockBuffer + (49 * sizeof(WCHAR)) + (49 * sizeof(WCHAR)) + 4) = FileSize; // FileSize
+	*(DWORD*)(FileBlockBuffer + (49 * sizeof(WCHAR)) + (49 * sizeof(WCHAR)) + 4 + 4) = 1; // ?, always one
+	*(DWORD*)(FileBlockBuffer + (49 * sizeof(WCHAR)) + (49 * sizeof(WCHAR)) + 4 + 4 + 4) = ListingContext->CurrentFileAllocation; // Offset
+
+	ListingContext->CurrentFileAllocation += FileAllocation;
+
+	return TRUE;
+}
+
+//
+// Enumerates a directory once and serializes every file in it into the 244 byte
+// records SOCPartition hands out. The record block is allocated from PagedPool
+// and returned in Listing, the caller frees it. An empty directory returns a NULL
+// Listing.
+//
+static NTSTATUS ReadSFPDDirectoryListing(WDFDEVICE device, WCHAR* DirectoryPath, PUCHAR* Listing, DWORD* ListingSize)
+{
+	NTSTATUS status = STATUS_UNSUCCESSFUL;
+	SFPD_DIRECTORY_LISTING_CONTEXT ListingContext = { 0 };
+
+	*Listing = NULL;
+	*ListingSize = 0;
+
+	ListingContext.Status = STATUS_SUCCESS;
+
+	status = EnumerateSFPDDirectory(device, DirectoryPath, AddSFPDDirectoryListingRecord, &ListingContext);
+
+	if (NT_SUCCESS(status))
+	{
+		status = ListingContext.Status;
+	}
+
+	if (!NT_SUCCESS(status))
+	{
+		if (ListingContext.Buffer != NULL)
+		{
+			ExFreePoolWithTag(ListingContext.Buffer, POOL_TAG_FILEPATH);
+		}
+
+		goto exit;
+	}
+
+	*Listing = ListingContext.Buffer;
+	*ListingSize = ListingContext.CurrentNumberOfFiles * SFPD_DIRECTORY_RECORD_SIZE;
+
+exit:
+	return status;
+}
+
+//
+// Returns the serialized records for every file in a directory. The listing is
+// built by a single enumeration and cached until the directory changes, so a size
+// probe followed by the real call both see the same snapshot. If DataSize is too
+// small nothing is copied and STATUS_BUFFER_TOO_SMALL is returned along with the
+// size that is needed.
+//
+NTSTATUS GetSFPDDirectoryListing(WDFDEVICE device, WCHAR* DirectoryPath, PVOID Data, DWORD DataSize, DWORD* ListingSize)
+{
+	NTSTATUS status = STATUS_UNSUCCESSFUL;
+	PUCHAR Listing = NULL;
+
+	if (DirectoryPath == NULL || ListingSize == NULL || (Data == NULL && DataSize != 0))
+	{
+		status = STATUS_INVALID_PARAMETER;
+		goto exit;
+	}
+
+	*ListingSize = 0;
+
+	if (ReadSFPDCache(device, DirectoryPath, Data, DataSize, ListingSize))
+	{
+		status = DataSize < *ListingSize ? STATUS_BUFFER_TOO_SMALL : STATUS_SUCCESS;
+		goto exit;
+	}
+
+	LONG CacheGeneration = GetSFPDCacheGeneration(device);
+
+	status = ReadSFPDDirectoryListing(device, DirectoryPath, &Listing, ListingSize);
+
+	if (!NT_SUCCESS(status))
+	{
+		goto exit;
+	}
+
+	InsertSFPDContentCache(device, DirectoryPath, Listing, *ListingSize, CacheGeneration);
+
+	if (DataSize < *ListingSize)
+	{
+		status = STATUS_BUFFER_TOO_SMALL;
+		goto exit;
+	}
+
+	if (*ListingSize != 0)
+	{
+		RtlCopyMemory(Data, Listing, *ListingSize);
+	}
+
+exit:
+	if (Listing != NULL)
+	{
+		ExFreePoolWithTag(Listing, POOL_TAG_FILEPATH);
+	}
+
+	return status;
+}
+
+NTSTATUS GetSFPDNumberOfFilesInDirectory(WDFDEVICE device, WCHAR* DirectoryPath, DWORD* NumberOfFiles)
+{
+	NTSTATUS status = STATUS_UNSUCCESSFUL;
+	DWORD ListingSize = 0;
+
+	if (NULL == NumberOfFiles)
+	{
+		status = STATUS_INSUFFICIENT_RESOURCES;
+		goto exit;
+	}
+
+	*NumberOfFiles = 0;
+
+	status = GetSFPDDirectoryListing(device, DirectoryPath, NULL, 0, &ListingSize);
+
+	if (status == STATUS_BUFFER_TOO_SMALL || NT_SUCCESS(status))
+	{
+		*NumberOfFiles = ListingSize / SFPD_DIRECTORY_RECORD_SIZE;
+		status = STATUS_SUCCESS;
+	}
+
+exit:
+	return status;
+}
+
+NTSTATUS GetSFPDFilesInDirectory(WDFDEVICE device, WCHAR* DirectoryPath, DWORD NumberOfFiles, PUCHAR Buffer)
+{
+	NTSTATUS status = STATUS_UNSUCCESSFUL;
+	DWORD ListingSize = 0;
+
+	status = GetSFPDDirectoryListing(device, DirectoryPath, Buffer, NumberOfFiles * SFPD_DIRECTORY_RECORD_SIZE, &ListingSize);
+
+	if (status == STATUS_BUFFER_TOO_SMALL)
+	{
+		status = STATUS_NO_MEMORY;
+	}
+
+	return status;
+}
+
+NTSTATUS GetSFPDItemSize(WDFDEVICE device, WCHAR* ItemPath, DWORD* ItemSize)
+{
+	NTSTATUS status = STATUS_UNSUCCESSFUL;
+
+	HANDLE FileHandle = NULL;
+
+	if (ReadSFPDCache(device, ItemPath, NULL, 0, ItemSize))
+	{
+		status = STATUS_SUCCESS;
+		goto exit;
+	}
+
+	status = AcquireSFPDHandle(device, ItemPath, FALSE, &FileHandle);
+
+	if (!NT_SUCCESS(status))
+	{
+		goto exit;
+	}
+
+	IO_STATUS_BLOCK IOStatusBlock = { 0 };
+
+	FILE_STANDARD_INFORMATION FileStandardInfo = { 0 };
+
+	status = ZwQueryInformationFile(FileHandle, &IOStatusBlock, &FileStandardInfo, sizeof(FILE_STANDARD_INFORMATION), FileStandardInformation);
+
+	if (!NT_SUCCESS(status))
+	{
+		status = STATUS_FILE_INVALID;
+		goto exit;
+	}
+
+	*ItemSize = FileStandardInfo.EndOfFile.LowPart;
+
+exit:
+	if (FileHandle != NULL)
+	{
+		ReleaseSFPDHandle(device, FileHandle);
+	}
+
+	return status;
+}
+
+//
+// Opens the item once, returns its size in ItemSize and reads it whole into Data.
+// If DataSize is too small for the item, nothing is read and STATUS_BUFFER_TOO_SMALL
+// is returned along with the size that is needed.
+//
+NTSTATUS GetSFPDItemWithSize(WDFDEVICE device, WCHAR* ItemPath, PVOID Data, DWORD DataSize, DWORD* ItemSize)
+{
+	NTSTATUS status = STATUS_UNSUCCESSFUL;
+	PSFPD_READ_FLIGHT Flight = NULL;
+
+	if (ItemPath == NULL || ItemSize == NULL || (Data == NULL && DataSize != 0))
+	{
+		status = STATUS_INVALID_PARAMETER;
+		goto exit;
+	}
+
+	*ItemSize = 0;
+
+	if (ReadSFPDCache(device, ItemPath, Data, DataSize, ItemSize))
+	{
+		status = DataSize < *ItemSize ? STATUS_BUFFER_TOO_SMALL : STATUS_SUCCESS;
+		goto exit;
+	}
+
+	Flight = JoinSFPDReadFlight(device, ItemPath);
+
+	if (Flight == NULL)
+	{
+		status = STATUS_INSUFFICIENT_RESOURCES;
+		goto exit;
+	}
+
+	status = Flight->Status;
+
+	if (!NT_SUCCESS(status))
+	{
+		goto exit;
+	}
+
+	*ItemSize = Flight->DataSize;
+
+	if (DataSize < *ItemSize)
+	{
+		status = STATUS_BUFFER_TOO_SMALL;
+		goto exit;
+	}
+
+	RtlCopyMemory(Data, Flight->Data, Flight->DataSize);
+
+exit:
+	if (Flight != NULL)
+	{
+		LeaveSFPDReadFlight(Flight);
+	}
+
+	return status;
+}
+
+static BOOLEAN LookupSFPDVolumePath(PSFPD_DEVICE_CONTEXT SFPDContext, WCHAR* VolumePath, DWORD VolumePathLength)
+{
+	BOOLEAN CacheHit = FALSE;
+
+	WdfSpinLockAcquire(SFPDContext->VolumePathLock);
+
+	if (SFPDContext->VolumePathValid &&
+		NT_SUCCESS(RtlStringCchCopyW(VolumePath, VolumePathLength, SFPDContext->VolumePath)))
+	{
+		CacheHit = TRUE;
+	}
+
+	WdfSpinLockRelease(SFPDContext->VolumePathLock);
+
+	return CacheHit;
+}
+
+// Scans the disks and publishes the result into the per-device cache
+static NTSTATUS ResolveSFPDVolumePath(WDFDEVICE device, WCHAR* VolumePath, DWORD VolumePathLength)
+{
+	NTSTATUS status = STATUS_UNSUCCESSFUL;
+	PSFPD_DEVICE_CONTEXT SFPDContext = GetSFPDDeviceContext(device);
+
+	status = ScanSFPDVolumePath(device, VolumePath, VolumePathLength);
+
+	if (!NT_SUCCESS(status))
+	{
+		goto exit;
+	}
+
+	WdfSpinLockAcquire(SFPDContext->VolumePathLock);
+
+	if (NT_SUCCESS(RtlStringCchCopyW(SFPDContext->VolumePath, MAX_PATH, VolumePath)))
+	{
+		SFPDContext->VolumePathValid = TRUE;
+	}
+
+	WdfSpinLockRelease(SFPDContext->VolumePathLock);
+
+exit:
+	return status;
+}
+
+NTSTATUS GetSFPDVolumePath(WDFDEVICE device, WCHAR* VolumePath, DWORD VolumePathLength)
+{
+	NTSTATUS status = STATUS_UNSUCCESSFUL;
+	PSFPD_DEVICE_CONTEXT SFPDContext = GetSFPDDeviceContext(device);
+
+	if (LookupSFPDVolumePath(SFPDContext, VolumePath, VolumePathLength))
+	{
+		InterlockedIncrement(&SFPDContext->VolumePathCacheHits);
+		status = STATUS_SUCCESS;
+		goto exit;
+	}
+
+	InterlockedIncrement(&SFPDContext->VolumePathCacheMisses);
+
+	if (SFPDContext->DiscoveryStarted)
+	{
+		// A disk or volume just showed up and is being looked at, park until that pass is done
+		LARGE_INTEGER timeout = { 0 };
+		timeout.QuadPart = RELATIVE(MILLISECONDS(SFPD_DISCOVERY_TIMEOUT_MS));
+
+		KeWaitForSingleObject(&SFPDContext->DiscoveryIdleEvent, Executive, KernelMode, FALSE, &timeout);
+
+		if (LookupSFPDVolumePath(SFPDContext, VolumePath, VolumePathLength))
+		{
+			status = STATUS_SUCCESS;
+			goto exit;
+		}
+	}
+
+	status = ResolveSFPDVolumePath(device, VolumePath, VolumePathLength);
+
+exit:
+	return status;
+}
+
+static VOID OnSFPDDiscoveryWorkItem(WDFWORKITEM WorkItem)
+{
+	WDFDEVICE device = (WDFDEVICE)WdfWorkItemGetParentObject(WorkItem);
+	PSFPD_DEVICE_CONTEXT SFPDContext = GetSFPDDeviceContext(device);
+	WDFMEMORY VolumePathMemory = NULL;
+	WCHAR* VolumePath = (WCHAR*)AllocateSFPDScratch(device, SFPDScratchPath, &VolumePathMemory);
+
+	while (InterlockedExchange(&SFPDContext->DiscoveryRequests, 0) != 0)
+	{
+		if (VolumePath == NULL)
+		{
+			break;
+		}
+
+		if (LookupSFPDVolumePath(SFPDContext, VolumePath, MAX_PATH))
+		{
+			continue;
+		}
+
+		NTSTATUS status = ResolveSFPDVolumePath(device, VolumePath, MAX_PATH);
+
+		Trace(
+			TRACE_LEVEL_INFORMATION,
+			TRACE_DRIVER,
+			"SFPD discovery pass - 0x%08lX",
+			status);
+	}
+
+	if (VolumePathMemory != NULL)
+	{
+		FreeSFPDScratch(device, VolumePathMemory);
+	}
+
+	KeSetEvent(&SFPDContext->DiscoveryIdleEvent, IO_NO_INCREMENT, FALSE);
+
+	if (SFPDContext->VolumePathValid)
+	{
+		NTSTATUS status = StartSFPDWatcher(device);
+
+		if (!NT_SUCCESS(status))
+		{
+			Trace(
+				TRACE_LEVEL_ERROR,
+				TRACE_DRIVER,
+				"SFPD change watcher failed to start - 0x%08lX",
+				status);
+		}
+	}
+
+	// Only the work item touches WarmCacheAttempted, so once per start is enough
+	if (!SFPDContext->WarmCacheAttempted && SFPDContext->VolumePathValid)
+	{
+		SFPDContext->WarmCacheAttempted = TRUE;
+
+		NTSTATUS status = WarmSFPDCache(device);
+
+		Trace(
+			TRACE_LEVEL_INFORMATION,
+			TRACE_DRIVER,
+			"SFPD warm cache - 0x%08lX",
+			status);
+	}
+
+	// Derived provisioning files only need sfpd to be there, answer them from memory from now on
+	if (SFPDContext->VolumePathValid)
+	{
+		RefreshVirtualFileSnapshots(device);
+	}
+}
+
+static NTSTATUS OnSFPDInterfaceChange(PVOID NotificationStructure, PVOID Context)
+{
+	PDEVICE_INTERFACE_CHANGE_NOTIFICATION Notification = (PDEVICE_INTERFACE_CHANGE_NOTIFICATION)NotificationStructure;
+	WDFDEVICE device = (WDFDEVICE)Context;
+	PSFPD_DEVICE_CONTEXT SFPDContext = GetSFPDDeviceContext(device);
+
+	if (IsEqualGUID(&Notification->Event, &GUID_DEVICE_INTERFACE_REMOVAL))
+	{
+		// Could be the partition we cached, find it again
+		InvalidateSFPDVolumePath(device);
+	}
+	else if (!IsEqualGUID(&Notification->Event, &GUID_DEVICE_INTERFACE_ARRIVAL))
+	{
+		goto exit;
+	}
+
+	// Opening devices from within the notification can deadlock PnP, scan from a work item
+	KeClearEvent(&SFPDContext->DiscoveryIdleEvent);
+	InterlockedIncrement(&SFPDContext->DiscoveryRequests);
+	WdfWorkItemEnqueue(SFPDContext->DiscoveryWorkItem);
+
+exit:
+	return STATUS_SUCCESS;
+}
+
+NTSTATUS StartSFPDDiscovery(WDFDEVICE device)
+{
+	NTSTATUS status = STATUS_UNSUCCESSFUL;
+	PSFPD_DEVICE_CONTEXT SFPDContext = GetSFPDDeviceContext(device);
+	PDRIVER_OBJECT DriverObject = WdfDriverWdmGetDriverObject(WdfDeviceGetDriver(device));
+
+	// The work item is not running yet, the first pass after this start warms the cache again
+	SFPDContext->WarmCacheAttempted = FALSE;
+
+	status = IoRegisterPlugPlayNotification(
+		EventCategoryDeviceInterfaceChange,
+		PNPNOTIFY_DEVICE_INTERFACE_INCLUDE_EXISTING_INTERFACES,
+		(PVOID)&GUID_DEVINTERFACE_PARTITION,
+		DriverObject,
+		OnSFPDInterfaceChange,
+		(PVOID)device,
+		&SFPDContext->PartitionNotificationEntry);
+
+	if (!NT_SUCCESS(status))
+	{
+		goto exit;
+	}
+
+	status = IoRegisterPlugPlayNotification(
+		EventCategoryDeviceInterfaceChange,
+		PNPNOTIFY_DEVICE_INTERFACE_INCLUDE_EXISTING_INTERFACES,
+		(PVOID)&GUID_DEVINTERFACE_VOLUME,
+		DriverObject,
+		OnSFPDInterfaceChange,
+		(PVOID)device,
+		&SFPDContext->VolumeNotificationEntry);
+
+	if (!NT_SUCCESS(status))
+	{
+		goto exit;
+	}
+
+	SFPDContext->DiscoveryStarted = TRUE;
+
+exit:
+	if (!NT_SUCCESS(status))
+	{
+		StopSFPDDiscovery(device);
 	}
 
 	return status;
 }
 
-NTSTATUS GetSFPDVolumePath(WDFDEVICE device, WCHAR* VolumePath, DWORD VolumePathLength)
+VOID StopSFPDDiscovery(WDFDEVICE device)
+{
+	PSFPD_DEVICE_CONTEXT SFPDContext = GetSFPDDeviceContext(device);
+
+	SFPDContext->DiscoveryStarted = FALSE;
+
+	if (SFPDContext->PartitionNotificationEntry != NULL)
+	{
+		IoUnregisterPlugPlayNotificationEx(SFPDContext->PartitionNotificationEntry);
+		SFPDContext->PartitionNotificationEntry = NULL;
+	}
+
+	if (SFPDContext->VolumeNotificationEntry != NULL)
+	{
+		IoUnregisterPlugPlayNotificationEx(SFPDContext->VolumeNotificationEntry);
+		SFPDContext->VolumeNotificationEntry = NULL;
+	}
+
+	WdfWorkItemFlush(SFPDContext->DiscoveryWorkItem);
+
+	// Nothing is going to signal it anymore, release anyone still parked
+	KeSetEvent(&SFPDContext->DiscoveryIdleEvent, IO_NO_INCREMENT, FALSE);
+
+	// Most devices never invalidate the path, report how the cache did on the way out too
+	Trace(
+		TRACE_LEVEL_INFORMATION,
+		TRACE_DRIVER,
+		"SFPD volume path cache - hits: %d, misses: %d",
+		SFPDContext->VolumePathCacheHits,
+		SFPDContext->VolumePathCacheMisses);
+}
+
+//
+// Reads the layout of one disk and looks for the sfpd GPT partition on it.
+// Returns STATUS_NOT_FOUND if the disk is there but has no sfpd partition.
+//
+static NTSTATUS ProbeSFPDDisk(WDFDEVICE device, DWORD HardDiskNumber, DWORD* PartitionNumber, GUID* PartitionId)
 {
 	NTSTATUS status = STATUS_UNSUCCESSFUL;
 
@@ -553,210 +1541,319 @@ NTSTATUS GetSFPDVolumePath(WDFDEVICE device, WCHAR* VolumePath, DWORD VolumePath
 	WDFMEMORY                     IOCTLRequestMemoryBuffer = NULL;
 
 	DRIVE_LAYOUT_INFORMATION_EX* DriverLayoutInformationExtended = NULL;
-	DWORD HardDiskNumber = 0;
-	DWORD PartitionNumber = 0;
-	BOOL FoundPartition = FALSE;
+	WDFMEMORY DevicePathMemory = NULL;
 	WCHAR* DevicePath = NULL;
 
-	do
+	DevicePath = (WCHAR*)AllocateSFPDScratch(device, SFPDScratchPath, &DevicePathMemory);
+
+	if (DevicePath == NULL)
 	{
-		DevicePath = (WCHAR*)ExAllocatePoolWithTag(NonPagedPool, MAX_PATH * sizeof(WCHAR), POOL_TAG_FILEPATH);
+		status = STATUS_INSUFFICIENT_RESOURCES;
+		goto exit;
+	}
 
-		if (DevicePath == NULL)
-		{
-			goto exit;
-		}
+	status = RtlStringCbPrintfW(DevicePath, MAX_PATH * sizeof(WCHAR), L"\\Device\\Harddisk%u\\Partition0", HardDiskNumber);
+
+	if (!NT_SUCCESS(status))
+	{
+		goto exit;
+	}
+
+	UNICODE_STRING DevicePathUnicode = { 0 };
+	RtlInitUnicodeString(&DevicePathUnicode, DevicePath);
+
+	WDF_OBJECT_ATTRIBUTES Attributes;
+	WDF_OBJECT_ATTRIBUTES_INIT(&Attributes);
+	Attributes.ParentObject = device;
+
+	status = WdfIoTargetCreate(device, &Attributes, &IOTarget);
+
+	if (!NT_SUCCESS(status))
+	{
+		goto exit;
+	}
+
+	WDF_IO_TARGET_OPEN_PARAMS IOTargetOpenParams;
+	WDF_IO_TARGET_OPEN_PARAMS_INIT_OPEN_BY_NAME(
+		&IOTargetOpenParams,
+		&DevicePathUnicode,
+		GENERIC_READ | GENERIC_WRITE
+	);
 
-		status = RtlStringCbPrintfW(DevicePath, MAX_PATH * sizeof(WCHAR), L"\\Device\\Harddisk%u\\Partition0", HardDiskNumber);
+	IOTargetOpenParams.ShareAccess = FILE_SHARE_READ | FILE_SHARE_WRITE;
 
+	status = WdfIoTargetOpen(IOTarget, &IOTargetOpenParams);
+
+	if (!NT_SUCCESS(status))
+	{
+		WdfObjectDelete(IOTarget);
+		IOTarget = NULL;
+
+		goto exit;
+	}
+
+	DWORD PartitionCount = 4;
+
+	do
+	{
+		WDF_OBJECT_ATTRIBUTES_INIT(&Attributes);
+		Attributes.ParentObject = IOTarget;
+
+		status = WdfRequestCreate(&Attributes, IOTarget, &Request);
 		if (!NT_SUCCESS(status))
 		{
 			goto exit;
 		}
 
-		UNICODE_STRING DevicePathUnicode = { 0 };
-		RtlInitUnicodeString(&DevicePathUnicode, DevicePath);
+		DWORD IOCTLRequestMemoryBufferSize = sizeof(DRIVE_LAYOUT_INFORMATION_EX) + (PartitionCount * sizeof(PARTITION_INFORMATION_EX));
 
-		WDF_OBJECT_ATTRIBUTES Attributes;
 		WDF_OBJECT_ATTRIBUTES_INIT(&Attributes);
-		Attributes.ParentObject = device;
-
-		status = WdfIoTargetCreate(device, &Attributes, &IOTarget);
+		Attributes.ParentObject = Request;
+
+		status = WdfMemoryCreate(
+			&Attributes,
+			NonPagedPool,
+			POOL_TAG_DRIVEINFO,
+			IOCTLRequestMemoryBufferSize,
+			&IOCTLRequestMemoryBuffer,
+			&DriverLayoutInformationExtended
+		);
 
 		if (!NT_SUCCESS(status))
 		{
 			goto exit;
 		}
 
-		WDF_IO_TARGET_OPEN_PARAMS IOTargetOpenParams;
-		WDF_IO_TARGET_OPEN_PARAMS_INIT_OPEN_BY_NAME(
-			&IOTargetOpenParams,
-			&DevicePathUnicode,
-			GENERIC_READ | GENERIC_WRITE
+		status = WdfIoTargetFormatRequestForIoctl(
+			IOTarget,
+			Request,
+			IOCTL_DISK_GET_DRIVE_LAYOUT_EX,
+			NULL,
+			NULL,
+			IOCTLRequestMemoryBuffer,
+			NULL
 		);
 
-		IOTargetOpenParams.ShareAccess = FILE_SHARE_READ | FILE_SHARE_WRITE;
-
-		for (DWORD OpenAttemptCounter = 0; OpenAttemptCounter < MAX_FILE_OPEN_ATTEMPTS; OpenAttemptCounter++)
+		if (!NT_SUCCESS(status))
 		{
-			status = WdfIoTargetOpen(IOTarget, &IOTargetOpenParams);
-
-			if (status == STATUS_SHARING_VIOLATION)
-			{
-				LARGE_INTEGER timeout = { 0 };
-				timeout.QuadPart = RELATIVE(MILLISECONDS(500));
-				KeDelayExecutionThread(KernelMode, FALSE, &timeout);
-			}
-			else
-			{
-				break;
-			}
+			goto exit;
 		}
 
-		if (!NT_SUCCESS(status))
+		WDF_REQUEST_SEND_OPTIONS RequestSendOptions;
+		WDF_REQUEST_SEND_OPTIONS_INIT(
+			&RequestSendOptions,
+			WDF_REQUEST_SEND_OPTION_SYNCHRONOUS
+		);
+
+		if (WdfRequestSend(Request, IOTarget, &RequestSendOptions) == FALSE)
 		{
-			WdfObjectDelete(IOTarget);
-			IOTarget = NULL;
+			status = WdfRequestGetStatus(Request);
 
 			goto exit;
 		}
 
-		DWORD PartitionCount = 4;
+		status = WdfRequestGetStatus(Request);
 
-		do
+		if (((status == STATUS_BUFFER_TOO_SMALL) || (status == STATUS_INSUFFICIENT_RESOURCES)) && PartitionCount < 256)
 		{
-			WDF_OBJECT_ATTRIBUTES_INIT(&Attributes);
-			Attributes.ParentObject = IOTarget;
-
-			status = WdfRequestCreate(&Attributes, IOTarget, &Request);
-			if (!NT_SUCCESS(status))
-			{
-				goto exit;
-			}
+			PartitionCount *= 2;
 
-			DWORD IOCTLRequestMemoryBufferSize = sizeof(DRIVE_LAYOUT_INFORMATION_EX) + (PartitionCount * sizeof(PARTITION_INFORMATION_EX));
+			WdfObjectDelete(IOCTLRequestMemoryBuffer);
+			IOCTLRequestMemoryBuffer = NULL;
 
-			WDF_OBJECT_ATTRIBUTES_INIT(&Attributes);
-			Attributes.ParentObject = Request;
+			WdfObjectDelete(Request);
+			Request = NULL;
+		}
+		else if (!NT_SUCCESS(status))
+		{
+			goto exit;
+		}
+	} while (!NT_SUCCESS(status));
 
-			status = WdfMemoryCreate(
-				&Attributes,
-				NonPagedPool,
-				POOL_TAG_DRIVEINFO,
-				IOCTLRequestMemoryBufferSize,
-				&IOCTLRequestMemoryBuffer,
-				&DriverLayoutInformationExtended
-			);
+	status = STATUS_NOT_FOUND;
 
-			if (!NT_SUCCESS(status))
+	if (DriverLayoutInformationExtended->PartitionStyle == PARTITION_STYLE_GPT)
+	{
+		for (DWORD i = 0; i < DriverLayoutInformationExtended->PartitionCount; i++)
+		{
+			if (RtlCompareMemory(&(DriverLayoutInformationExtended->PartitionEntry[i].Gpt.Name), SURFACE_FIRMWARE_PROVISIONING_DATA, sizeof(SURFACE_FIRMWARE_PROVISIONING_DATA)) == sizeof(SURFACE_FIRMWARE_PROVISIONING_DATA))
 			{
-				goto exit;
-			}
+				*PartitionNumber = DriverLayoutInformationExtended->PartitionEntry[i].PartitionNumber;
+				*PartitionId = DriverLayoutInformationExtended->PartitionEntry[i].Gpt.PartitionId;
 
-			status = WdfIoTargetFormatRequestForIoctl(
-				IOTarget,
-				Request,
-				IOCTL_DISK_GET_DRIVE_LAYOUT_EX,
-				NULL,
-				NULL,
-				IOCTLRequestMemoryBuffer,
-				NULL
-			);
-
-			if (!NT_SUCCESS(status))
-			{
-				goto exit;
+				status = STATUS_SUCCESS;
+				break;
 			}
+		}
+	}
 
-			WDF_REQUEST_SEND_OPTIONS RequestSendOptions;
-			WDF_REQUEST_SEND_OPTIONS_INIT(
-				&RequestSendOptions,
-				WDF_REQUEST_SEND_OPTION_SYNCHRONOUS
-			);
+exit:
+	if (IOCTLRequestMemoryBuffer != NULL)
+	{
+		WdfObjectDelete(IOCTLRequestMemoryBuffer);
+	}
 
-			if (WdfRequestSend(Request, IOTarget, &RequestSendOptions) == FALSE)
-			{
-				status = WdfRequestGetStatus(Request);
+	if (Request != NULL)
+	{
+		WdfObjectDelete(Request);
+	}
 
-				goto exit;
-			}
+	if (IOTarget != NULL)
+	{
+		WdfIoTargetClose(IOTarget);
+		WdfObjectDelete(IOTarget);
+	}
 
-			status = WdfRequestGetStatus(Request);
+	if (DevicePathMemory != NULL)
+	{
+		FreeSFPDScratch(device, DevicePathMemory);
+	}
 
-			if (((status == STATUS_BUFFER_TOO_SMALL) || (status == STATUS_INSUFFICIENT_RESOURCES)) && PartitionCount < 256)
-			{
-				PartitionCount *= 2;
+	return status;
+}
 
-				WdfObjectDelete(IOCTLRequestMemoryBuffer);
-				IOCTLRequestMemoryBuffer = NULL;
+// Where sfpd was found last time, from the device hardware key
+static BOOLEAN LoadSFPDLocation(WDFDEVICE device, DWORD* HardDiskNumber, DWORD* PartitionNumber, GUID* PartitionId)
+{
+	WDFKEY Key = NULL;
+	BOOLEAN Loaded = FALSE;
+	ULONG ValueLength = 0;
+	ULONG ValueType = 0;
+	DECLARE_CONST_UNICODE_STRING(DiskValueName, SFPD_LOCATION_DISK_VALUE_NAME);
+	DECLARE_CONST_UNICODE_STRING(PartitionValueName, SFPD_LOCATION_PARTITION_VALUE_NAME);
+	DECLARE_CONST_UNICODE_STRING(PartitionIdValueName, SFPD_LOCATION_PARTITION_ID_VALUE_NAME);
+
+	if (!NT_SUCCESS(WdfDeviceOpenRegistryKey(device, PLUGPLAY_REGKEY_DEVICE, KEY_READ, WDF_NO_OBJECT_ATTRIBUTES, &Key)))
+	{
+		goto exit;
+	}
 
-				WdfObjectDelete(Request);
-				Request = NULL;
-			}
-			else if (!NT_SUCCESS(status))
-			{
-				goto exit;
-			}
-		} while (!NT_SUCCESS(status));
+	if (!NT_SUCCESS(WdfRegistryQueryULong(Key, &DiskValueName, HardDiskNumber)) ||
+		!NT_SUCCESS(WdfRegistryQueryULong(Key, &PartitionValueName, PartitionNumber)) ||
+		!NT_SUCCESS(WdfRegistryQueryValue(Key, &PartitionIdValueName, sizeof(GUID), PartitionId, &ValueLength, &ValueType)) ||
+		ValueType != REG_BINARY ||
+		ValueLength != sizeof(GUID))
+	{
+		goto exit;
+	}
 
-		if (DriverLayoutInformationExtended->PartitionStyle == PARTITION_STYLE_GPT)
-		{
-			for (DWORD i = 0; i < DriverLayoutInformationExtended->PartitionCount; i++)
-			{
-				if (RtlCompareMemory(&(DriverLayoutInformationExtended->PartitionEntry[i].Gpt.Name), SURFACE_FIRMWARE_PROVISIONING_DATA, sizeof(SURFACE_FIRMWARE_PROVISIONING_DATA)) == sizeof(SURFACE_FIRMWARE_PROVISIONING_DATA))
-				{
-					PartitionNumber = DriverLayoutInformationExtended->PartitionEntry[i].PartitionNumber;
+	Loaded = TRUE;
 
-					FoundPartition = TRUE;
-					break;
-				}
-			}
-		}
+exit:
+	if (Key != NULL)
+	{
+		WdfRegistryClose(Key);
+	}
 
-		WdfObjectDelete(IOCTLRequestMemoryBuffer);
-		IOCTLRequestMemoryBuffer = NULL;
+	return Loaded;
+}
 
-		WdfObjectDelete(Request);
-		Request = NULL;
+static VOID SaveSFPDLocation(WDFDEVICE device, DWORD HardDiskNumber, DWORD PartitionNumber, GUID* PartitionId)
+{
+	WDFKEY Key = NULL;
+	NTSTATUS status = STATUS_UNSUCCESSFUL;
+	DECLARE_CONST_UNICODE_STRING(DiskValueName, SFPD_LOCATION_DISK_VALUE_NAME);
+	DECLARE_CONST_UNICODE_STRING(PartitionValueName, SFPD_LOCATION_PARTITION_VALUE_NAME);
+	DECLARE_CONST_UNICODE_STRING(PartitionIdValueName, SFPD_LOCATION_PARTITION_ID_VALUE_NAME);
 
-		WdfIoTargetClose(IOTarget);
-		WdfObjectDelete(IOTarget);
-		IOTarget = NULL;
+	status = WdfDeviceOpenRegistryKey(device, PLUGPLAY_REGKEY_DEVICE, KEY_WRITE, WDF_NO_OBJECT_ATTRIBUTES, &Key);
+
+	if (!NT_SUCCESS(status))
+	{
+		goto exit;
+	}
 
-		ExFreePool(DevicePath);
-		DevicePath = NULL;
-	} while ((FoundPartition == FALSE) && (HardDiskNumber++ < MAXIMUM_NUMBERS_OF_LUNS));
+	status = WdfRegistryAssignULong(Key, &DiskValueName, HardDiskNumber);
 
-	if (FoundPartition == TRUE)
+	if (!NT_SUCCESS(status))
 	{
-		status = RtlStringCbPrintfW(VolumePath, VolumePathLength * sizeof(WCHAR), L"\\Device\\Harddisk%u\\Partition%u\\", HardDiskNumber, PartitionNumber);
+		goto exit;
 	}
-	else
+
+	status = WdfRegistryAssignULong(Key, &PartitionValueName, PartitionNumber);
+
+	if (!NT_SUCCESS(status))
 	{
-		status = STATUS_UNSUCCESSFUL;
+		goto exit;
 	}
 
+	status = WdfRegistryAssignValue(Key, &PartitionIdValueName, REG_BINARY, sizeof(GUID), PartitionId);
+
 exit:
-	if (IOCTLRequestMemoryBuffer != NULL)
+	if (Key != NULL)
 	{
-		WdfObjectDelete(IOCTLRequestMemoryBuffer);
+		WdfRegistryClose(Key);
 	}
 
-	if (Request != NULL)
+	Trace(
+		TRACE_LEVEL_INFORMATION,
+		TRACE_DRIVER,
+		"SFPD location saved - disk %u, partition %u - 0x%08lX",
+		HardDiskNumber,
+		PartitionNumber,
+		status);
+}
+
+//
+// Tries the location sfpd was found at last time with a single layout query, and
+// only falls back to walking every disk when that does not match anymore.
+//
+static NTSTATUS ScanSFPDVolumePath(WDFDEVICE device, WCHAR* VolumePath, DWORD VolumePathLength)
+{
+	NTSTATUS status = STATUS_UNSUCCESSFUL;
+
+	DWORD SavedHardDiskNumber = 0;
+	DWORD SavedPartitionNumber = 0;
+	GUID SavedPartitionId = { 0 };
+	BOOLEAN Saved = LoadSFPDLocation(device, &SavedHardDiskNumber, &SavedPartitionNumber, &SavedPartitionId);
+
+	DWORD HardDiskNumber = 0;
+	DWORD PartitionNumber = 0;
+	GUID PartitionId = { 0 };
+	BOOL FoundPartition = FALSE;
+
+	if (Saved &&
+		NT_SUCCESS(ProbeSFPDDisk(device, SavedHardDiskNumber, &PartitionNumber, &PartitionId)) &&
+		PartitionNumber == SavedPartitionNumber &&
+		IsEqualGUID(&PartitionId, &SavedPartitionId))
 	{
-		WdfObjectDelete(Request);
+		HardDiskNumber = SavedHardDiskNumber;
+		FoundPartition = TRUE;
 	}
 
-	if (IOTarget != NULL)
+	if (!FoundPartition)
 	{
-		WdfIoTargetClose(IOTarget);
-		WdfObjectDelete(IOTarget);
+		for (HardDiskNumber = 0; HardDiskNumber <= MAXIMUM_NUMBERS_OF_LUNS; HardDiskNumber++)
+		{
+			// Not there yet or busy (STATUS_SHARING_VIOLATION), move on to the next disk.
+			// Its arrival will kick off another discovery pass, no point in waiting here.
+			if (!NT_SUCCESS(ProbeSFPDDisk(device, HardDiskNumber, &PartitionNumber, &PartitionId)))
+			{
+				continue;
+			}
+
+			FoundPartition = TRUE;
+
+			if (!Saved ||
+				HardDiskNumber != SavedHardDiskNumber ||
+				PartitionNumber != SavedPartitionNumber ||
+				!IsEqualGUID(&PartitionId, &SavedPartitionId))
+			{
+				SaveSFPDLocation(device, HardDiskNumber, PartitionNumber, &PartitionId);
+			}
+
+			break;
+		}
 	}
 
-	if (DevicePath != NULL)
+	if (FoundPartition == TRUE)
+	{
+		status = RtlStringCbPrintfW(VolumePath, VolumePathLength * sizeof(WCHAR), L"\\Device\\Harddisk%u\\Partition%u\\", HardDiskNumber, PartitionNumber);
+	}
+	else
 	{
-		ExFreePool(DevicePath);
+		status = STATUS_UNSUCCESSFUL;
 	}
 
 	return status;
-}
\ No newline at end of file
+}
@@ -0,0 +1,895 @@
+/*++
+
+Copyright (c) 2021-2024 DuoWoA authors. All Rights Reserved.
+
+Module Name:
+
+	sfpdcache.c
+
+Abstract:
+
+	This file contains the SFPD content cache functions.
+
+Environment:
+
+	Kernel-mode Driver Framework
+
+--*/
+
+#include "sfpd.h"
+#include "vfile.h"
+#include <trace.h>
+#include <sfpdcache.tmh>
+
+// ntifs header is incompatible with wdm header...
+
+#if (NTDDI_VERSION >= NTDDI_WIN2K)
+_IRQL_requires_max_(PASSIVE_LEVEL)
+NTSYSAPI
+NTSTATUS
+NTAPI
+ZwNotifyChangeDirectoryFile(
+	_In_ HANDLE FileHandle,
+	_In_opt_ HANDLE Event,
+	_In_opt_ PIO_APC_ROUTINE ApcRoutine,
+	_In_opt_ PVOID ApcContext,
+	_Out_ PIO_STATUS_BLOCK IoStatusBlock,
+	_Out_writes_bytes_(Length) PVOID Buffer,
+	_In_ ULONG Length,
+	_In_ ULONG CompletionFilter,
+	_In_ BOOLEAN WatchTree
+);
+#endif
+
+typedef struct _FILE_NOTIFY_INFORMATION {
+	ULONG NextEntryOffset;
+	ULONG Action;
+	ULONG FileNameLength;
+	WCHAR FileName[1];
+} FILE_NOTIFY_INFORMATION, * PFILE_NOTIFY_INFORMATION;
+
+// end of workaround for ntifs
+
+static KSTART_ROUTINE OnSFPDWatcherThread;
+static VOID InvalidateSFPDCachePath(WDFDEVICE device, WCHAR* ItemPath);
+
+//
+// Everything sfpd.h knows about that is worth keeping in memory. The attestation
+// and widevine directories hold device secrets and deliberately stay on disk.
+//
+static WCHAR* SFPDWarmCacheItems[] =
+{
+	AUDIO_CALIBRATION_FILE_PATH,
+	BT_NV_FILE_PATH,
+	LED_CALIBRATION_DATA_FILE_PATH,
+	TOF_FACIAL_CALIBRATION_FILE_PATH,
+	BB_SERIAL_NUMBER_FILE_PATH,
+	DEVICE_COLOR_FILE_PATH,
+	MB_SERIAL_NUMBER_FILE_PATH,
+	PROVISIONING_INFO_FILE_PATH,
+	SERIAL_NUMBER_FILE_PATH,
+	CUSTOMER_OS_LUT2_0_FILE_PATH,
+	CUSTOMER_OS_LUT2_1_FILE_PATH,
+	PANEL_CALIBRATION_DATA_C3_FILE_PATH,
+	PANEL_CALIBRATION_DATA_R2_FILE_PATH,
+	FACTORY_OS_LUT2_0_FILE_PATH,
+	FACTORY_OS_LUT2_1_FILE_PATH,
+	NVRAM_TABLE_0_FILE_PATH,
+	NVRAM_TABLE_1_FILE_PATH,
+	PIXEL_ALIGNMENT_DATA_FILE_PATH,
+	PANEL_CALIBRATION_DATA_C3_ELGIN_FILE_PATH,
+	PANEL_CALIBRATION_DATA_R2_ELGIN_FILE_PATH,
+	FCC_MODEL_ID_FILE_PATH,
+	REGULATORY_LOGOS_FILE_PATH,
+	SAR_ACTION_TABLE_FILE_PATH,
+	SAR_LTE_REGION_FILE_PATH,
+	SAR_TRIGGER_TABLE_FILE_PATH,
+	SAR_WIFI_REGION_FILE_PATH,
+	WCNSS_CONFIG_FILE_PATH,
+	WIFI_REGION_CONFIG_FILE_PATH,
+	WIFI_SAR_CONFIG_FILE_PATH,
+	WIFI_SAR_HEADER_FILE_PATH,
+	WIFI_SAR_TABLE_FILE_PATH,
+	WLAN_MAC_FILE_PATH,
+};
+
+typedef struct _SFPD_WARM_CACHE_CANDIDATE
+{
+	WCHAR Path[MAX_PATH];
+	PVOID Data; // Already in memory (directory listing), NULL to read from disk
+	DWORD Size;
+	BOOLEAN Included;
+} SFPD_WARM_CACHE_CANDIDATE, * PSFPD_WARM_CACHE_CANDIDATE;
+
+static ULONG QuerySFPDCacheBudget(WDFDEVICE device, PCUNICODE_STRING ValueName, ULONG DefaultBudget)
+{
+	WDFKEY Key = NULL;
+	ULONG Budget = DefaultBudget;
+
+	if (NT_SUCCESS(WdfDeviceOpenRegistryKey(device, PLUGPLAY_REGKEY_DEVICE, KEY_READ, WDF_NO_OBJECT_ATTRIBUTES, &Key)))
+	{
+		if (!NT_SUCCESS(WdfRegistryQueryULong(Key, ValueName, &Budget)))
+		{
+			Budget = DefaultBudget;
+		}
+
+		WdfRegistryClose(Key);
+	}
+
+	return Budget;
+}
+
+static ULONG GetSFPDWarmCacheCost(PSFPD_WARM_CACHE_CANDIDATE Candidate)
+{
+	size_t PathLength = 0;
+
+	if (!NT_SUCCESS(RtlStringCchLengthW(Candidate->Path, MAX_PATH, &PathLength)))
+	{
+		PathLength = MAX_PATH - 1;
+	}
+
+	ULONGLONG Cost = sizeof(SFPD_WARM_CACHE_ENTRY) +
+		ALIGN_UP_BY((PathLength + 1) * sizeof(WCHAR), sizeof(ULONGLONG)) +
+		ALIGN_UP_BY((ULONGLONG)Candidate->Size, sizeof(ULONGLONG));
+
+	// A size from a directory record near 4 GiB must not truncate into a small cost
+	return Cost > MAXULONG ? MAXULONG : (ULONG)Cost;
+}
+
+//
+// Loads the sfpd files into one read-only arena, bounded by the registry budget.
+// Runs once per device start, from the discovery work item at PASSIVE_LEVEL.
+//
+NTSTATUS WarmSFPDCache(WDFDEVICE device)
+{
+	NTSTATUS status = STATUS_UNSUCCESSFUL;
+	PSFPD_DEVICE_CONTEXT SFPDContext = GetSFPDDeviceContext(device);
+	PSFPD_WARM_CACHE_CANDIDATE Candidates = NULL;
+	PUCHAR SensorRecords = NULL;
+	PSFPD_WARM_CACHE WarmCache = NULL;
+	DWORD NumberOfSensorFiles = 0;
+	DWORD CandidateCount = 0;
+	DWORD IncludedCount = 0;
+	ULONGLONG StartTime = KeQueryInterruptTime();
+	LONG CacheGeneration = GetSFPDCacheGeneration(device);
+	DECLARE_CONST_UNICODE_STRING(BudgetValueName, SFPD_WARM_CACHE_BUDGET_VALUE_NAME);
+
+	ULONG Budget = QuerySFPDCacheBudget(device, &BudgetValueName, 0);
+	ULONG ArenaSize = FIELD_OFFSET(SFPD_WARM_CACHE, Entries) + sizeof(ULONGLONG);
+
+	// Disabled, or too small for even the arena header. Without the watcher
+	// nothing would tell the arena that an item changed.
+	if (Budget <= ArenaSize || !SFPDContext->WatcherActive)
+	{
+		status = STATUS_SUCCESS;
+		goto exit;
+	}
+
+	//
+	// The sensor listing is both a cached directory and the list of sensor files to load
+	//
+	status = GetSFPDNumberOfFilesInDirectory(device, SENSOR_DATA_DIRECTORY, &NumberOfSensorFiles);
+
+	if (!NT_SUCCESS(status))
+	{
+		NumberOfSensorFiles = 0;
+	}
+
+	if (NumberOfSensorFiles != 0)
+	{
+		SensorRecords = (PUCHAR)ExAllocatePoolWithTag(PagedPool, NumberOfSensorFiles * SFPD_DIRECTORY_RECORD_SIZE, POOL_TAG_WARMCACHE);
+
+		if (SensorRecords == NULL)
+		{
+			status = STATUS_INSUFFICIENT_RESOURCES;
+			goto exit;
+		}
+
+		RtlZeroMemory(SensorRecords, NumberOfSensorFiles * SFPD_DIRECTORY_RECORD_SIZE);
+
+		status = GetSFPDFilesInDirectory(device, SENSOR_DATA_DIRECTORY, NumberOfSensorFiles, SensorRecords);
+
+		if (!NT_SUCCESS(status))
+		{
+			NumberOfSensorFiles = 0;
+		}
+	}
+
+	DWORD MaximumCandidates = ARRAYSIZE(SFPDWarmCacheItems) + 1 + NumberOfSensorFiles;
+
+	Candidates = (PSFPD_WARM_CACHE_CANDIDATE)ExAllocatePoolWithTag(PagedPool, MaximumCandidates * sizeof(SFPD_WARM_CACHE_CANDIDATE), POOL_TAG_WARMCACHE);
+
+	if (Candidates == NULL)
+	{
+		status = STATUS_INSUFFICIENT_RESOURCES;
+		goto exit;
+	}
+
+	RtlZeroMemory(Candidates, MaximumCandidates * sizeof(SFPD_WARM_CACHE_CANDIDATE));
+
+	if (NumberOfSensorFiles != 0)
+	{
+		PSFPD_WARM_CACHE_CANDIDATE Candidate = &Candidates[CandidateCount];
+
+		if (NT_SUCCESS(RtlStringCchCopyW(Candidate->Path, MAX_PATH, SENSOR_DATA_DIRECTORY)))
+		{
+			Candidate->Data = SensorRecords;
+			Candidate->Size = NumberOfSensorFiles * SFPD_DIRECTORY_RECORD_SIZE;
+			CandidateCount++;
+		}
+	}
+
+	for (DWORD i = 0; i < NumberOfSensorFiles; i++)
+	{
+		PSFPD_WARM_CACHE_CANDIDATE Candidate = &Candidates[CandidateCount];
+		PUCHAR Record = SensorRecords + i * SFPD_DIRECTORY_RECORD_SIZE;
+
+		if (!NT_SUCCESS(RtlStringCchCopyW(Candidate->Path, MAX_PATH, SENSOR_DATA_DIRECTORY L"\\")) ||
+			!NT_SUCCESS(RtlStringCchCatNW(Candidate->Path, MAX_PATH, (WCHAR*)Record, SFPD_DIRECTORY_RECORD_NAME_LENGTH)))
+		{
+			continue;
+		}
+
+		Candidate->Size = *(DWORD*)(Record + SFPD_DIRECTORY_RECORD_FILE_SIZE_OFFSET);
+		CandidateCount++;
+	}
+
+	for (DWORD i = 0; i < ARRAYSIZE(SFPDWarmCacheItems); i++)
+	{
+		PSFPD_WARM_CACHE_CANDIDATE Candidate = &Candidates[CandidateCount];
+
+		if (!NT_SUCCESS(RtlStringCchCopyW(Candidate->Path, MAX_PATH, SFPDWarmCacheItems[i])))
+		{
+			continue;
+		}
+
+		// Not every device revision has every file
+		if (!NT_SUCCESS(GetSFPDItemSize(device, Candidate->Path, &Candidate->Size)))
+		{
+			continue;
+		}
+
+		CandidateCount++;
+	}
+
+	//
+	// Take items in order until the budget is used up, anything left out is read from disk as before.
+	// ArenaSize never exceeds Budget, so the subtraction below cannot wrap.
+	//
+	for (DWORD i = 0; i < CandidateCount; i++)
+	{
+		ULONG Cost = GetSFPDWarmCacheCost(&Candidates[i]);
+
+		if (Candidates[i].Size == 0 || Cost > Budget - ArenaSize)
+		{
+			continue;
+		}
+
+		ArenaSize += Cost;
+		Candidates[i].Included = TRUE;
+		IncludedCount++;
+	}
+
+	if (IncludedCount == 0)
+	{
+		status = STATUS_SUCCESS;
+		goto exit;
+	}
+
+	WarmCache = (PSFPD_WARM_CACHE)ExAllocatePoolWithTag(NonPagedPoolNx, ArenaSize, POOL_TAG_WARMCACHE);
+
+	if (WarmCache == NULL)
+	{
+		status = STATUS_INSUFFICIENT_RESOURCES;
+		goto exit;
+	}
+
+	RtlZeroMemory(WarmCache, ArenaSize);
+
+	WarmCache->ArenaSize = ArenaSize;
+
+	ULONG Cursor = (ULONG)ALIGN_UP_BY(FIELD_OFFSET(SFPD_WARM_CACHE, Entries) + IncludedCount * sizeof(SFPD_WARM_CACHE_ENTRY), sizeof(ULONGLONG));
+
+	for (DWORD i = 0; i < CandidateCount; i++)
+	{
+		PSFPD_WARM_CACHE_CANDIDATE Candidate = &Candidates[i];
+		PSFPD_WARM_CACHE_ENTRY Entry = &WarmCache->Entries[WarmCache->EntryCount];
+		DWORD ActualSize = 0;
+
+		if (!Candidate->Included)
+		{
+			continue;
+		}
+
+		size_t PathLength = 0;
+		RtlStringCchLengthW(Candidate->Path, MAX_PATH, &PathLength);
+
+		Entry->PathOffset = Cursor;
+		RtlCopyMemory((PUCHAR)WarmCache + Cursor, Candidate->Path, PathLength * sizeof(WCHAR));
+		Cursor += (ULONG)ALIGN_UP_BY((PathLength + 1) * sizeof(WCHAR), sizeof(ULONGLONG));
+
+		Entry->DataOffset = Cursor;
+		Entry->DataSize = Candidate->Size;
+		Cursor += (ULONG)ALIGN_UP_BY(Candidate->Size, sizeof(ULONGLONG));
+
+		if (Candidate->Data != NULL)
+		{
+			RtlCopyMemory((PUCHAR)WarmCache + Entry->DataOffset, Candidate->Data, Candidate->Size);
+		}
+		else if (!NT_SUCCESS(GetSFPDItemWithSize(device, Candidate->Path, (PUCHAR)WarmCache + Entry->DataOffset, Candidate->Size, &ActualSize)) ||
+			ActualSize != Candidate->Size)
+		{
+			// Changed under us, leave it out of the index and let it be read from disk
+			continue;
+		}
+
+		WarmCache->EntryCount++;
+	}
+
+	// Something changed while the arena was being filled, better luck on the next start
+	if (CacheGeneration != SFPDContext->CacheGeneration)
+	{
+		status = STATUS_RETRY;
+		goto exit;
+	}
+
+	if (InterlockedCompareExchangePointer((PVOID volatile*)&SFPDContext->WarmCache, WarmCache, NULL) == NULL)
+	{
+		// A change seen between the check above and publishing could not mark anything stale
+		if (CacheGeneration != SFPDContext->CacheGeneration)
+		{
+			InvalidateSFPDCachePath(device, NULL);
+		}
+
+		Trace(
+			TRACE_LEVEL_INFORMATION,
+			TRACE_DRIVER,
+			"SFPD warm cache ready - %u items, %u bytes, %I64u ms",
+			WarmCache->EntryCount,
+			WarmCache->ArenaSize,
+			(KeQueryInterruptTime() - StartTime) / MILLISECONDS(1));
+
+		WarmCache = NULL;
+	}
+
+	status = STATUS_SUCCESS;
+
+exit:
+	if (WarmCache != NULL)
+	{
+		ExFreePoolWithTag(WarmCache, POOL_TAG_WARMCACHE);
+	}
+
+	if (Candidates != NULL)
+	{
+		ExFreePoolWithTag(Candidates, POOL_TAG_WARMCACHE);
+	}
+
+	if (SensorRecords != NULL)
+	{
+		ExFreePoolWithTag(SensorRecords, POOL_TAG_WARMCACHE);
+	}
+
+	return status;
+}
+
+VOID FreeSFPDWarmCache(WDFDEVICE device)
+{
+	PSFPD_DEVICE_CONTEXT SFPDContext = GetSFPDDeviceContext(device);
+	PSFPD_WARM_CACHE WarmCache = (PSFPD_WARM_CACHE)InterlockedExchangePointer((PVOID volatile*)&SFPDContext->WarmCache, NULL);
+
+	if (WarmCache != NULL)
+	{
+		Trace(
+			TRACE_LEVEL_INFORMATION,
+			TRACE_DRIVER,
+			"SFPD warm cache freed - hits: %d",
+			SFPDContext->WarmCacheHits);
+
+		ExFreePoolWithTag(WarmCache, POOL_TAG_WARMCACHE);
+	}
+}
+
+//
+// On a hit, Data points into the arena and stays valid until the device is cleaned up
+//
+BOOLEAN LookupSFPDWarmCache(WDFDEVICE device, WCHAR* ItemPath, PVOID* Data, DWORD* DataSize)
+{
+	PSFPD_DEVICE_CONTEXT SFPDContext = GetSFPDDeviceContext(device);
+	PSFPD_WARM_CACHE WarmCache = SFPDContext->WarmCache;
+
+	if (WarmCache == NULL || ItemPath == NULL)
+	{
+		return FALSE;
+	}
+
+	for (ULONG i = 0; i < WarmCache->EntryCount; i++)
+	{
+		PSFPD_WARM_CACHE_ENTRY Entry = &WarmCache->Entries[i];
+
+		if (!Entry->Stale && IsSFPDPathEqualNoCase((WCHAR*)((PUCHAR)WarmCache + Entry->PathOffset), ItemPath))
+		{
+			*Data = (PUCHAR)WarmCache + Entry->DataOffset;
+			*DataSize = Entry->DataSize;
+
+			InterlockedIncrement(&SFPDContext->WarmCacheHits);
+
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+static PVOID AllocateSFPDContentCacheBlock(SIZE_T Size)
+{
+	return ExAllocatePoolWithTag(PagedPool, Size, POOL_TAG_CONTENTCACHE);
+}
+
+static VOID FreeSFPDContentCacheBlock(PVOID Block)
+{
+	ExFreePoolWithTag(Block, POOL_TAG_CONTENTCACHE);
+}
+
+// Must be called with ContentCacheLock held
+static VOID DropStaleSFPDContentCache(PSFPD_DEVICE_CONTEXT SFPDContext)
+{
+	if (InterlockedExchange(&SFPDContext->ContentCacheStale, FALSE))
+	{
+		ClearSFPDContentCache(&SFPDContext->ContentCache);
+	}
+}
+
+NTSTATUS InitializeSFPDContentCache(WDFDEVICE device)
+{
+	NTSTATUS status = STATUS_UNSUCCESSFUL;
+	PSFPD_DEVICE_CONTEXT SFPDContext = GetSFPDDeviceContext(device);
+	WDF_OBJECT_ATTRIBUTES Attributes;
+	DECLARE_CONST_UNICODE_STRING(BudgetValueName, SFPD_CONTENT_CACHE_BUDGET_VALUE_NAME);
+
+	InitializeSFPDContentCacheList(&SFPDContext->ContentCache,
+		QuerySFPDCacheBudget(device, &BudgetValueName, SFPD_CONTENT_CACHE_DEFAULT_BUDGET),
+		AllocateSFPDContentCacheBlock,
+		FreeSFPDContentCacheBlock);
+	KeInitializeEvent(&SFPDContext->WatcherStopEvent, NotificationEvent, FALSE);
+	KeInitializeEvent(&SFPDContext->WatcherReadyEvent, NotificationEvent, FALSE);
+
+	WDF_OBJECT_ATTRIBUTES_INIT(&Attributes);
+	Attributes.ParentObject = device;
+
+	status = WdfWaitLockCreate(&Attributes, &SFPDContext->ContentCacheLock);
+
+	return status;
+}
+
+VOID FlushSFPDContentCache(WDFDEVICE device)
+{
+	PSFPD_DEVICE_CONTEXT SFPDContext = GetSFPDDeviceContext(device);
+	PSFPD_CONTENT_CACHE ContentCache = &SFPDContext->ContentCache;
+
+	WdfWaitLockAcquire(SFPDContext->ContentCacheLock, NULL);
+
+	ClearSFPDContentCache(ContentCache);
+	InterlockedExchange(&SFPDContext->ContentCacheStale, FALSE);
+
+	Trace(
+		TRACE_LEVEL_INFORMATION,
+		TRACE_DRIVER,
+		"SFPD content cache flushed - hits: %d, misses: %d, evictions: %d",
+		ContentCache->Hits,
+		ContentCache->Misses,
+		ContentCache->Evictions);
+
+	WdfWaitLockRelease(SFPDContext->ContentCacheLock);
+}
+
+//
+// Taken before an item is read from disk and handed back to InsertSFPDContentCache
+//
+LONG GetSFPDCacheGeneration(WDFDEVICE device)
+{
+	return GetSFPDDeviceContext(device)->CacheGeneration;
+}
+
+//
+// Keeps a copy of a whole item that was just read from disk, evicting the least
+// recently used items until it fits in the budget. Items larger than the whole
+// budget are not cached.
+//
+VOID InsertSFPDContentCache(WDFDEVICE device, WCHAR* ItemPath, PVOID Data, DWORD DataSize, LONG Generation)
+{
+	PSFPD_DEVICE_CONTEXT SFPDContext = GetSFPDDeviceContext(device);
+	PSFPD_CONTENT_CACHE ContentCache = &SFPDContext->ContentCache;
+	PSFPD_CONTENT_CACHE_ENTRY Entry = NULL;
+
+	if (!SFPDContext->WatcherActive)
+	{
+		return;
+	}
+
+	Entry = CreateSFPDContentCacheEntry(ContentCache, ItemPath, Data, DataSize);
+
+	if (Entry == NULL)
+	{
+		return;
+	}
+
+	WdfWaitLockAcquire(SFPDContext->ContentCacheLock, NULL);
+
+	DropStaleSFPDContentCache(SFPDContext);
+
+	// Refused when the item changed while it was being read, or nobody is watching for changes anymore
+	if (!SFPDContext->WatcherActive ||
+		!InsertSFPDContentCacheEntry(ContentCache, Entry, Generation, SFPDContext->CacheGeneration))
+	{
+		FreeSFPDContentCacheBlock(Entry);
+	}
+
+	WdfWaitLockRelease(SFPDContext->ContentCacheLock);
+}
+
+//
+// Looks an item up in the warm cache, then in the content cache. On a hit, ItemSize
+// receives the full size of the item and, if it fits in DataSize, the item is copied
+// to Data. Returns FALSE if the item has to be read from disk.
+//
+BOOLEAN ReadSFPDCache(WDFDEVICE device, WCHAR* ItemPath, PVOID Data, DWORD DataSize, DWORD* ItemSize)
+{
+	PSFPD_DEVICE_CONTEXT SFPDContext = GetSFPDDeviceContext(device);
+	PSFPD_CONTENT_CACHE ContentCache = &SFPDContext->ContentCache;
+	PVOID CachedData = NULL;
+	DWORD CachedDataSize = 0;
+	BOOLEAN CacheHit = FALSE;
+
+	if (ItemPath == NULL || ItemSize == NULL)
+	{
+		return FALSE;
+	}
+
+	if (LookupSFPDWarmCache(device, ItemPath, &CachedData, &CachedDataSize))
+	{
+		*ItemSize = CachedDataSize;
+
+		if (Data != NULL && DataSize >= CachedDataSize)
+		{
+			RtlCopyMemory(Data, CachedData, CachedDataSize);
+		}
+
+		return TRUE;
+	}
+
+	if (ContentCache->Budget == 0)
+	{
+		return FALSE;
+	}
+
+	WdfWaitLockAcquire(SFPDContext->ContentCacheLock, NULL);
+
+	DropStaleSFPDContentCache(SFPDContext);
+
+	PSFPD_CONTENT_CACHE_ENTRY Entry = LookupSFPDContentCacheEntry(ContentCache, ItemPath);
+
+	if (Entry != NULL)
+	{
+		*ItemSize = Entry->DataSize;
+
+		if (Data != NULL && DataSize >= Entry->DataSize)
+		{
+			RtlCopyMemory(Data, Entry->Data, Entry->DataSize);
+		}
+
+		CacheHit = TRUE;
+	}
+
+	WdfWaitLockRelease(SFPDContext->ContentCacheLock);
+
+	return CacheHit;
+}
+
+//
+// Drops everything cached for ItemPath, for anything below it and for the
+// listings of the directories it is in. A NULL ItemPath drops everything.
+//
+static VOID InvalidateSFPDCachePath(WDFDEVICE device, WCHAR* ItemPath)
+{
+	PSFPD_DEVICE_CONTEXT SFPDContext = GetSFPDDeviceContext(device);
+	PSFPD_CONTENT_CACHE ContentCache = &SFPDContext->ContentCache;
+	PSFPD_WARM_CACHE WarmCache = SFPDContext->WarmCache;
+
+	// First, so that reads already in flight do not make it into the cache
+	InterlockedIncrement(&SFPDContext->CacheGeneration);
+
+	// A replaced file would still be reached through its old handle
+	InterlockedExchange(&SFPDContext->HandleCacheStale, TRUE);
+
+	if (WarmCache != NULL)
+	{
+		for (ULONG i = 0; i < WarmCache->EntryCount; i++)
+		{
+			PSFPD_WARM_CACHE_ENTRY Entry = &WarmCache->Entries[i];
+
+			if (ItemPath == NULL || IsSFPDPathRelated((WCHAR*)((PUCHAR)WarmCache + Entry->PathOffset), ItemPath))
+			{
+				InterlockedExchange(&Entry->Stale, TRUE);
+			}
+		}
+	}
+
+	WdfWaitLockAcquire(SFPDContext->ContentCacheLock, NULL);
+
+	InvalidateSFPDContentCache(ContentCache, ItemPath);
+
+	WdfWaitLockRelease(SFPDContext->ContentCacheLock);
+}
+
+static VOID InvalidateSFPDCacheNotifications(WDFDEVICE device, PUCHAR Buffer, ULONG BufferSize)
+{
+	WCHAR ItemPath[MAX_PATH];
+	ULONG Offset = 0;
+
+	while (Offset + FIELD_OFFSET(FILE_NOTIFY_INFORMATION, FileName) <= BufferSize)
+	{
+		PFILE_NOTIFY_INFORMATION Notification = (PFILE_NOTIFY_INFORMATION)(Buffer + Offset);
+
+		if (Offset + FIELD_OFFSET(FILE_NOTIFY_INFORMATION, FileName) + Notification->FileNameLength > BufferSize ||
+			!NT_SUCCESS(RtlStringCchCopyW(ItemPath, MAX_PATH, L"\\")) ||
+			!NT_SUCCESS(RtlStringCchCatNW(ItemPath, MAX_PATH, Notification->FileName, Notification->FileNameLength / sizeof(WCHAR))))
+		{
+			// Can't tell what changed, so assume everything did
+			InvalidateSFPDCachePath(device, NULL);
+			return;
+		}
+
+		InvalidateSFPDCachePath(device, ItemPath);
+
+		Trace(
+			TRACE_LEVEL_VERBOSE,
+			TRACE_DRIVER,
+			"SFPD item changed - %ws",
+			ItemPath);
+
+		if (Notification->NextEntryOffset == 0)
+		{
+			break;
+		}
+
+		Offset += Notification->NextEntryOffset;
+	}
+}
+
+//
+// Watches the whole sfpd volume, \sensors included, until the volume goes away or
+// StopSFPDWatcher is called. Caching is only allowed while this thread is watching.
+//
+static VOID OnSFPDWatcherThread(PVOID Context)
+{
+	NTSTATUS status = STATUS_UNSUCCESSFUL;
+	WDFDEVICE device = (WDFDEVICE)Context;
+	PSFPD_DEVICE_CONTEXT SFPDContext = GetSFPDDeviceContext(device);
+	WDFMEMORY VolumePathMemory = NULL;
+	WCHAR* VolumePath = NULL;
+	PUCHAR Buffer = NULL;
+	HANDLE DirectoryHandle = NULL;
+	HANDLE EventHandle = NULL;
+	PKEVENT EventObject = NULL;
+
+	VolumePath = (WCHAR*)AllocateSFPDScratch(device, SFPDScratchPath, &VolumePathMemory);
+	Buffer = (PUCHAR)ExAllocatePoolWithTag(NonPagedPoolNx, SFPD_WATCHER_BUFFER_SIZE, POOL_TAG_WATCHER);
+
+	if (VolumePath == NULL || Buffer == NULL)
+	{
+		status = STATUS_INSUFFICIENT_RESOURCES;
+		goto exit;
+	}
+
+	status = GetSFPDVolumePath(device, VolumePath, MAX_PATH);
+
+	if (!NT_SUCCESS(status))
+	{
+		goto exit;
+	}
+
+	UNICODE_STRING VolumePathUnicode;
+	RtlInitUnicodeString(&VolumePathUnicode, VolumePath);
+
+	OBJECT_ATTRIBUTES Attributes = { 0 };
+	InitializeObjectAttributes(&Attributes, &VolumePathUnicode, OBJ_CASE_INSENSITIVE | OBJ_KERNEL_HANDLE, NULL, NULL);
+
+	IO_STATUS_BLOCK IOStatusBlock = { 0 };
+
+	// Asynchronous, so the pending notification can be waited on together with the stop event
+	status = ZwCreateFile(&DirectoryHandle, FILE_LIST_DIRECTORY | SYNCHRONIZE, &Attributes, &IOStatusBlock, NULL, FILE_ATTRIBUTE_NORMAL, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, FILE_OPEN, FILE_DIRECTORY_FILE, NULL, 0);
+
+	if (!NT_SUCCESS(status))
+	{
+		DirectoryHandle = NULL;
+		goto exit;
+	}
+
+	InitializeObjectAttributes(&Attributes, NULL, OBJ_KERNEL_HANDLE, NULL, NULL);
+
+	status = ZwCreateEvent(&EventHandle, EVENT_ALL_ACCESS, &Attributes, NotificationEvent, FALSE);
+
+	if (!NT_SUCCESS(status))
+	{
+		EventHandle = NULL;
+		goto exit;
+	}
+
+	status = ObReferenceObjectByHandle(EventHandle, EVENT_ALL_ACCESS, *ExEventObjectType, KernelMode, (PVOID*)&EventObject, NULL);
+
+	if (!NT_SUCCESS(status))
+	{
+		EventObject = NULL;
+		goto exit;
+	}
+
+	while (TRUE)
+	{
+		status = ZwNotifyChangeDirectoryFile(DirectoryHandle, EventHandle, NULL, NULL, &IOStatusBlock, Buffer, SFPD_WATCHER_BUFFER_SIZE,
+			FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_CREATION, TRUE);
+
+		if (status == STATUS_PENDING)
+		{
+			if (!SFPDContext->WatcherActive)
+			{
+				// Anything read before now may have changed unseen
+				InterlockedIncrement(&SFPDContext->CacheGeneration);
+				InterlockedExchange(&SFPDContext->WatcherActive, TRUE);
+				KeSetEvent(&SFPDContext->WatcherReadyEvent, IO_NO_INCREMENT, FALSE);
+			}
+
+			PVOID WaitObjects[2] = { EventObject, &SFPDContext->WatcherStopEvent };
+
+			status = KeWaitForMultipleObjects(2, WaitObjects, WaitAny, Executive, KernelMode, FALSE, NULL, NULL);
+
+			if (status != STATUS_WAIT_0)
+			{
+				// Closing the directory completes the pending notification, wait for it
+				// before its buffer and status block go away
+				ZwClose(DirectoryHandle);
+				DirectoryHandle = NULL;
+
+				KeWaitForSingleObject(EventObject, Executive, KernelMode, FALSE, NULL);
+
+				status = STATUS_SUCCESS;
+				break;
+			}
+
+			status = IOStatusBlock.Status;
+		}
+
+		if (status == STATUS_NOTIFY_ENUM_DIR || (NT_SUCCESS(status) && IOStatusBlock.Information == 0))
+		{
+			// More changes than fit in the buffer
+			InvalidateSFPDCachePath(device, NULL);
+			RefreshVirtualFileSnapshots(device);
+			continue;
+		}
+
+		if (!NT_SUCCESS(status))
+		{
+			// Most likely the volume went away
+			break;
+		}
+
+		InvalidateSFPDCacheNotifications(device, Buffer, (ULONG)min(IOStatusBlock.Information, SFPD_WATCHER_BUFFER_SIZE));
+
+		// Rebuilt here rather than by the next request, which may come in at raised IRQL
+		RefreshVirtualFileSnapshots(device);
+	}
+
+exit:
+	// Without the watcher nothing cached can be trusted anymore
+	InterlockedExchange(&SFPDContext->WatcherActive, FALSE);
+	InvalidateSFPDCachePath(device, NULL);
+	KeSetEvent(&SFPDContext->WatcherReadyEvent, IO_NO_INCREMENT, FALSE);
+
+	Trace(
+		TRACE_LEVEL_INFORMATION,
+		TRACE_DRIVER,
+		"SFPD change watcher stopped - 0x%08lX",
+		status);
+
+	if (EventObject != NULL)
+	{
+		ObDereferenceObject(EventObject);
+	}
+
+	if (EventHandle != NULL)
+	{
+		ZwClose(EventHandle);
+	}
+
+	if (DirectoryHandle != NULL)
+	{
+		ZwClose(DirectoryHandle);
+	}
+
+	if (Buffer != NULL)
+	{
+		ExFreePoolWithTag(Buffer, POOL_TAG_WATCHER);
+	}
+
+	if (VolumePathMemory != NULL)
+	{
+		FreeSFPDScratch(device, VolumePathMemory);
+	}
+
+	PsTerminateSystemThread(status);
+}
+
+//
+// Called from the discovery work item once the volume is known. A watcher that
+// stopped because its volume went away is reaped and replaced.
+//
+NTSTATUS StartSFPDWatcher(WDFDEVICE device)
+{
+	NTSTATUS status = STATUS_UNSUCCESSFUL;
+	PSFPD_DEVICE_CONTEXT SFPDContext = GetSFPDDeviceContext(device);
+	HANDLE ThreadHandle = NULL;
+
+	if (SFPDContext->WatcherThread != NULL)
+	{
+		LARGE_INTEGER timeout = { 0 };
+
+		if (KeWaitForSingleObject(SFPDContext->WatcherThread, Executive, KernelMode, FALSE, &timeout) == STATUS_TIMEOUT)
+		{
+			status = STATUS_SUCCESS;
+			goto exit;
+		}
+
+		ObDereferenceObject(SFPDContext->WatcherThread);
+		SFPDContext->WatcherThread = NULL;
+	}
+
+	KeClearEvent(&SFPDContext->WatcherStopEvent);
+	KeClearEvent(&SFPDContext->WatcherReadyEvent);
+
+	OBJECT_ATTRIBUTES Attributes = { 0 };
+	InitializeObjectAttributes(&Attributes, NULL, OBJ_KERNEL_HANDLE, NULL, NULL);
+
+	status = PsCreateSystemThread(&ThreadHandle, THREAD_ALL_ACCESS, &Attributes, NULL, NULL, OnSFPDWatcherThread, (PVOID)device);
+
+	if (!NT_SUCCESS(status))
+	{
+		goto exit;
+	}
+
+	status = ObReferenceObjectByHandle(ThreadHandle, THREAD_ALL_ACCESS, *PsThreadType, KernelMode, (PVOID*)&SFPDContext->WatcherThread, NULL);
+
+	ZwClose(ThreadHandle);
+
+	if (!NT_SUCCESS(status))
+	{
+		// The thread runs on regardless, make it exit
+		SFPDContext->WatcherThread = NULL;
+		KeSetEvent(&SFPDContext->WatcherStopEvent, IO_NO_INCREMENT, FALSE);
+		goto exit;
+	}
+
+	// Let the first notification get posted, so warm-up right after this is covered
+	LARGE_INTEGER timeout = { 0 };
+	timeout.QuadPart = RELATIVE(MILLISECONDS(SFPD_DISCOVERY_TIMEOUT_MS));
+
+	KeWaitForSingleObject(&SFPDContext->WatcherReadyEvent, Executive, KernelMode, FALSE, &timeout);
+
+exit:
+	return status;
+}
+
+VOID StopSFPDWatcher(WDFDEVICE device)
+{
+	PSFPD_DEVICE_CONTEXT SFPDContext = GetSFPDDeviceContext(device);
+
+	if (SFPDContext->WatcherThread == NULL)
+	{
+		return;
+	}
+
+	KeSetEvent(&SFPDContext->WatcherStopEvent, IO_NO_INCREMENT, FALSE);
+	KeWaitForSingleObject(SFPDContext->WatcherThread, Executive, KernelMode, FALSE, NULL);
+
+	ObDereferenceObject(SFPDContext->WatcherThread);
+	SFPDContext->WatcherThread = NULL;
+}
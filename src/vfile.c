@@ -0,0 +1,452 @@
+/*++
+
+Copyright (c) 2021-2024 DuoWoA authors. All Rights Reserved.
+
+Module Name:
+
+	vfile.c
+
+Abstract:
+
+	This file contains the virtual file functions.
+
+Environment:
+
+	Kernel-mode Driver Framework
+
+--*/
+
+#include "vfile.h"
+#include "sfpd.h"
+#include "sfpdcache.h"
+#include "constants.h"
+#include <trace.h>
+#include <vfile.tmh>
+
+static VIRTUAL_FILE_SIZE_PROVIDER GetVirtualFileBlobSize;
+static VIRTUAL_FILE_CONTENT_PROVIDER ReadVirtualFileBlob;
+static VIRTUAL_FILE_SIZE_PROVIDER GetPackedVirtualFileBlobSize;
+static VIRTUAL_FILE_CONTENT_PROVIDER ReadPackedVirtualFileBlob;
+static VIRTUAL_FILE_CONTENT_PROVIDER ReadVirtualFileSnapshot;
+static BOOLEAN CopyVirtualFileSnapshot(WDFDEVICE device, PVIRTUAL_FILE File, PVOID Data, BOOLEAN* Patched);
+static VIRTUAL_FILE_SIZE_PROVIDER GetSensorFileSize;
+static VIRTUAL_FILE_CONTENT_PROVIDER ReadSensorFile;
+static EVT_WDF_OBJECT_CONTEXT_CLEANUP OnVirtualFileDeviceContextCleanup;
+
+static VIRTUAL_FILE_PATCH PatchBTProvision;
+static VIRTUAL_FILE_PATCH PatchWLANProvision;
+
+//
+// Every path this filter answers for, generated from src\vfile.manifest. Adding a
+// provisioning blob only takes a new line there, both ReadFile and
+// GetFileProperty pick it up.
+//
+#include "blobunpack.h"
+#include "packedblobs.h"
+#include "vfiletable.h"
+#include "vfilelookup.h"
+
+//
+// Requests are dispatched in parallel, so nothing in here is written once a
+// device is up: VirtualFiles and the templates in constants.c are read only.
+// Derived files are patched per device into a snapshot of their own, built
+// as soon as sfpd is found and again whenever the sfpd cache generation moves
+// on, so answering for them is a copy. Snapshots are replaced under
+// SnapshotLock and only ever copied from with it held, which is cheap enough
+// for blobs this size and lets a replaced one be freed right away. A patch
+// that fails publishes the unpatched template instead, so a missing or bad
+// sfpd item costs one attempt per generation rather than one per request.
+//
+typedef struct _VIRTUAL_FILE_SNAPSHOT
+{
+	LONG Generation; // sfpd cache generation the patch read from
+	BOOLEAN Patched; // FALSE when Data is the unpatched template
+	UCHAR Data[ANYSIZE_ARRAY];
+} VIRTUAL_FILE_SNAPSHOT, * PVIRTUAL_FILE_SNAPSHOT;
+
+typedef struct _VIRTUAL_FILE_DEVICE_CONTEXT
+{
+	WDFSPINLOCK SnapshotLock;
+	PVIRTUAL_FILE_SNAPSHOT Snapshots[VIRTUAL_FILE_COUNT];
+
+	LONG SnapshotBuilds;
+} VIRTUAL_FILE_DEVICE_CONTEXT, * PVIRTUAL_FILE_DEVICE_CONTEXT;
+
+WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(VIRTUAL_FILE_DEVICE_CONTEXT, GetVirtualFileDeviceContext)
+
+#define POOL_TAG_VIRTUALFILE 'FVFS'
+
+NTSTATUS InitializeVirtualFileDeviceContext(WDFDEVICE device)
+{
+	NTSTATUS status = STATUS_UNSUCCESSFUL;
+	PVIRTUAL_FILE_DEVICE_CONTEXT VirtualFileContext = NULL;
+	WDF_OBJECT_ATTRIBUTES Attributes;
+
+	WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&Attributes, VIRTUAL_FILE_DEVICE_CONTEXT);
+	Attributes.EvtCleanupCallback = OnVirtualFileDeviceContextCleanup;
+
+	status = WdfObjectAllocateContext(device, &Attributes, (PVOID*)&VirtualFileContext);
+
+	if (!NT_SUCCESS(status))
+	{
+		goto exit;
+	}
+
+	WDF_OBJECT_ATTRIBUTES_INIT(&Attributes);
+	Attributes.ParentObject = device;
+
+	status = WdfSpinLockCreate(&Attributes, &VirtualFileContext->SnapshotLock);
+
+exit:
+	return status;
+}
+
+static VOID OnVirtualFileDeviceContextCleanup(WDFOBJECT Object)
+{
+	PVIRTUAL_FILE_DEVICE_CONTEXT VirtualFileContext = GetVirtualFileDeviceContext(Object);
+
+	for (ULONG i = 0; i < VIRTUAL_FILE_COUNT; i++)
+	{
+		if (VirtualFileContext->Snapshots[i] != NULL)
+		{
+			ExFreePoolWithTag(VirtualFileContext->Snapshots[i], POOL_TAG_VIRTUALFILE);
+			VirtualFileContext->Snapshots[i] = NULL;
+		}
+	}
+}
+
+// See vfilelookup.h, shared with tools\vfilebench.c
+PVIRTUAL_FILE LookupVirtualFile(PWCHAR RequestPath)
+{
+	return FindVirtualFile(RequestPath);
+}
+
+//
+// Whether answering for File, its content or else just its size, may read
+// sfpd and so has to happen at PASSIVE_LEVEL. Everything else is served from
+// non-paged memory.
+//
+BOOLEAN VirtualFileNeedsIo(WDFDEVICE device, PVIRTUAL_FILE File, BOOLEAN Content)
+{
+	switch (File->Kind)
+	{
+	case VirtualFileSFPD:
+		return TRUE;
+	case VirtualFileDerived:
+		return Content && !CopyVirtualFileSnapshot(device, File, NULL, NULL);
+	default:
+		return FALSE;
+	}
+}
+
+static NTSTATUS GetVirtualFileBlobSize(WDFDEVICE device, PVIRTUAL_FILE File, PWCHAR RequestPath, DWORD* FileSize)
+{
+	UNREFERENCED_PARAMETER(device);
+	UNREFERENCED_PARAMETER(RequestPath);
+
+	*FileSize = File->DataSize;
+
+	return STATUS_SUCCESS;
+}
+
+static NTSTATUS ReadVirtualFileBlob(WDFDEVICE device, PVIRTUAL_FILE File, PWCHAR RequestPath, PVOID Data, DWORD DataSize, DWORD* FileSize)
+{
+	UNREFERENCED_PARAMETER(device);
+	UNREFERENCED_PARAMETER(RequestPath);
+
+	*FileSize = File->DataSize;
+
+	if (DataSize < File->DataSize)
+	{
+		return STATUS_BUFFER_TOO_SMALL;
+	}
+
+	RtlCopyMemory(Data, File->Data, File->DataSize);
+
+	return STATUS_SUCCESS;
+}
+
+//
+// Packed blobs, see tools\blobpack.py for the format. Data is the packed
+// stream and DataSize its length, the unpacked size leads the stream.
+//
+static NTSTATUS GetPackedVirtualFileBlobSize(WDFDEVICE device, PVIRTUAL_FILE File, PWCHAR RequestPath, DWORD* FileSize)
+{
+	UNREFERENCED_PARAMETER(device);
+	UNREFERENCED_PARAMETER(RequestPath);
+
+	*FileSize = GetPackedBlobSize((const BYTE*)File->Data);
+
+	return STATUS_SUCCESS;
+}
+
+// Expands the runs straight into the reply, there is no unpacked copy anywhere
+static NTSTATUS ReadPackedVirtualFileBlob(WDFDEVICE device, PVIRTUAL_FILE File, PWCHAR RequestPath, PVOID Data, DWORD DataSize, DWORD* FileSize)
+{
+	UNREFERENCED_PARAMETER(device);
+	UNREFERENCED_PARAMETER(RequestPath);
+
+	return UnpackBlob((const BYTE*)File->Data, File->DataSize, Data, DataSize, FileSize);
+}
+
+//
+// Patches a fresh copy of File's template and publishes it, unless a snapshot
+// of a later generation made it in first. When the patch fails the template
+// is published as is, stamped with the same generation. Must be called at
+// PASSIVE_LEVEL.
+//
+static NTSTATUS BuildVirtualFileSnapshot(WDFDEVICE device, PVIRTUAL_FILE File)
+{
+	NTSTATUS status = STATUS_UNSUCCESSFUL;
+	PVIRTUAL_FILE_DEVICE_CONTEXT VirtualFileContext = GetVirtualFileDeviceContext(device);
+	ULONG Index = (ULONG)(File - VirtualFiles);
+	PVIRTUAL_FILE_SNAPSHOT Snapshot = NULL;
+
+	// Taken before reading, a change made while patching leaves the snapshot stale
+	LONG Generation = GetSFPDCacheGeneration(device);
+
+	Snapshot = (PVIRTUAL_FILE_SNAPSHOT)ExAllocatePoolWithTag(NonPagedPoolNx, FIELD_OFFSET(VIRTUAL_FILE_SNAPSHOT, Data) + File->DataSize, POOL_TAG_VIRTUALFILE);
+
+	if (Snapshot == NULL)
+	{
+		status = STATUS_INSUFFICIENT_RESOURCES;
+		goto exit;
+	}
+
+	Snapshot->Generation = Generation;
+	Snapshot->Patched = TRUE;
+	RtlCopyMemory(Snapshot->Data, File->Data, File->DataSize);
+
+	status = File->Patch(device, Snapshot->Data);
+
+	if (!NT_SUCCESS(status))
+	{
+		// Nothing retries before the next invalidation, so this is traced once per generation
+		Trace(
+			TRACE_LEVEL_WARNING,
+			TRACE_DRIVER,
+			"Virtual file %ws left unpatched - 0x%08lX",
+			File->Path,
+			status);
+
+		Snapshot->Patched = FALSE;
+		RtlCopyMemory(Snapshot->Data, File->Data, File->DataSize);
+		status = STATUS_SUCCESS;
+	}
+
+	WdfSpinLockAcquire(VirtualFileContext->SnapshotLock);
+
+	PVIRTUAL_FILE_SNAPSHOT Replaced = VirtualFileContext->Snapshots[Index];
+	LONG Age = Replaced != NULL ? (LONG)((ULONG)Generation - (ULONG)Replaced->Generation) : 0;
+
+	// Newer wins, compared the wrapping way so a wrapped counter still counts as newer,
+	// and a patched snapshot replaces the template of the same generation
+	if (Replaced == NULL || Age > 0 || (Age == 0 && Snapshot->Patched && !Replaced->Patched))
+	{
+		VirtualFileContext->Snapshots[Index] = Snapshot;
+		Snapshot = Replaced;
+	}
+
+	WdfSpinLockRelease(VirtualFileContext->SnapshotLock);
+
+	InterlockedIncrement(&VirtualFileContext->SnapshotBuilds);
+
+exit:
+	if (Snapshot != NULL)
+	{
+		ExFreePoolWithTag(Snapshot, POOL_TAG_VIRTUALFILE);
+	}
+
+	return status;
+}
+
+//
+// Copies this device's snapshot of File into Data, or the unpatched template
+// when there is none yet. A NULL Data only checks. Returns whether the
+// snapshot is current, and in Patched whether it has the device's data.
+//
+static BOOLEAN CopyVirtualFileSnapshot(WDFDEVICE device, PVIRTUAL_FILE File, PVOID Data, BOOLEAN* Patched)
+{
+	PVIRTUAL_FILE_DEVICE_CONTEXT VirtualFileContext = GetVirtualFileDeviceContext(device);
+	LONG Generation = GetSFPDCacheGeneration(device);
+	BOOLEAN Current = FALSE;
+
+	WdfSpinLockAcquire(VirtualFileContext->SnapshotLock);
+
+	PVIRTUAL_FILE_SNAPSHOT Snapshot = VirtualFileContext->Snapshots[File - VirtualFiles];
+
+	if (Snapshot != NULL)
+	{
+		Current = Snapshot->Generation == Generation;
+	}
+
+	if (Patched != NULL)
+	{
+		*Patched = Snapshot != NULL && Snapshot->Patched;
+	}
+
+	if (Data != NULL)
+	{
+		RtlCopyMemory(Data, Snapshot != NULL ? Snapshot->Data : File->Data, File->DataSize);
+	}
+
+	WdfSpinLockRelease(VirtualFileContext->SnapshotLock);
+
+	return Current;
+}
+
+//
+// Builds the snapshots of every derived file. Called once sfpd is found and
+// after it changed, so requests rarely have to build one themselves. A
+// current template left by a failed patch is retried too, sfpd may have only
+// just shown up without the generation moving. Must be called at
+// PASSIVE_LEVEL.
+//
+VOID RefreshVirtualFileSnapshots(WDFDEVICE device)
+{
+	for (ULONG i = 0; i < VIRTUAL_FILE_COUNT; i++)
+	{
+		PVIRTUAL_FILE File = &VirtualFiles[i];
+		BOOLEAN Patched = FALSE;
+
+		if (File->Kind != VirtualFileDerived || (CopyVirtualFileSnapshot(device, File, NULL, &Patched) && Patched))
+		{
+			continue;
+		}
+
+		BuildVirtualFileSnapshot(device, File);
+	}
+}
+
+//
+// Answers for a derived file. When the snapshot is stale, or there is none
+// yet, it is rebuilt first where that is allowed. Failing that the stale
+// snapshot, or the unpatched template, is handed out.
+//
+static NTSTATUS ReadVirtualFileSnapshot(WDFDEVICE device, PVIRTUAL_FILE File, PWCHAR RequestPath, PVOID Data, DWORD DataSize, DWORD* FileSize)
+{
+	UNREFERENCED_PARAMETER(RequestPath);
+
+	*FileSize = File->DataSize;
+
+	if (DataSize < File->DataSize)
+	{
+		return STATUS_BUFFER_TOO_SMALL;
+	}
+
+	if (!CopyVirtualFileSnapshot(device, File, Data, NULL) &&
+		KeGetCurrentIrql() == PASSIVE_LEVEL &&
+		NT_SUCCESS(BuildVirtualFileSnapshot(device, File)))
+	{
+		CopyVirtualFileSnapshot(device, File, Data, NULL);
+	}
+
+	return STATUS_SUCCESS;
+}
+
+// Fill in the real BT MAC
+static NTSTATUS PatchBTProvision(WDFDEVICE device, PUCHAR Data)
+{
+	BYTE BT_NV[9] = { 0 };
+
+	NTSTATUS status = GetSFPDItem(device, BT_NV_FILE_PATH, BT_NV, sizeof(BT_NV));
+	if (NT_SUCCESS(status))
+	{
+		Data[2] = BT_NV[8];
+		Data[3] = BT_NV[7];
+		Data[4] = BT_NV[6];
+		Data[5] = BT_NV[5];
+		Data[6] = BT_NV[4];
+		Data[7] = BT_NV[3];
+	}
+
+	return status;
+}
+
+// Fill in the real WLAN MAC
+static NTSTATUS PatchWLANProvision(WDFDEVICE device, PUCHAR Data)
+{
+	BYTE WLAN_MAC[33] = { 0 };
+
+	NTSTATUS status = GetSFPDItem(device, WLAN_MAC_FILE_PATH, WLAN_MAC, sizeof(WLAN_MAC));
+	if (!NT_SUCCESS(status))
+	{
+		return status;
+	}
+
+	BYTE MAC_ADDRESS[6] = { 0 };
+
+	for (DWORD i = 0; i < sizeof(MAC_ADDRESS); i++)
+	{
+		DWORD HighIndex = 16 + i * 2;
+		DWORD LowIndex = 16 + (i * 2) + 1;
+
+		DWORD ByteHigh = WLAN_MAC[HighIndex];
+		DWORD ByteLow = WLAN_MAC[LowIndex];
+
+		if (0x30 <= ByteHigh && ByteHigh <= 0x39)
+		{
+			MAC_ADDRESS[i] |= ((ByteHigh - 0x30) << 4) & 0xF0;
+		}
+		else if (0x41 <= ByteHigh && ByteHigh <= 0x46)
+		{
+			MAC_ADDRESS[i] |= ((ByteHigh - 0x37) << 4) & 0xF0;
+		}
+		else
+		{
+			return STATUS_INVALID_PARAMETER;
+		}
+
+		if (0x30 <= ByteLow && ByteLow <= 0x39)
+		{
+			MAC_ADDRESS[i] |= (ByteLow - 0x30) & 0x0F;
+		}
+		else if (0x41 <= ByteLow && ByteLow <= 0x46)
+		{
+			MAC_ADDRESS[i] |= (ByteLow - 0x37) & 0x0F;
+		}
+		else
+		{
+			return STATUS_INVALID_PARAMETER;
+		}
+	}
+
+	Data[3] = MAC_ADDRESS[0];
+	Data[4] = MAC_ADDRESS[1];
+	Data[5] = MAC_ADDRESS[2];
+	Data[6] = MAC_ADDRESS[3];
+	Data[7] = MAC_ADDRESS[4];
+	Data[8] = MAC_ADDRESS[5];
+
+	return STATUS_SUCCESS;
+}
+
+// JSON\foo.json maps to \sensors\foo.json
+#define SENSOR_FILE_PATH_LENGTH (VIRTUAL_FILE_MAX_PATH + (sizeof(SENSOR_DATA_DIRECTORY) - sizeof(WCHAR)) / sizeof(WCHAR))
+
+static VOID BuildSensorFilePath(PWCHAR RequestPath, WCHAR SensorFilePath[SENSOR_FILE_PATH_LENGTH])
+{
+	RtlZeroMemory(SensorFilePath, SENSOR_FILE_PATH_LENGTH * sizeof(WCHAR));
+	RtlCopyMemory(SensorFilePath, SENSOR_DATA_DIRECTORY, sizeof(SENSOR_DATA_DIRECTORY) - sizeof(WCHAR));
+	RtlCopyMemory(SensorFilePath + (sizeof(SENSOR_DATA_DIRECTORY) - sizeof(WCHAR)) / sizeof(WCHAR), RequestPath + 4, (VIRTUAL_FILE_MAX_PATH - 4) * sizeof(WCHAR));
+}
+
+static NTSTATUS GetSensorFileSize(WDFDEVICE device, PVIRTUAL_FILE File, PWCHAR RequestPath, DWORD* FileSize)
+{
+	UNREFERENCED_PARAMETER(File);
+
+	WCHAR SensorFilePath[SENSOR_FILE_PATH_LENGTH];
+	BuildSensorFilePath(RequestPath, SensorFilePath);
+
+	return GetSFPDItemSize(device, SensorFilePath, FileSize);
+}
+
+static NTSTATUS ReadSensorFile(WDFDEVICE device, PVIRTUAL_FILE File, PWCHAR RequestPath, PVOID Data, DWORD DataSize, DWORD* FileSize)
+{
+	UNREFERENCED_PARAMETER(File);
+
+	WCHAR SensorFilePath[SENSOR_FILE_PATH_LENGTH];
+	BuildSensorFilePath(RequestPath, SensorFilePath);
+
+	return GetSFPDItemWithSize(device, SensorFilePath, Data, DataSize, FileSize);
+}
@@ -0,0 +1,198 @@
+/*++
+
+Copyright (c) 2021-2024 DuoWoA authors. All Rights Reserved.
+
+Module Name:
+
+	blobcheck.c
+
+Abstract:
+
+	User-mode check and benchmark of the packed blobs. Every blob in
+	include\packedblobs.h is expanded by UnpackBlob, the decoder the driver
+	uses, and compared byte for byte against its array in
+	src\packedblobs.in. A stale header fails the comparison too. Then the
+	decode throughput is measured against a plain copy of the unpacked
+	array, which is what replies cost before.
+
+	Build and run from the repository root with any C11 compiler:
+
+		cc -O2 -o blobcheck tools/blobcheck.c && ./blobcheck
+		cl /std:c11 /O2 tools\blobcheck.c && blobcheck.exe
+
+	A blob added to src\packedblobs.in needs a line below as well.
+
+Environment:
+
+	User mode, no WDK needed
+
+--*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef void VOID, * PVOID;
+typedef uint8_t UCHAR, * PUCHAR, BYTE;
+typedef uint32_t ULONG, DWORD;
+typedef int32_t NTSTATUS;
+
+#define FORCEINLINE static inline
+#define UNALIGNED
+#define RtlCopyMemory memcpy
+#define RtlZeroMemory(Destination, Length) memset((Destination), 0, (Length))
+
+#define STATUS_SUCCESS ((NTSTATUS)0x00000000L)
+#define STATUS_BUFFER_TOO_SMALL ((NTSTATUS)0xC0000023L)
+#define STATUS_DATA_ERROR ((NTSTATUS)0xC000003EL)
+
+// The unpacked arrays, the file is C already
+#include "../src/packedblobs.in"
+
+#include "../include/blobunpack.h"
+#include "../include/packedblobs.h"
+
+#define BLOB(Name) { #Name, Name, sizeof(Name), Name##_PACKED, sizeof(Name##_PACKED) }
+
+static const struct
+{
+	const char* Name;
+	const BYTE* Data;
+	DWORD DataSize;
+	const BYTE* Packed;
+	DWORD PackedSize;
+} Blobs[] =
+{
+	BLOB(WLAN_CLPC_PROVISION),
+};
+
+// Written past the unpacked size to catch the decoder touching the rest of a reply
+#define SLACK 64
+#define FILL 0xCC
+
+#define ITERATIONS 20000
+
+static double Seconds(void)
+{
+	struct timespec Now;
+
+	timespec_get(&Now, TIME_UTC);
+
+	return (double)Now.tv_sec + (double)Now.tv_nsec / 1e9;
+}
+
+static int CheckBlob(ULONG i, PUCHAR Buffer)
+{
+	DWORD FileSize = 0;
+	NTSTATUS status;
+
+	memset(Buffer, FILL, Blobs[i].DataSize + SLACK);
+
+	status = UnpackBlob(Blobs[i].Packed, Blobs[i].PackedSize, Buffer, Blobs[i].DataSize + SLACK, &FileSize);
+
+	if (status != STATUS_SUCCESS || FileSize != Blobs[i].DataSize)
+	{
+		printf("blobcheck: %s: 0x%08lX, %lu bytes instead of %lu\n", Blobs[i].Name, (unsigned long)status, (unsigned long)FileSize, (unsigned long)Blobs[i].DataSize);
+		return 1;
+	}
+
+	for (DWORD Offset = 0; Offset < Blobs[i].DataSize; Offset++)
+	{
+		if (Buffer[Offset] != Blobs[i].Data[Offset])
+		{
+			printf("blobcheck: %s: differs at offset %lu, is packedblobs.h stale?\n", Blobs[i].Name, (unsigned long)Offset);
+			return 1;
+		}
+	}
+
+	for (DWORD Offset = Blobs[i].DataSize; Offset < Blobs[i].DataSize + SLACK; Offset++)
+	{
+		if (Buffer[Offset] != FILL)
+		{
+			printf("blobcheck: %s: writes past its end at offset %lu\n", Blobs[i].Name, (unsigned long)Offset);
+			return 1;
+		}
+	}
+
+	if (Blobs[i].DataSize != 0)
+	{
+		status = UnpackBlob(Blobs[i].Packed, Blobs[i].PackedSize, Buffer, Blobs[i].DataSize - 1, &FileSize);
+
+		if (status != STATUS_BUFFER_TOO_SMALL || FileSize != Blobs[i].DataSize)
+		{
+			printf("blobcheck: %s: a reply one byte short is not turned away\n", Blobs[i].Name);
+			return 1;
+		}
+	}
+
+	// A truncated stream must be caught, never expanded past what it says
+	if (Blobs[i].PackedSize > sizeof(DWORD))
+	{
+		status = UnpackBlob(Blobs[i].Packed, Blobs[i].PackedSize - 1, Buffer, Blobs[i].DataSize + SLACK, &FileSize);
+
+		if (status != STATUS_DATA_ERROR)
+		{
+			printf("blobcheck: %s: a truncated stream is not caught\n", Blobs[i].Name);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static void TimeBlob(ULONG i, PUCHAR Buffer)
+{
+	volatile BYTE Sink = 0;
+	DWORD FileSize = 0;
+	double Start = Seconds();
+
+	for (ULONG Iteration = 0; Iteration < ITERATIONS; Iteration++)
+	{
+		UnpackBlob(Blobs[i].Packed, Blobs[i].PackedSize, Buffer, Blobs[i].DataSize, &FileSize);
+		Sink += Buffer[Iteration % Blobs[i].DataSize];
+	}
+
+	double Unpack = Seconds() - Start;
+
+	Start = Seconds();
+
+	for (ULONG Iteration = 0; Iteration < ITERATIONS; Iteration++)
+	{
+		memcpy(Buffer, Blobs[i].Data, Blobs[i].DataSize);
+		Sink += Buffer[Iteration % Blobs[i].DataSize];
+	}
+
+	double Copy = Seconds() - Start;
+	double Megabytes = (double)Blobs[i].DataSize * ITERATIONS / 1e6;
+
+	printf("blobcheck: %s, %lu bytes packed into %lu, byte exact\n", Blobs[i].Name, (unsigned long)Blobs[i].DataSize, (unsigned long)Blobs[i].PackedSize);
+	printf("  UnpackBlob  %8.0f MB/s\n", Megabytes / Unpack);
+	printf("  plain copy  %8.0f MB/s\n", Megabytes / Copy);
+}
+
+int main(void)
+{
+	for (ULONG i = 0; i < sizeof(Blobs) / sizeof(Blobs[0]); i++)
+	{
+		PUCHAR Buffer = (PUCHAR)malloc(Blobs[i].DataSize + SLACK);
+
+		if (Buffer == NULL)
+		{
+			printf("blobcheck: out of memory\n");
+			return 1;
+		}
+
+		if (CheckBlob(i, Buffer) != 0)
+		{
+			free(Buffer);
+			return 1;
+		}
+
+		TimeBlob(i, Buffer);
+		free(Buffer);
+	}
+
+	return 0;
+}
@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2021-2024 DuoWoA authors. All Rights Reserved.
+#
+# Generates include/packedblobs.h from src/packedblobs.in.
+#
+# Every array is packed into a stream of runs, which UnpackBlob in
+# include/blobunpack.h expands straight into the reply:
+#
+#   4 bytes       Unpacked size, little endian
+#   0x00 - 0x7F   Literal run, the control byte + 1 bytes that follow
+#   0x80 - 0xFF   Zero run of ((control & 0x7F) << 8 | next byte) + 1 bytes
+#
+# Runs on any Python 3 without extra modules:
+#
+#   python tools/blobpack.py src/packedblobs.in include/packedblobs.h
+#
+
+import re
+import sys
+
+# Must match UnpackBlob in blobunpack.h
+MAX_LITERAL_RUN = 0x80
+MAX_ZERO_RUN = 0x8000
+
+# Zero runs shorter than this cost more as their own run than inside a literal one
+MIN_ZERO_RUN = 3
+
+ARRAY = re.compile(r"const\s+BYTE\s+(\w+)\s*\[\s*(\d+)\s*\]\s*=\s*\{([^}]*)\}\s*;")
+COMMENT = re.compile(r"//[^\n]*|/\*.*?\*/", re.S)
+
+
+def fail(message):
+    sys.stderr.write("blobpack: error: %s\n" % message)
+    sys.exit(1)
+
+
+def parse_blobs(path):
+    with open(path, "r") as source:
+        text = COMMENT.sub("", source.read())
+
+    blobs = []
+
+    for match in ARRAY.finditer(text):
+        name, size, body = match.group(1), int(match.group(2)), match.group(3)
+        data = bytes(int(value, 0) for value in body.replace(",", " ").split())
+
+        if len(data) != size:
+            fail("%s: %s is declared %d bytes but has %d" % (path, name, size, len(data)))
+
+        if any(existing[0] == name for existing in blobs):
+            fail("%s: %s is defined twice" % (path, name))
+
+        blobs.append((name, data))
+
+    if not blobs:
+        fail("%s: no blobs" % path)
+
+    return blobs
+
+
+def zero_run_length(data, start):
+    end = start
+
+    while end < len(data) and data[end] == 0 and end - start < MAX_ZERO_RUN:
+        end += 1
+
+    return end - start
+
+
+def pack(data):
+    packed = bytearray(len(data).to_bytes(4, "little"))
+    literal = bytearray()
+
+    def flush_literal():
+        for start in range(0, len(literal), MAX_LITERAL_RUN):
+            run = literal[start:start + MAX_LITERAL_RUN]
+            packed.append(len(run) - 1)
+            packed.extend(run)
+
+        del literal[:]
+
+    position = 0
+
+    while position < len(data):
+        zeros = zero_run_length(data, position)
+
+        if zeros >= MIN_ZERO_RUN:
+            flush_literal()
+            packed.append(0x80 | ((zeros - 1) >> 8))
+            packed.append((zeros - 1) & 0xFF)
+            position += zeros
+        else:
+            literal.append(data[position])
+            position += 1
+
+    flush_literal()
+
+    return bytes(packed)
+
+
+def unpack(packed):
+    size = int.from_bytes(packed[:4], "little")
+    data = bytearray()
+    position = 4
+
+    while position < len(packed):
+        control = packed[position]
+
+        if control < 0x80:
+            data.extend(packed[position + 1:position + 2 + control])
+            position += 2 + control
+        else:
+            data.extend(bytes((((control & 0x7F) << 8) | packed[position + 1]) + 1))
+            position += 2
+
+    if len(data) != size:
+        fail("unpacked %d bytes instead of %d" % (len(data), size))
+
+    return bytes(data)
+
+
+def generate(blobs):
+    lines = []
+    lines.append("/*++")
+    lines.append("")
+    lines.append("Copyright (c) 2021-2024 DuoWoA authors. All Rights Reserved.")
+    lines.append("")
+    lines.append("Module Name:")
+    lines.append("")
+    lines.append("\tpackedblobs.h")
+    lines.append("")
+    lines.append("Abstract:")
+    lines.append("")
+    lines.append("\tThis file contains the provisioning blobs kept packed in the driver image.")
+    lines.append("")
+    lines.append("\tGenerated by tools\\blobpack.py from src\\packedblobs.in, edit that file")
+    lines.append("\tinstead. vfile.c includes it ahead of the virtual file table, and")
+    lines.append("\ttools\\blobcheck.c to check it against the source arrays.")
+    lines.append("")
+    lines.append("Environment:")
+    lines.append("")
+    lines.append("\tKernel-mode Driver Framework")
+    lines.append("")
+    lines.append("--*/")
+    lines.append("")
+    lines.append("#pragma once")
+
+    for name, data in blobs:
+        packed = pack(data)
+
+        # The driver has no other copy to fall back on, make sure it comes back whole
+        if unpack(packed) != data:
+            fail("%s does not survive packing" % name)
+
+        lines.append("")
+        lines.append("// %s, %d bytes unpacked" % (name, len(data)))
+        lines.append("static const BYTE %s_PACKED[%d] =" % (name, len(packed)))
+        lines.append("{")
+
+        for start in range(0, len(packed), 8):
+            lines.append("    %s," % ", ".join("0x%02X" % value for value in packed[start:start + 8]))
+
+        lines[-1] = lines[-1].rstrip(",")
+        lines.append("};")
+
+    lines.append("")
+
+    return "\n".join(lines)
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.stderr.write("usage: blobpack.py <blobs> <output header>\n")
+        return 1
+
+    blobs_path, output_path = sys.argv[1], sys.argv[2]
+    header = generate(parse_blobs(blobs_path))
+
+    # Leave the header alone when nothing changed so vfile.c isn't rebuilt
+    try:
+        with open(output_path, "r", newline="") as existing:
+            if existing.read() == header:
+                return 0
+    except OSError:
+        pass
+
+    with open(output_path, "w", newline="\n") as output:
+        output.write(header)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
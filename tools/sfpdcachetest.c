@@ -0,0 +1,816 @@
+/*++
+
+Copyright (c) 2021-2024 DuoWoA authors. All Rights Reserved.
+
+Module Name:
+
+	sfpdcachetest.c
+
+Abstract:
+
+	User-mode tests and benchmark of the SFPD content cache core in
+	include\sfpdlru.h, the code the driver runs under ContentCacheLock.
+
+	The unit tests cover eviction order, replacing an item, items that can
+	never fit and the cost of huge items. Then a synthetic access trace,
+	sensor stack restarts re-reading every sensor JSON mixed with skewed
+	reads of calibration files, is replayed against the cache and against
+	a plain array model of the same LRU policy. Every access must hit or
+	miss in both alike, and the counters and the final order must match.
+	Hits, misses, evictions and the time per access are reported for a few
+	budgets.
+
+	Build and run from the repository root with any C11 compiler, WCHAR
+	literals must be 16 bit:
+
+		cc -O2 -fshort-wchar -o sfpdcachetest tools/sfpdcachetest.c && ./sfpdcachetest
+
+Environment:
+
+	User mode, no WDK needed
+
+--*/
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+#include <time.h>
+
+typedef void VOID, * PVOID;
+typedef uint8_t UCHAR, * PUCHAR, BOOLEAN;
+typedef uint32_t ULONG, DWORD;
+typedef int32_t LONG;
+typedef size_t SIZE_T;
+typedef wchar_t WCHAR;
+
+#define FORCEINLINE static inline
+#define TRUE 1
+#define FALSE 0
+#define MAX_PATH 260
+#define MAXULONG 0xFFFFFFFFUL
+#define UNICODE_NULL ((WCHAR)0)
+#define FIELD_OFFSET(Type, Field) ((ULONG)offsetof(Type, Field))
+#define CONTAINING_RECORD(Address, Type, Field) ((Type*)((PUCHAR)(Address) - offsetof(Type, Field)))
+#define RtlCopyMemory memcpy
+
+_Static_assert(sizeof(WCHAR) == 2, "WCHAR literals must be 16 bit, build with -fshort-wchar");
+
+typedef struct _LIST_ENTRY
+{
+	struct _LIST_ENTRY* Flink;
+	struct _LIST_ENTRY* Blink;
+} LIST_ENTRY, * PLIST_ENTRY;
+
+// As in wdm.h, without the corruption checks
+static void InitializeListHead(PLIST_ENTRY ListHead)
+{
+	ListHead->Flink = ListHead->Blink = ListHead;
+}
+
+static BOOLEAN IsListEmpty(const LIST_ENTRY* ListHead)
+{
+	return ListHead->Flink == ListHead;
+}
+
+static BOOLEAN RemoveEntryList(PLIST_ENTRY Entry)
+{
+	PLIST_ENTRY Flink = Entry->Flink;
+	PLIST_ENTRY Blink = Entry->Blink;
+
+	Blink->Flink = Flink;
+	Flink->Blink = Blink;
+
+	return Flink == Blink;
+}
+
+static void InsertHeadList(PLIST_ENTRY ListHead, PLIST_ENTRY Entry)
+{
+	PLIST_ENTRY Flink = ListHead->Flink;
+
+	Entry->Flink = Flink;
+	Entry->Blink = ListHead;
+	Flink->Blink = Entry;
+	ListHead->Flink = Entry;
+}
+
+#include "../include/sfpdlru.h"
+
+// Counts what is out, the cache must hand every block back
+static _Atomic LONG BlocksOut;
+
+static PVOID AllocateBlock(SIZE_T Size)
+{
+	PVOID Block = malloc(Size);
+
+	if (Block != NULL)
+	{
+		BlocksOut++;
+	}
+
+	return Block;
+}
+
+static VOID FreeBlock(PVOID Block)
+{
+	BlocksOut--;
+	free(Block);
+}
+
+static _Atomic int Failures;
+
+#define CHECK(Condition) \
+	do \
+	{ \
+		if (!(Condition)) \
+		{ \
+			printf("sfpdcachetest: line %d: %s\n", __LINE__, #Condition); \
+			Failures++; \
+		} \
+	} while (0)
+
+// Not wcscpy, the C library's wchar_t may be wider than these literals
+static void WidenPath(WCHAR Path[MAX_PATH], const char* Narrow)
+{
+	ULONG i = 0;
+
+	for (; Narrow[i] != '\0' && i < MAX_PATH - 1; i++)
+	{
+		Path[i] = (WCHAR)Narrow[i];
+	}
+
+	Path[i] = UNICODE_NULL;
+}
+
+static double Seconds(void)
+{
+	struct timespec Now;
+
+	timespec_get(&Now, TIME_UTC);
+
+	return (double)Now.tv_sec + (double)Now.tv_nsec / 1e9;
+}
+
+static UCHAR Scratch[0x10000];
+
+// Reads through the cache the way GetSFPDItem does, filling on a miss
+static BOOLEAN Access(PSFPD_CONTENT_CACHE ContentCache, const WCHAR* Path, DWORD Size)
+{
+	if (LookupSFPDContentCacheEntry(ContentCache, Path) != NULL)
+	{
+		return TRUE;
+	}
+
+	PSFPD_CONTENT_CACHE_ENTRY Entry = CreateSFPDContentCacheEntry(ContentCache, Path, Scratch, Size);
+
+	if (Entry != NULL && !InsertSFPDContentCacheEntry(ContentCache, Entry, 0, 0))
+	{
+		FreeBlock(Entry);
+	}
+
+	return FALSE;
+}
+
+static ULONG CountEntries(PSFPD_CONTENT_CACHE ContentCache)
+{
+	ULONG Count = 0;
+
+	for (PLIST_ENTRY Link = ContentCache->LruList.Flink; Link != &ContentCache->LruList; Link = Link->Flink)
+	{
+		Count++;
+	}
+
+	return Count;
+}
+
+static void TestLru(void)
+{
+	SFPD_CONTENT_CACHE ContentCache;
+	WCHAR A[MAX_PATH], B[MAX_PATH], C[MAX_PATH], D[MAX_PATH], Upper[MAX_PATH], Long[MAX_PATH];
+	ULONG Item = 1000;
+	ULONG Cost = GetSFPDContentCacheCost(Item);
+
+	WidenPath(A, "\\sensors\\a.json");
+	WidenPath(B, "\\sensors\\b.json");
+	WidenPath(C, "\\sensors\\c.json");
+	WidenPath(D, "\\sensors\\d.json");
+	WidenPath(Upper, "\\SENSORS\\A.JSON");
+
+	// Room for two items and a bit
+	InitializeSFPDContentCacheList(&ContentCache, Cost * 2 + Cost / 2, AllocateBlock, FreeBlock);
+
+	CHECK(!Access(&ContentCache, A, Item));
+	CHECK(!Access(&ContentCache, B, Item));
+	CHECK(ContentCache.BytesUsed == Cost * 2 && ContentCache.Evictions == 0);
+
+	// A becomes the most recently used, so C evicts B
+	CHECK(Access(&ContentCache, Upper, Item));
+	CHECK(!Access(&ContentCache, C, Item));
+	CHECK(ContentCache.Evictions == 1);
+	CHECK(FindSFPDContentCacheEntry(&ContentCache, B) == NULL);
+	CHECK(FindSFPDContentCacheEntry(&ContentCache, A) != NULL);
+
+	// A new copy of an item replaces the old one instead of evicting another
+	PSFPD_CONTENT_CACHE_ENTRY Entry = CreateSFPDContentCacheEntry(&ContentCache, Upper, Scratch, Item / 2);
+	CHECK(Entry != NULL && InsertSFPDContentCacheEntry(&ContentCache, Entry, 0, 0));
+	CHECK(CountEntries(&ContentCache) == 2 && ContentCache.Evictions == 1);
+	CHECK(ContentCache.BytesUsed == Cost + GetSFPDContentCacheCost(Item / 2));
+	CHECK(ContentCache.LruList.Flink == &Entry->Link);
+
+	// C is now the least recently used
+	CHECK(!Access(&ContentCache, D, Item));
+	CHECK(FindSFPDContentCacheEntry(&ContentCache, C) == NULL);
+	CHECK(ContentCache.BytesUsed <= ContentCache.Budget);
+
+	// Never cached: larger than the whole budget, an unterminated path, a size near 4 GiB
+	CHECK(CreateSFPDContentCacheEntry(&ContentCache, A, Scratch, ContentCache.Budget) == NULL);
+
+	for (ULONG i = 0; i < MAX_PATH; i++)
+	{
+		Long[i] = L'x';
+	}
+
+	CHECK(CreateSFPDContentCacheEntry(&ContentCache, Long, Scratch, 1) == NULL);
+	CHECK(GetSFPDContentCacheCost(0xFFFFFFFF) == MAXULONG);
+	CHECK(GetSFPDContentCacheCost(MAXULONG - FIELD_OFFSET(SFPD_CONTENT_CACHE_ENTRY, Data)) == MAXULONG);
+
+	ClearSFPDContentCache(&ContentCache);
+	CHECK(IsListEmpty(&ContentCache.LruList) && ContentCache.BytesUsed == 0);
+	CHECK(BlocksOut == 0);
+}
+
+//
+// Coherence with the change watcher
+//
+
+static const struct
+{
+	const char* Path1;
+	const char* Path2;
+	BOOLEAN Related;
+} PathRelations[] =
+{
+	{ "\\sensors\\a.json", "\\sensors\\a.json", TRUE },
+	{ "\\sensors\\a.json", "\\SENSORS\\A.JSON", TRUE },
+	{ "\\sensors", "\\sensors\\a.json", TRUE },
+	{ "\\sensors", "\\sensors\\calib\\x.bin", TRUE },
+	{ "\\sensors\\a.json", "\\sensors\\b.json", FALSE },
+	{ "\\sensors\\a.json", "\\sensors\\a.json.tmp", FALSE },
+	{ "\\sensors", "\\sensors2", FALSE },
+	{ "\\sensors", "\\sensors2\\a.json", FALSE },
+	{ "\\sensors\\x.bin", "\\calibration\\x.bin", FALSE },
+};
+
+static void TestPathRelation(void)
+{
+	WCHAR Path1[MAX_PATH], Path2[MAX_PATH];
+
+	for (ULONG i = 0; i < sizeof(PathRelations) / sizeof(PathRelations[0]); i++)
+	{
+		WidenPath(Path1, PathRelations[i].Path1);
+		WidenPath(Path2, PathRelations[i].Path2);
+
+		// Either can be the notification, the other the cached item
+		if (IsSFPDPathRelated(Path1, Path2) != PathRelations[i].Related ||
+			IsSFPDPathRelated(Path2, Path1) != PathRelations[i].Related)
+		{
+			printf("sfpdcachetest: %s and %s should%s be related\n", PathRelations[i].Path1, PathRelations[i].Path2, PathRelations[i].Related ? "" : " not");
+			Failures++;
+		}
+	}
+}
+
+//
+// The content cache as the device context holds it, a mutex standing in for
+// ContentCacheLock, and what sfpdcache.c does around the core for a read, a
+// fill and a change notification.
+//
+typedef struct _WATCHED_CACHE
+{
+	SFPD_CONTENT_CACHE ContentCache;
+	mtx_t ContentCacheLock;
+	_Atomic LONG CacheGeneration;
+} WATCHED_CACHE, * PWATCHED_CACHE;
+
+static void InitializeWatchedCache(PWATCHED_CACHE Cache, ULONG Budget)
+{
+	InitializeSFPDContentCacheList(&Cache->ContentCache, Budget, AllocateBlock, FreeBlock);
+	mtx_init(&Cache->ContentCacheLock, mtx_plain);
+	atomic_init(&Cache->CacheGeneration, 0);
+}
+
+static void FreeWatchedCache(PWATCHED_CACHE Cache)
+{
+	ClearSFPDContentCache(&Cache->ContentCache);
+	mtx_destroy(&Cache->ContentCacheLock);
+}
+
+// GetSFPDCacheGeneration
+static LONG GetGeneration(PWATCHED_CACHE Cache)
+{
+	return atomic_load(&Cache->CacheGeneration);
+}
+
+// ReadSFPDCache past the warm cache
+static BOOLEAN ReadCache(PWATCHED_CACHE Cache, const WCHAR* Path, PVOID Data, DWORD DataSize)
+{
+	BOOLEAN CacheHit = FALSE;
+
+	mtx_lock(&Cache->ContentCacheLock);
+
+	PSFPD_CONTENT_CACHE_ENTRY Entry = LookupSFPDContentCacheEntry(&Cache->ContentCache, Path);
+
+	if (Entry != NULL && Entry->DataSize == DataSize)
+	{
+		RtlCopyMemory(Data, Entry->Data, DataSize);
+		CacheHit = TRUE;
+	}
+
+	mtx_unlock(&Cache->ContentCacheLock);
+
+	return CacheHit;
+}
+
+// InsertSFPDContentCache, TRUE if the item made it in
+static BOOLEAN FillCache(PWATCHED_CACHE Cache, const WCHAR* Path, const VOID* Data, DWORD DataSize, LONG Generation)
+{
+	PSFPD_CONTENT_CACHE_ENTRY Entry = CreateSFPDContentCacheEntry(&Cache->ContentCache, Path, Data, DataSize);
+	BOOLEAN Inserted = FALSE;
+
+	if (Entry == NULL)
+	{
+		return FALSE;
+	}
+
+	mtx_lock(&Cache->ContentCacheLock);
+
+	Inserted = InsertSFPDContentCacheEntry(&Cache->ContentCache, Entry, Generation, atomic_load(&Cache->CacheGeneration));
+
+	mtx_unlock(&Cache->ContentCacheLock);
+
+	if (!Inserted)
+	{
+		FreeBlock(Entry);
+	}
+
+	return Inserted;
+}
+
+// InvalidateSFPDCachePath, the generation goes first
+static ULONG NotifyChange(PWATCHED_CACHE Cache, const WCHAR* Path)
+{
+	ULONG Dropped = 0;
+
+	atomic_fetch_add(&Cache->CacheGeneration, 1);
+
+	mtx_lock(&Cache->ContentCacheLock);
+
+	Dropped = InvalidateSFPDContentCache(&Cache->ContentCache, Path);
+
+	mtx_unlock(&Cache->ContentCacheLock);
+
+	return Dropped;
+}
+
+static void TestNotificationSequence(void)
+{
+	WATCHED_CACHE Cache;
+	WCHAR Directory[MAX_PATH], A[MAX_PATH], B[MAX_PATH], C[MAX_PATH], UpperA[MAX_PATH], Calibration[MAX_PATH];
+	UCHAR Old[16], New[16], Buffer[16];
+	LONG Generation = 0;
+
+	WidenPath(Directory, "\\sensors");
+	WidenPath(A, "\\sensors\\a.json");
+	WidenPath(B, "\\sensors\\b.json");
+	WidenPath(C, "\\sensors\\c.json");
+	WidenPath(UpperA, "\\SENSORS\\A.JSON");
+	WidenPath(Calibration, "\\calibration\\x.bin");
+
+	memset(Old, 'o', sizeof(Old));
+	memset(New, 'n', sizeof(New));
+
+	InitializeWatchedCache(&Cache, 0x10000);
+
+	// The listing of \sensors, two of its items and one elsewhere
+	Generation = GetGeneration(&Cache);
+	CHECK(FillCache(&Cache, Directory, Old, sizeof(Old), Generation));
+	CHECK(FillCache(&Cache, A, Old, sizeof(Old), Generation));
+	CHECK(FillCache(&Cache, B, Old, sizeof(Old), Generation));
+	CHECK(FillCache(&Cache, Calibration, Old, sizeof(Old), Generation));
+
+	// A read of c.json misses and goes to disk, taking the generation first
+	CHECK(!ReadCache(&Cache, C, Buffer, sizeof(Buffer)));
+	Generation = GetGeneration(&Cache);
+
+	// c.json is rewritten before that read completes. Only the listing of \sensors was cached for it.
+	CHECK(NotifyChange(&Cache, C) == 1);
+	CHECK(!ReadCache(&Cache, Directory, Buffer, sizeof(Buffer)));
+	CHECK(ReadCache(&Cache, A, Buffer, sizeof(Buffer)));
+	CHECK(ReadCache(&Cache, Calibration, Buffer, sizeof(Buffer)));
+
+	// The read completes with what it saw before the change, which must not be cached
+	CHECK(!FillCache(&Cache, C, Old, sizeof(Old), Generation));
+	CHECK(!ReadCache(&Cache, C, Buffer, sizeof(Buffer)));
+
+	// The next read started after the notification, so it may fill
+	Generation = GetGeneration(&Cache);
+	CHECK(FillCache(&Cache, C, New, sizeof(New), Generation));
+	CHECK(ReadCache(&Cache, C, Buffer, sizeof(Buffer)) && memcmp(Buffer, New, sizeof(New)) == 0);
+
+	// Notifications may spell a name differently than the reads did
+	CHECK(NotifyChange(&Cache, UpperA) == 1);
+	CHECK(!ReadCache(&Cache, A, Buffer, sizeof(Buffer)));
+
+	// A renamed directory takes everything below it, not its neighbours
+	CHECK(NotifyChange(&Cache, Directory) == 2);
+	CHECK(!ReadCache(&Cache, B, Buffer, sizeof(Buffer)));
+	CHECK(!ReadCache(&Cache, C, Buffer, sizeof(Buffer)));
+	CHECK(ReadCache(&Cache, Calibration, Buffer, sizeof(Buffer)));
+
+	// An overflowed notification buffer takes everything, fills in flight included
+	Generation = GetGeneration(&Cache);
+	CHECK(NotifyChange(&Cache, NULL) == 1);
+	CHECK(IsListEmpty(&Cache.ContentCache.LruList) && Cache.ContentCache.BytesUsed == 0);
+	CHECK(!FillCache(&Cache, B, Old, sizeof(Old), Generation));
+
+	FreeWatchedCache(&Cache);
+	CHECK(BlocksOut == 0);
+}
+
+//
+// Readers going through the cache while a notifier keeps rewriting the files
+// on "disk". Every rewrite bumps the file's version, then the notification
+// runs, then the version counts as settled. A reader must never be served a
+// version older than the one settled when its read started, however the
+// fills in flight interleave with the notifications.
+//
+
+#define COHERENCE_FILES 8
+#define COHERENCE_READERS 4
+#define COHERENCE_READS 100000
+#define COHERENCE_CHANGES 20000
+
+static WATCHED_CACHE CoherenceCache;
+static WCHAR CoherencePaths[COHERENCE_FILES][MAX_PATH];
+static _Atomic DWORD DiskVersions[COHERENCE_FILES];
+static _Atomic DWORD SettledVersions[COHERENCE_FILES];
+static _Atomic LONG StaleReads;
+static _Atomic LONG TornReads;
+static _Atomic LONG RefusedFills;
+static _Atomic BOOLEAN NotifierDone;
+
+typedef struct _COHERENCE_ITEM
+{
+	DWORD Words[16];
+} COHERENCE_ITEM;
+
+static int CoherenceReader(void* Context)
+{
+	ULONG State = (ULONG)(uintptr_t)Context;
+
+	for (ULONG Read = 0; Read < COHERENCE_READS; Read++)
+	{
+		COHERENCE_ITEM Item;
+
+		State ^= State << 13;
+		State ^= State >> 17;
+		State ^= State << 5;
+
+		ULONG File = State % COHERENCE_FILES;
+		DWORD Floor = atomic_load(&SettledVersions[File]);
+
+		if (ReadCache(&CoherenceCache, CoherencePaths[File], &Item, sizeof(Item)))
+		{
+			for (ULONG i = 1; i < 16; i++)
+			{
+				if (Item.Words[i] != Item.Words[0])
+				{
+					TornReads++;
+					break;
+				}
+			}
+
+			if (Item.Words[0] < Floor)
+			{
+				StaleReads++;
+			}
+
+			continue;
+		}
+
+		// The disk read, with room for a notification to slip in
+		LONG Generation = GetGeneration(&CoherenceCache);
+
+		thrd_yield();
+
+		DWORD Version = atomic_load(&DiskVersions[File]);
+
+		for (ULONG i = 0; i < 16; i++)
+		{
+			Item.Words[i] = Version;
+		}
+
+		thrd_yield();
+
+		if (!FillCache(&CoherenceCache, CoherencePaths[File], &Item, sizeof(Item), Generation))
+		{
+			RefusedFills++;
+		}
+	}
+
+	return 0;
+}
+
+static double InvalidationSeconds;
+static double SlowestInvalidation;
+
+static int CoherenceNotifier(void* Context)
+{
+	ULONG State = (ULONG)(uintptr_t)Context;
+
+	for (ULONG Change = 0; Change < COHERENCE_CHANGES; Change++)
+	{
+		State ^= State << 13;
+		State ^= State >> 17;
+		State ^= State << 5;
+
+		ULONG File = State % COHERENCE_FILES;
+		DWORD Version = atomic_fetch_add(&DiskVersions[File], 1) + 1;
+
+		double Start = Seconds();
+
+		NotifyChange(&CoherenceCache, CoherencePaths[File]);
+
+		double Elapsed = Seconds() - Start;
+
+		InvalidationSeconds += Elapsed;
+
+		if (Elapsed > SlowestInvalidation)
+		{
+			SlowestInvalidation = Elapsed;
+		}
+
+		atomic_store(&SettledVersions[File], Version);
+
+		thrd_yield();
+	}
+
+	atomic_store(&NotifierDone, TRUE);
+
+	return 0;
+}
+
+static void TestConcurrentInvalidation(void)
+{
+	thrd_t Readers[COHERENCE_READERS];
+	thrd_t Notifier;
+	char Path[32];
+
+	for (ULONG File = 0; File < COHERENCE_FILES; File++)
+	{
+		snprintf(Path, sizeof(Path), "\\sensors\\s%lu.json", (unsigned long)File);
+		WidenPath(CoherencePaths[File], Path);
+	}
+
+	// Room for every file, so only invalidation takes items out
+	InitializeWatchedCache(&CoherenceCache, COHERENCE_FILES * GetSFPDContentCacheCost(sizeof(COHERENCE_ITEM)));
+
+	double Start = Seconds();
+
+	CHECK(thrd_create(&Notifier, CoherenceNotifier, (void*)(uintptr_t)0x9E3779B9) == thrd_success);
+
+	for (ULONG i = 0; i < COHERENCE_READERS; i++)
+	{
+		CHECK(thrd_create(&Readers[i], CoherenceReader, (void*)(uintptr_t)(0x2545F491 + i * 0x1000193)) == thrd_success);
+	}
+
+	for (ULONG i = 0; i < COHERENCE_READERS; i++)
+	{
+		thrd_join(Readers[i], NULL);
+	}
+
+	thrd_join(Notifier, NULL);
+
+	double Elapsed = Seconds() - Start;
+
+	CHECK(atomic_load(&NotifierDone));
+	CHECK(StaleReads == 0);
+	CHECK(TornReads == 0);
+
+	printf("sfpdcachetest: %d readers, %d changes in %.2f s\n", COHERENCE_READERS, COHERENCE_CHANGES, Elapsed);
+	printf("  hits %6ld  misses %6ld  fills refused %6ld  stale reads %ld\n",
+		(long)CoherenceCache.ContentCache.Hits,
+		(long)CoherenceCache.ContentCache.Misses,
+		(long)RefusedFills,
+		(long)StaleReads);
+	printf("  invalidation  %6.0f ns mean  %6.0f ns slowest\n",
+		InvalidationSeconds * 1e9 / COHERENCE_CHANGES,
+		SlowestInvalidation * 1e9);
+
+	FreeWatchedCache(&CoherenceCache);
+	CHECK(BlocksOut == 0);
+}
+
+//
+// The synthetic trace
+//
+
+#define SENSOR_FILES 40
+#define CALIBRATION_FILES 24
+#define TRACE_FILES (SENSOR_FILES + CALIBRATION_FILES)
+#define TRACE_LENGTH 200000
+
+typedef struct _TRACE_FILE
+{
+	WCHAR Path[MAX_PATH];
+	DWORD Size;
+} TRACE_FILE;
+
+static TRACE_FILE Files[TRACE_FILES];
+static ULONG Trace[TRACE_LENGTH];
+
+static ULONG Random(ULONG* State)
+{
+	*State ^= *State << 13;
+	*State ^= *State >> 17;
+	*State ^= *State << 5;
+
+	return *State;
+}
+
+static void BuildTrace(void)
+{
+	ULONG State = 0x2545F491;
+	char Narrow[64];
+
+	for (ULONG i = 0; i < SENSOR_FILES; i++)
+	{
+		snprintf(Narrow, sizeof(Narrow), "\\sensors\\sensor%02lu.json", (unsigned long)i);
+		WidenPath(Files[i].Path, Narrow);
+		Files[i].Size = 256 + Random(&State) % 1792;
+	}
+
+	for (ULONG i = SENSOR_FILES; i < TRACE_FILES; i++)
+	{
+		snprintf(Narrow, sizeof(Narrow), "\\calibration\\table%02lu.bin", (unsigned long)(i - SENSOR_FILES));
+		WidenPath(Files[i].Path, Narrow);
+		Files[i].Size = 64 + Random(&State) % 12288;
+	}
+
+	for (ULONG Position = 0; Position < TRACE_LENGTH;)
+	{
+		if (Random(&State) % 64 == 0)
+		{
+			// The sensor stack restarted and reads every sensor file once more
+			for (ULONG i = 0; i < SENSOR_FILES && Position < TRACE_LENGTH; i++)
+			{
+				Trace[Position++] = i;
+			}
+		}
+		else
+		{
+			// Skewed towards the first calibration files
+			ULONG Rank = Random(&State) % CALIBRATION_FILES;
+			Rank = Rank * (Random(&State) % CALIBRATION_FILES) / CALIBRATION_FILES;
+			Trace[Position++] = SENSOR_FILES + Rank;
+		}
+	}
+}
+
+//
+// The model: the same policy on an array, most recently used first
+//
+typedef struct _MODEL
+{
+	ULONG Budget;
+	ULONG BytesUsed;
+	ULONG Count;
+	ULONG Order[TRACE_FILES];
+	LONG Hits;
+	LONG Misses;
+	LONG Evictions;
+} MODEL;
+
+static BOOLEAN ModelAccess(MODEL* Model, ULONG File)
+{
+	ULONG Cost = GetSFPDContentCacheCost(Files[File].Size);
+
+	for (ULONG i = 0; i < Model->Count; i++)
+	{
+		if (Model->Order[i] == File)
+		{
+			memmove(&Model->Order[1], &Model->Order[0], i * sizeof(ULONG));
+			Model->Order[0] = File;
+			Model->Hits++;
+			return TRUE;
+		}
+	}
+
+	Model->Misses++;
+
+	if (Cost > Model->Budget)
+	{
+		return FALSE;
+	}
+
+	while (Model->BytesUsed + Cost > Model->Budget)
+	{
+		Model->Count--;
+		Model->BytesUsed -= GetSFPDContentCacheCost(Files[Model->Order[Model->Count]].Size);
+		Model->Evictions++;
+	}
+
+	memmove(&Model->Order[1], &Model->Order[0], Model->Count * sizeof(ULONG));
+	Model->Order[0] = File;
+	Model->Count++;
+	Model->BytesUsed += Cost;
+
+	return FALSE;
+}
+
+static void ReplayTrace(ULONG Budget)
+{
+	SFPD_CONTENT_CACHE ContentCache;
+	MODEL Model = { 0 };
+
+	InitializeSFPDContentCacheList(&ContentCache, Budget, AllocateBlock, FreeBlock);
+	Model.Budget = Budget;
+
+	for (ULONG Position = 0; Position < TRACE_LENGTH; Position++)
+	{
+		ULONG File = Trace[Position];
+
+		if (Access(&ContentCache, Files[File].Path, Files[File].Size) != ModelAccess(&Model, File))
+		{
+			printf("sfpdcachetest: budget %lu, access %lu differs from the model\n", (unsigned long)Budget, (unsigned long)Position);
+			Failures++;
+			break;
+		}
+	}
+
+	CHECK(ContentCache.Hits == Model.Hits && ContentCache.Misses == Model.Misses && ContentCache.Evictions == Model.Evictions);
+	CHECK(ContentCache.BytesUsed == Model.BytesUsed && ContentCache.BytesUsed <= Budget);
+	CHECK(CountEntries(&ContentCache) == Model.Count);
+
+	ULONG i = 0;
+
+	for (PLIST_ENTRY Link = ContentCache.LruList.Flink; Link != &ContentCache.LruList && i < Model.Count; Link = Link->Flink, i++)
+	{
+		CHECK(IsSFPDPathEqualNoCase(CONTAINING_RECORD(Link, SFPD_CONTENT_CACHE_ENTRY, Link)->Path, Files[Model.Order[i]].Path));
+	}
+
+	ClearSFPDContentCache(&ContentCache);
+	CHECK(BlocksOut == 0);
+
+	// Timed on its own, without the model
+	InitializeSFPDContentCacheList(&ContentCache, Budget, AllocateBlock, FreeBlock);
+
+	double Start = Seconds();
+
+	for (ULONG Position = 0; Position < TRACE_LENGTH; Position++)
+	{
+		Access(&ContentCache, Files[Trace[Position]].Path, Files[Trace[Position]].Size);
+	}
+
+	double Elapsed = Seconds() - Start;
+
+	printf("  budget %6lu  hits %6ld  misses %6ld  evictions %6ld  hit rate %5.1f%%  %6.1f ns per access\n",
+		(unsigned long)Budget,
+		(long)ContentCache.Hits,
+		(long)ContentCache.Misses,
+		(long)ContentCache.Evictions,
+		100.0 * ContentCache.Hits / TRACE_LENGTH,
+		Elapsed * 1e9 / TRACE_LENGTH);
+
+	ClearSFPDContentCache(&ContentCache);
+}
+
+int main(void)
+{
+	TestLru();
+	TestPathRelation();
+	TestNotificationSequence();
+	TestConcurrentInvalidation();
+
+	BuildTrace();
+
+	printf("sfpdcachetest: %d accesses over %d files\n", TRACE_LENGTH, TRACE_FILES);
+
+	// The default budget is SFPD_CONTENT_CACHE_DEFAULT_BUDGET
+	ReplayTrace(0x4000);
+	ReplayTrace(0x10000);
+	ReplayTrace(0x40000);
+
+	if (Failures != 0)
+	{
+		printf("sfpdcachetest: %d failures\n", Failures);
+		return 1;
+	}
+
+	printf("sfpdcachetest: ok\n");
+
+	return 0;
+}
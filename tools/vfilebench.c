@@ -0,0 +1,307 @@
+/*++
+
+Copyright (c) 2021-2024 DuoWoA authors. All Rights Reserved.
+
+Module Name:
+
+	vfilebench.c
+
+Abstract:
+
+	User-mode check and microbenchmark of the virtual file lookup against
+	the compare chain it replaced. FindVirtualFile comes from
+	include\vfilelookup.h, the code LookupVirtualFile runs in the driver,
+	on the generated include\vfiletable.h. Both are first run on every
+	probe to make sure they agree: every path in the table, near misses of
+	it, and paths the filter doesn't own, each with different garbage
+	after its terminator. Then both are timed.
+
+	Build and run from the repository root with any C11 compiler, WCHAR
+	literals must be 16 bit:
+
+		cc -O2 -fshort-wchar -o vfilebench tools/vfilebench.c && ./vfilebench
+		cl /std:c11 /O2 tools\vfilebench.c && vfilebench.exe
+
+	A manifest naming a new blob or provider needs a line below as well.
+
+Environment:
+
+	User mode, no WDK needed
+
+--*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+typedef void VOID;
+typedef uint8_t UCHAR, BYTE, BOOLEAN;
+typedef uint16_t USHORT;
+typedef uint32_t ULONG, DWORD;
+typedef int32_t NTSTATUS;
+typedef size_t SIZE_T;
+typedef wchar_t WCHAR, * PWCHAR;
+typedef const wchar_t* PCWSTR;
+
+#define FORCEINLINE static inline
+#define CONST const
+#define TRUE 1
+#define FALSE 0
+#define MAXUCHAR 0xFF
+#define ARRAYSIZE(a) (sizeof(a) / sizeof((a)[0]))
+#define C_ASSERT(e) _Static_assert(e, #e)
+
+#define STATUS_SUCCESS ((NTSTATUS)0x00000000L)
+#define STATUS_FILE_NOT_AVAILABLE ((NTSTATUS)0xC0000467L)
+
+_Static_assert(sizeof(WCHAR) == 2, "WCHAR literals must be 16 bit, build with -fshort-wchar");
+
+// Must match vfile.h
+#define VIRTUAL_FILE_MAX_PATH 48
+
+typedef enum _VIRTUAL_FILE_KIND
+{
+	VirtualFileStatic,
+	VirtualFileDerived,
+	VirtualFileSFPD,
+	VirtualFileStatusOnly
+} VIRTUAL_FILE_KIND;
+
+typedef struct _VIRTUAL_FILE
+{
+	PCWSTR Path;
+	BOOLEAN Prefix;
+	VIRTUAL_FILE_KIND Kind;
+	NTSTATUS StatusOverride;
+
+	CONST VOID* Data;
+	DWORD DataSize;
+
+	CONST VOID* GetSize;
+	CONST VOID* GetContent;
+	CONST VOID* Patch;
+
+	USHORT PathLength;
+} VIRTUAL_FILE, * PVIRTUAL_FILE;
+
+// Only the lookup is measured, blobs and providers just have to exist
+static const BYTE BT_NVMTAG36_PROVISION[1];
+static const BYTE BT_NVMTAG83_PROVISION[1];
+static const BYTE BT_PROVISION[1];
+static const BYTE WLAN_PROVISION[1];
+static const BYTE WLAN_CLPC_PROVISION_PACKED[1];
+static const BYTE WLAN_SAR2CFG_PROVISION[1];
+
+#define GetVirtualFileBlobSize NULL
+#define ReadVirtualFileBlob NULL
+#define GetPackedVirtualFileBlobSize NULL
+#define ReadPackedVirtualFileBlob NULL
+#define ReadVirtualFileSnapshot NULL
+#define PatchBTProvision NULL
+#define PatchWLANProvision NULL
+#define GetSensorFileSize NULL
+#define ReadSensorFile NULL
+
+#define ITERATIONS 2000000
+
+static SIZE_T RtlCompareMemory(const VOID* Source1, const VOID* Source2, SIZE_T Length)
+{
+	const UCHAR* Left = (const UCHAR*)Source1;
+	const UCHAR* Right = (const UCHAR*)Source2;
+	SIZE_T Matched = 0;
+
+	while (Matched < Length && Left[Matched] == Right[Matched])
+	{
+		Matched++;
+	}
+
+	return Matched;
+}
+
+#include "../include/vfiletable.h"
+#include "../include/vfilelookup.h"
+
+//
+// The RtlCompareMemory chain the completion routine used before, one
+// sizeof(L"...") compare per path in table order, prefixes without their
+// terminator.
+//
+static PVIRTUAL_FILE LookupVirtualFileChain(PCWSTR RequestPath)
+{
+	for (ULONG i = 0; i < VIRTUAL_FILE_COUNT; i++)
+	{
+		PVIRTUAL_FILE File = &VirtualFiles[i];
+		SIZE_T CompareSize = (File->PathLength + 1) * sizeof(WCHAR);
+
+		if (!File->Prefix && RtlCompareMemory(File->Path, RequestPath, CompareSize) == CompareSize)
+		{
+			return File;
+		}
+	}
+
+	for (ULONG i = 0; i < VIRTUAL_FILE_COUNT; i++)
+	{
+		PVIRTUAL_FILE File = &VirtualFiles[i];
+		SIZE_T CompareSize = File->PathLength * sizeof(WCHAR);
+
+		if (File->Prefix && RtlCompareMemory(File->Path, RequestPath, CompareSize) == CompareSize)
+		{
+			return File;
+		}
+	}
+
+	return NULL;
+}
+
+typedef PVIRTUAL_FILE LOOKUP(PCWSTR RequestPath);
+
+// Paths the filter doesn't own, the last one fills the whole field without a terminator
+static const PCWSTR Unowned[] =
+{
+	L"",
+	L"QCOM\\",
+	L"QCOM\\UNKNOWN.PROVISION",
+	L"XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX",
+};
+
+// Variants of every path in the table: as is, longer, shorter, lower case, a file under it
+#define VARIANT_COUNT 5
+
+// What follows the terminator of a request path must not matter
+static const WCHAR Fillers[] = { 0x0000, 0x0041, 0xFFFF };
+
+#define PROBE_COUNT ((VIRTUAL_FILE_COUNT * VARIANT_COUNT + ARRAYSIZE(Unowned)) * ARRAYSIZE(Fillers))
+
+static WCHAR Probes[PROBE_COUNT][VIRTUAL_FILE_MAX_PATH];
+
+// Not wcslen or wcscpy, the C library's wchar_t may be wider than these literals
+static ULONG AppendPath(PWCHAR Field, ULONG Length, PCWSTR Path)
+{
+	for (ULONG i = 0; Path[i] != L'\0' && Length < VIRTUAL_FILE_MAX_PATH; i++)
+	{
+		Field[Length++] = Path[i];
+	}
+
+	return Length;
+}
+
+// Terminates the path if there is room and fills the rest of the 48 WCHAR field
+static void FinishProbe(PWCHAR Field, ULONG Length, WCHAR Filler)
+{
+	if (Length < VIRTUAL_FILE_MAX_PATH)
+	{
+		Field[Length++] = L'\0';
+	}
+
+	while (Length < VIRTUAL_FILE_MAX_PATH)
+	{
+		Field[Length++] = Filler;
+	}
+}
+
+static ULONG BuildProbes(void)
+{
+	ULONG Count = 0;
+
+	for (ULONG f = 0; f < ARRAYSIZE(Fillers); f++)
+	{
+		for (ULONG i = 0; i < VIRTUAL_FILE_COUNT; i++)
+		{
+			PCWSTR Path = VirtualFiles[i].Path;
+			ULONG Length = VirtualFiles[i].PathLength;
+
+			for (ULONG v = 0; v < VARIANT_COUNT; v++, Count++)
+			{
+				PWCHAR Field = Probes[Count];
+				ULONG FieldLength = AppendPath(Field, 0, Path);
+
+				switch (v)
+				{
+				case 1:
+					FieldLength = AppendPath(Field, FieldLength, L"X");
+					break;
+				case 2:
+					FieldLength = Length - 1;
+					break;
+				case 3:
+					for (ULONG j = 0; j < Length; j++)
+					{
+						if (Field[j] >= L'A' && Field[j] <= L'Z')
+						{
+							Field[j] += L'a' - L'A';
+						}
+					}
+					break;
+				case 4:
+					FieldLength = AppendPath(Field, FieldLength, L"SENSORS.JSON");
+					break;
+				}
+
+				FinishProbe(Field, FieldLength, Fillers[f]);
+			}
+		}
+
+		for (ULONG i = 0; i < ARRAYSIZE(Unowned); i++, Count++)
+		{
+			FinishProbe(Probes[Count], AppendPath(Probes[Count], 0, Unowned[i]), Fillers[f]);
+		}
+	}
+
+	return Count;
+}
+
+static double Seconds(void)
+{
+	struct timespec Now;
+
+	timespec_get(&Now, TIME_UTC);
+
+	return (double)Now.tv_sec + (double)Now.tv_nsec / 1e9;
+}
+
+static double TimeLookup(LOOKUP* Lookup, ULONG ProbeCount)
+{
+	volatile uintptr_t Sink = 0;
+	double Start = Seconds();
+
+	for (ULONG Iteration = 0; Iteration < ITERATIONS; Iteration++)
+	{
+		Sink += (uintptr_t)Lookup(Probes[Iteration % ProbeCount]);
+	}
+
+	return (Seconds() - Start) * 1e9 / ITERATIONS;
+}
+
+int main(void)
+{
+	ULONG ProbeCount = BuildProbes();
+
+	for (ULONG i = 0; i < ProbeCount; i++)
+	{
+		if (FindVirtualFile(Probes[i]) != LookupVirtualFileChain(Probes[i]))
+		{
+			printf("vfilebench: probe %lu resolves differently\n", (unsigned long)i);
+			return 1;
+		}
+	}
+
+	// The unmodified paths, with a zeroed tail, must each find their own entry
+	for (ULONG i = 0; i < VIRTUAL_FILE_COUNT; i++)
+	{
+		if (FindVirtualFile(Probes[i * VARIANT_COUNT]) != &VirtualFiles[i])
+		{
+			printf("vfilebench: entry %lu is not found\n", (unsigned long)i);
+			return 1;
+		}
+	}
+
+	double Hashed = TimeLookup(FindVirtualFile, ProbeCount);
+	double Chain = TimeLookup(LookupVirtualFileChain, ProbeCount);
+
+	printf("vfilebench: %lu probes agree, %d lookups each way\n", (unsigned long)ProbeCount, ITERATIONS);
+	printf("  FindVirtualFile    %6.1f ns per lookup\n", Hashed);
+	printf("  compare chain      %6.1f ns per lookup\n", Chain);
+
+	return 0;
+}
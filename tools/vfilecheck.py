@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2021-2024 DuoWoA authors. All Rights Reserved.
+#
+# Checks include/vfiletable.h against src/vfile.manifest and the way vfile.c
+# uses it:
+#
+#   - The checked in header is what vfilegen.py makes of the manifest today
+#   - Every entry is consistent with its kind, derived files read through
+#     their per-device snapshot and have a patch, status only files have no
+#     providers, and every blob is declared in constants.h or packedblobs.h
+#   - Every exact entry sits in exactly one bucket and every prefix entry is
+#     listed as one
+#
+# The lookup itself is checked by tools/vfilebench.c, which runs the
+# driver's code from include/vfilelookup.h.
+#
+# Runs on any Python 3 without extra modules, from the repository root:
+#
+#   python tools/vfilecheck.py src/vfile.manifest include/vfiletable.h
+#
+
+import re
+import sys
+
+import vfilegen
+
+# Must match VIRTUAL_FILE_MAX_PATH in vfile.h
+MAX_PATH_LENGTH = 48
+
+# Headers the manifest's Data column may name symbols from
+BLOB_HEADERS = ("include/constants.h", "include/packedblobs.h")
+
+DEFINE = re.compile(r"#define\s+(VIRTUAL_FILE_\w+)\s+(\w+)")
+ARRAY = re.compile(r"static\s+const\s+UCHAR\s+(\w+)\s*\[[^\]]*\]\s*=\s*\{([^}]*)\}\s*;")
+ENTRY = re.compile(r'^\s*\{\s*L"((?:[^"\\]|\\.)*)",\s*(TRUE|FALSE),\s*VirtualFile(\w+),\s*(\w+),\s*(\w+),\s*[^,]+,\s*(\w+),\s*(\w+),\s*(\w+),\s*(\d+)\s*\},\s*$', re.M)
+
+
+def fail(message):
+    sys.stderr.write("vfilecheck: error: %s\n" % message)
+    sys.exit(1)
+
+
+def parse_table(path):
+    with open(path, "r") as header:
+        text = header.read()
+
+    defines = dict((name, int(value, 0)) for name, value in DEFINE.findall(text))
+    arrays = dict((name, [int(value, 0) for value in body.replace(",", " ").split()]) for name, body in ARRAY.findall(text))
+
+    files = []
+    for path_literal, prefix, kind, status, data, get_size, get_content, patch, length in ENTRY.findall(text):
+        files.append({
+            "path": path_literal.replace("\\\\", "\\"),
+            "prefix": prefix == "TRUE",
+            "kind": kind,
+            "status": status,
+            "data": None if data == "NULL" else data,
+            "get_size": None if get_size == "NULL" else get_size,
+            "get_content": None if get_content == "NULL" else get_content,
+            "patch": None if patch == "NULL" else patch,
+            "length": int(length),
+        })
+
+    for name in ("VIRTUAL_FILE_COUNT", "VIRTUAL_FILE_HASH_SEED", "VIRTUAL_FILE_BUCKET_COUNT", "VIRTUAL_FILE_PREFIX_COUNT"):
+        if name not in defines:
+            fail("%s: %s is missing" % (path, name))
+
+    for name in ("VirtualFileHashPositions", "VirtualFileBuckets", "VirtualFilePrefixes"):
+        if name not in arrays:
+            fail("%s: %s is missing" % (path, name))
+
+    if len(files) != defines["VIRTUAL_FILE_COUNT"]:
+        fail("%s: %d entries but VIRTUAL_FILE_COUNT is %d" % (path, len(files), defines["VIRTUAL_FILE_COUNT"]))
+
+    return {
+        "files": files,
+        "buckets": arrays["VirtualFileBuckets"],
+        "prefixes": arrays["VirtualFilePrefixes"][:defines["VIRTUAL_FILE_PREFIX_COUNT"]],
+    }
+
+
+def check_entries(table):
+    declared = ""
+
+    for header in BLOB_HEADERS:
+        with open(header, "r") as source:
+            declared += source.read()
+
+    for file in table["files"]:
+        path = file["path"]
+
+        if file["length"] != len(path):
+            fail("%s: PathLength is %d instead of %d" % (path, file["length"], len(path)))
+
+        if len(path) >= MAX_PATH_LENGTH:
+            fail("%s: does not fit a request" % path)
+
+        if file["kind"] == "StatusOnly":
+            if file["get_size"] or file["get_content"] or file["data"]:
+                fail("%s: status only files are answered without providers or data" % path)
+            continue
+
+        if not file["get_size"] or not file["get_content"]:
+            fail("%s: needs both a size and a content provider" % path)
+
+        if (file["kind"] == "Derived") != (file["patch"] is not None):
+            fail("%s: derived files and only those need a patch" % path)
+
+        # Derived templates are shared between devices, never hand them out or patch them in place
+        if file["kind"] == "Derived" and file["get_content"] != "ReadVirtualFileSnapshot":
+            fail("%s: derived files must be read from their snapshot" % path)
+
+        if file["kind"] in ("Static", "Derived"):
+            if not file["data"]:
+                fail("%s: blobs need data" % path)
+
+            if not re.search(r"\bBYTE\s+%s\s*\[" % re.escape(file["data"]), declared):
+                fail("%s: %s is not declared in %s" % (path, file["data"], " or ".join(BLOB_HEADERS)))
+
+
+def check_buckets(table):
+    exact = [index for index, file in enumerate(table["files"]) if not file["prefix"]]
+    prefixes = [index for index, file in enumerate(table["files"]) if file["prefix"]]
+
+    if sorted(index - 1 for index in table["buckets"] if index != 0) != exact:
+        fail("every exact entry must sit in exactly one bucket")
+
+    if table["prefixes"] != prefixes:
+        fail("VirtualFilePrefixes does not list the prefix entries")
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.stderr.write("usage: vfilecheck.py <manifest> <header>\n")
+        return 1
+
+    manifest_path, header_path = sys.argv[1], sys.argv[2]
+
+    with open(header_path, "r", newline="") as header:
+        if header.read() != vfilegen.generate(vfilegen.parse_manifest(manifest_path), manifest_path):
+            fail("%s is out of date, run vfilegen.py on %s" % (header_path, manifest_path))
+
+    table = parse_table(header_path)
+
+    check_entries(table)
+    check_buckets(table)
+
+    print("vfilecheck: %d virtual files ok" % len(table["files"]))
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
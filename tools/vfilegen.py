@@ -0,0 +1,238 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2021-2024 DuoWoA authors. All Rights Reserved.
+#
+# Generates include/vfiletable.h from src/vfile.manifest.
+#
+# The exact match paths are hashed from a handful of WCHAR positions only,
+# picked here together with a seed so that every path lands in its own
+# bucket. LookupVirtualFile then reads those positions, indexes the bucket
+# array once and confirms the single candidate with one compare, whatever
+# the request path is.
+#
+# Runs on any Python 3 without extra modules:
+#
+#   python tools/vfilegen.py src/vfile.manifest include/vfiletable.h
+#
+
+import itertools
+import sys
+
+# Must match HashVirtualFilePath in vfilelookup.h, tools/vfilebench.c catches a mismatch
+FNV_OFFSET_BASIS = 2166136261
+FNV_PRIME = 16777619
+
+# Request paths are 96 bytes at +88
+MAX_PATH_LENGTH = 48
+
+MAX_POSITIONS = 4
+MAX_SEEDS = 0x100
+
+KINDS = ("Static", "Derived", "SFPD", "StatusOnly")
+
+
+def fail(message):
+    sys.stderr.write("vfilegen: error: %s\n" % message)
+    sys.exit(1)
+
+
+def parse_manifest(path):
+    files = []
+
+    with open(path, "r") as manifest:
+        for number, line in enumerate(manifest, 1):
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+
+            fields = line.split()
+            if len(fields) != 8:
+                fail("%s(%d): expected 8 fields, got %d" % (path, number, len(fields)))
+
+            name, match, kind, status, data, get_size, get_content, patch = fields
+
+            if match not in ("exact", "prefix"):
+                fail("%s(%d): unknown match %s" % (path, number, match))
+
+            if kind not in KINDS:
+                fail("%s(%d): unknown kind %s" % (path, number, kind))
+
+            if (kind == "Derived") != (patch != "-"):
+                fail("%s(%d): derived files and only those need a patch" % (path, number))
+
+            if len(name) >= MAX_PATH_LENGTH:
+                fail("%s(%d): %s does not fit a request" % (path, number, name))
+
+            if any(existing["path"] == name for existing in files):
+                fail("%s(%d): %s is listed twice" % (path, number, name))
+
+            files.append({
+                "path": name,
+                "prefix": match == "prefix",
+                "kind": kind,
+                "status": status,
+                "data": None if data == "-" else data,
+                "get_size": None if get_size == "-" else get_size,
+                "get_content": None if get_content == "-" else get_content,
+                "patch": None if patch == "-" else patch,
+            })
+
+    if not files:
+        fail("%s: no virtual files" % path)
+
+    return files
+
+
+def hash_path(path, seed, positions):
+    value = seed
+
+    for position in positions:
+        # The terminator is the only WCHAR past the path a request reliably has
+        value ^= ord(path[position]) if position < len(path) else 0
+        value = (value * FNV_PRIME) & 0xFFFFFFFF
+
+    return value
+
+
+def find_perfect_hash(paths):
+    # Positions past the terminator of the shortest path read whatever the
+    # caller left in the field, keep to the part every path defines
+    last_position = min(len(path) for path in paths)
+
+    bucket_count = 1
+    while bucket_count < len(paths):
+        bucket_count *= 2
+
+    while bucket_count <= 256:
+        for position_count in range(1, MAX_POSITIONS + 1):
+            for positions in itertools.combinations(range(last_position + 1), position_count):
+                # Skip positions every path agrees on, they can't tell any apart
+                if any(len(set(path[p] if p < len(path) else "" for path in paths)) == 1 for p in positions):
+                    continue
+
+                for seed_index in range(MAX_SEEDS):
+                    seed = (FNV_OFFSET_BASIS + seed_index) & 0xFFFFFFFF
+                    buckets = set(hash_path(path, seed, positions) & (bucket_count - 1) for path in paths)
+
+                    if len(buckets) == len(paths):
+                        return seed, positions, bucket_count
+
+        bucket_count *= 2
+
+    fail("no collision free hash for %d paths" % len(paths))
+
+
+def c_path(path):
+    return 'L"%s"' % path.replace("\\", "\\\\")
+
+
+def generate(files, manifest_path):
+    exact = [index for index, file in enumerate(files) if not file["prefix"]]
+    prefixes = [index for index, file in enumerate(files) if file["prefix"]]
+
+    if not exact:
+        fail("%s: no exact match virtual files" % manifest_path)
+
+    seed, positions, bucket_count = find_perfect_hash([files[index]["path"] for index in exact])
+
+    buckets = [0] * bucket_count
+    for index in exact:
+        buckets[hash_path(files[index]["path"], seed, positions) & (bucket_count - 1)] = index + 1
+
+    lines = []
+    lines.append("/*++")
+    lines.append("")
+    lines.append("Copyright (c) 2021-2024 DuoWoA authors. All Rights Reserved.")
+    lines.append("")
+    lines.append("Module Name:")
+    lines.append("")
+    lines.append("\tvfiletable.h")
+    lines.append("")
+    lines.append("Abstract:")
+    lines.append("")
+    lines.append("\tThis file contains the virtual file table and its lookup hash.")
+    lines.append("")
+    lines.append("\tGenerated by tools\\vfilegen.py from src\\vfile.manifest, edit the manifest")
+    lines.append("\tinstead. vfile.c includes it after declaring the providers, and")
+    lines.append("\ttools\\vfilebench.c to check and time the lookup in vfilelookup.h.")
+    lines.append("")
+    lines.append("Environment:")
+    lines.append("")
+    lines.append("\tKernel-mode Driver Framework")
+    lines.append("")
+    lines.append("--*/")
+    lines.append("")
+    lines.append("#pragma once")
+    lines.append("")
+    lines.append("#define VIRTUAL_FILE_COUNT %d" % len(files))
+    lines.append("#define VIRTUAL_FILE_HASH_SEED 0x%08X" % seed)
+    lines.append("#define VIRTUAL_FILE_BUCKET_COUNT %d" % bucket_count)
+    lines.append("")
+    lines.append("// WCHAR positions of the request path that go into the hash")
+    lines.append("static const UCHAR VirtualFileHashPositions[] = { %s };" % ", ".join(str(p) for p in positions))
+    lines.append("")
+    lines.append("static VIRTUAL_FILE VirtualFiles[VIRTUAL_FILE_COUNT] =")
+    lines.append("{")
+
+    for file in files:
+        data = file["data"]
+        lines.append("\t{ %s, %s, VirtualFile%s, %s, %s, %s, %s, %s, %s, %d }," % (
+            c_path(file["path"]),
+            "TRUE" if file["prefix"] else "FALSE",
+            file["kind"],
+            file["status"],
+            data if data else "NULL",
+            "sizeof(%s)" % data if data else "0",
+            file["get_size"] or "NULL",
+            file["get_content"] or "NULL",
+            file["patch"] or "NULL",
+            len(file["path"])))
+
+    lines.append("};")
+    lines.append("")
+    lines.append("// Index + 1 into VirtualFiles of the only exact entry hashing there, 0 when none does")
+    lines.append("static const UCHAR VirtualFileBuckets[VIRTUAL_FILE_BUCKET_COUNT] =")
+    lines.append("{")
+
+    for start in range(0, bucket_count, 16):
+        lines.append("\t%s," % ", ".join(str(bucket) for bucket in buckets[start:start + 16]))
+
+    lines.append("};")
+    lines.append("")
+    lines.append("// Indexes into VirtualFiles of the prefix entries, checked when no exact entry matches")
+
+    if prefixes:
+        lines.append("static const UCHAR VirtualFilePrefixes[] = { %s };" % ", ".join(str(index) for index in prefixes))
+    else:
+        lines.append("static const UCHAR VirtualFilePrefixes[1] = { 0 };")
+
+    lines.append("#define VIRTUAL_FILE_PREFIX_COUNT %d" % len(prefixes))
+    lines.append("")
+
+    return "\n".join(lines)
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.stderr.write("usage: vfilegen.py <manifest> <output header>\n")
+        return 1
+
+    manifest_path, output_path = sys.argv[1], sys.argv[2]
+    header = generate(parse_manifest(manifest_path), manifest_path)
+
+    # Leave the header alone when nothing changed so vfile.c isn't rebuilt
+    try:
+        with open(output_path, "r", newline="") as existing:
+            if existing.read() == header:
+                return 0
+    except OSError:
+        pass
+
+    with open(output_path, "w", newline="\n") as output:
+        output.write(header)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())